@@ -15,6 +15,8 @@
 #include <unistd.h>
 
 #include "BufferedFileReader.hpp"
+#include "TermDictionary.hpp"
+#include "TokenBatch.hpp"
 
 // one provided function since this one has funky syntax
 // it is just a wrapper around the good function though.
@@ -23,7 +25,13 @@ BufferedFileReader::operator bool() const {
 }
 
 BufferedFileReader::BufferedFileReader(const std::string& fname)
-    : curr_length_(0), curr_index_(0), fd_(-1), good_(false) {
+    : curr_length_(0),
+      curr_index_(0),
+      buffer_offset_(0),
+      token_ordinal_(0),
+      fd_(-1),
+      good_(false),
+      delims_table_() {
   open_file(fname);
 }
 
@@ -34,8 +42,12 @@ BufferedFileReader::~BufferedFileReader() {
 BufferedFileReader::BufferedFileReader(BufferedFileReader&& other)
     : curr_length_(other.curr_length_),
       curr_index_(other.curr_index_),
+      buffer_offset_(other.buffer_offset_),
+      token_ordinal_(other.token_ordinal_),
       fd_(other.fd_),
-      good_(other.good_) {
+      good_(other.good_),
+      delims_(std::move(other.delims_)),
+      delims_table_(other.delims_table_) {
   // Copy the buffer data
   for (size_t i = 0; i < BUF_SIZE; i++) {
     buffer_[i] = other.buffer_[i];
@@ -62,6 +74,10 @@ BufferedFileReader& BufferedFileReader::operator=(BufferedFileReader&& other) {
   good_ = other.good_;
   curr_length_ = other.curr_length_;
   curr_index_ = other.curr_index_;
+  buffer_offset_ = other.buffer_offset_;
+  token_ordinal_ = other.token_ordinal_;
+  delims_ = std::move(other.delims_);
+  delims_table_ = other.delims_table_;
 
   // Copy the buffer data explicitly
   for (size_t i = 0; i < BUF_SIZE; i++) {
@@ -89,6 +105,8 @@ void BufferedFileReader::open_file(const std::string& fname) {
     good_ = true;
     curr_length_ = 0;
     curr_index_ = 0;
+    buffer_offset_ = 0;
+    token_ordinal_ = 0;
   } else {
     good_ = false;
   }
@@ -102,6 +120,8 @@ void BufferedFileReader::close_file() {
   good_ = false;
   curr_length_ = 0;
   curr_index_ = 0;
+  buffer_offset_ = 0;
+  token_ordinal_ = 0;
 }
 
 void BufferedFileReader::fill_buffer() {
@@ -110,6 +130,9 @@ void BufferedFileReader::fill_buffer() {
     return;
   }
 
+  // The new buffer starts where the old one ended
+  buffer_offset_ += curr_length_;
+
   // Reset buffer indices
   curr_index_ = 0;
 
@@ -144,48 +167,184 @@ char BufferedFileReader::get_char() {
   return buffer_[curr_index_++];
 }
 
+std::optional<std::string_view> BufferedFileReader::get_chunk() {
+  if (!good_ || fd_ < 0) {
+    return std::nullopt;
+  }
+
+  if (curr_length_ == 0 || curr_index_ >= curr_length_) {
+    fill_buffer();
+    if (curr_length_ == 0) {  // EOF or error
+      return std::nullopt;
+    }
+  }
+
+  std::string_view chunk(buffer_.data() + curr_index_,
+                         curr_length_ - curr_index_);
+  curr_index_ = curr_length_;
+  return chunk;
+}
+
 std::optional<std::string> BufferedFileReader::get_token(
     const std::string& delims) {
-  if (!good_ || fd_ < 0) {
+  std::string_view token;
+  if (!next_token(delims_table(delims), &token)) {
     return std::nullopt;
   }
 
-  // String to build the token
-  std::string token;
+  // The whole token is copied in one go, the string is
+  // allocated at most once.
+  return std::string(token);
+}
+
+std::optional<std::pmr::string> BufferedFileReader::get_token(
+    std::pmr::memory_resource* resource,
+    const std::string& delims) {
+  std::string_view token;
+  if (!next_token(delims_table(delims), &token)) {
+    return std::nullopt;
+  }
+  return std::pmr::string(token, resource);
+}
+
+size_t BufferedFileReader::get_tokens(TokenBatch& batch,
+                                      size_t max,
+                                      const std::string& delims) {
+  batch.clear();
+  if (!good_ || fd_ < 0) {
+    return 0;
+  }
+
+  const std::array<bool, 256>& table = delims_table(delims);
+  batch.offsets_.reserve(max);
+  batch.lengths_.reserve(max);
+
+  // Every byte we consume is copied into the batch, so offsets in the
+  // batch are just offsets from where we started reading. This keeps
+  // tokens that span a refill contiguous.
+  size_t count = 0;
+  uint32_t token_start = 0;
+  while (count < max) {
+    if (curr_length_ == 0 || curr_index_ >= curr_length_) {
+      fill_buffer();
+      if (curr_length_ == 0) {
+        // EOF acts as the delimiter of the last token
+        uint32_t end = static_cast<uint32_t>(batch.bytes_.size());
+        batch.offsets_.push_back(token_start);
+        batch.lengths_.push_back(end - token_start);
+        count++;
+        break;
+      }
+    }
+
+    const char* buf = buffer_.data();
+    uint32_t base = static_cast<uint32_t>(batch.bytes_.size() - curr_index_);
+    size_t i = curr_index_;
+    for (; i < curr_length_ && count < max; i++) {
+      if (table[static_cast<unsigned char>(buf[i])]) {
+        uint32_t end = base + static_cast<uint32_t>(i);
+        batch.offsets_.push_back(token_start);
+        batch.lengths_.push_back(end - token_start);
+        token_start = end + 1;
+        count++;
+      }
+    }
+    batch.bytes_.insert(batch.bytes_.end(), buf + curr_index_, buf + i);
+    curr_index_ = i;
+  }
+  token_ordinal_ += count;
+  return count;
+}
+
+std::optional<PositionedToken> BufferedFileReader::get_token_with_pos(
+    const std::string& delims) {
+  // The token starts wherever we are now, the previous
+  // token's delimiter has already been read.
+  off_t offset = buffer_offset_ + curr_index_;
+  uint64_t ordinal = token_ordinal_;
 
-  // Get the first character
-  char c = get_char();
+  std::string_view token;
+  if (!next_token(delims_table(delims), &token)) {
+    return std::nullopt;
+  }
+  return PositionedToken{std::string(token), offset, ordinal};
+}
 
-  // Check if we hit EOF right away
-  if (c == EOF) {
+std::optional<uint32_t> BufferedFileReader::get_token_id(
+    TermDictionary& dict,
+    const std::string& delims) {
+  std::string_view token;
+  if (!next_token(delims_table(delims), &token)) {
     return std::nullopt;
   }
+  return dict.intern(token);
+}
 
-  // Check if first character is a delimiter
-  if (delims.find(c) != std::string::npos) {
-    // Return empty token when starting with a delimiter
-    return token;
+const std::array<bool, 256>& BufferedFileReader::delims_table(
+    const std::string& delims) {
+  if (delims != delims_) {
+    delims_ = delims;
+    delims_table_.fill(false);
+    for (char c : delims) {
+      delims_table_[static_cast<unsigned char>(c)] = true;
+    }
   }
+  return delims_table_;
+}
 
-  // Add first character to token
-  token.push_back(c);
+bool BufferedFileReader::next_token(const std::array<bool, 256>& table,
+                                    std::string_view* token) {
+  if (!good_ || fd_ < 0) {
+    return false;
+  }
+  token_ordinal_++;
 
-  // Continue reading until we hit a delimiter or EOF
-  while (true) {
-    c = get_char();
+  // Whether the token so far has been copied into token_scratch_
+  bool spilled = false;
 
-    // Check if we hit EOF
-    if (c == EOF) {
-      return token;
+  while (true) {
+    if (curr_length_ == 0 || curr_index_ >= curr_length_) {
+      fill_buffer();
+      if (curr_length_ == 0) {
+        // EOF acts as the delimiter
+        if (spilled) {
+          *token = token_scratch_;
+        } else {
+          *token = std::string_view();
+        }
+        return true;
+      }
     }
 
-    // Check if current character is a delimiter
-    if (delims.find(c) != std::string::npos) {
-      return token;
+    // Look for a delimiter in what is left of the buffer
+    const char* begin = buffer_.data() + curr_index_;
+    const char* end = buffer_.data() + curr_length_;
+    const char* p = begin;
+    while (p != end && !table[static_cast<unsigned char>(*p)]) {
+      p++;
+    }
+    curr_index_ += p - begin;
+
+    if (p != end) {
+      // Found the end of the token, mark the delimiter as read
+      curr_index_++;
+      if (spilled) {
+        token_scratch_.append(begin, p);
+        *token = token_scratch_;
+      } else {
+        *token = std::string_view(begin, p - begin);
+      }
+      return true;
     }
 
-    // Add character to token
-    token.push_back(c);
+    // The token continues past the end of the buffer,
+    // save what we have before the buffer is refilled.
+    if (spilled) {
+      token_scratch_.append(begin, p);
+    } else {
+      token_scratch_.assign(begin, p);
+      spilled = true;
+    }
   }
 }
 
@@ -194,15 +353,9 @@ int BufferedFileReader::tell() const {
     return -1;
   }
 
-  // Get the current position in the file
-  int file_pos = lseek(fd_, 0, SEEK_CUR);
-
-  if (file_pos < 0) {
-    return -1;
-  }
-
-  // Adjust for characters we've read into the buffer but not consumed yet
-  return file_pos - (curr_length_ - curr_index_);
+  // We know where the buffer starts in the file,
+  // so no need to ask the OS.
+  return buffer_offset_ + curr_index_;
 }
 
 void BufferedFileReader::rewind() {
@@ -213,10 +366,28 @@ void BufferedFileReader::rewind() {
     // Reset buffer state
     curr_length_ = 0;
     curr_index_ = 0;
+    buffer_offset_ = 0;
+    token_ordinal_ = 0;
     good_ = true;
   }
 }
 
+bool BufferedFileReader::seek(off_t offset) {
+  if (fd_ < 0 || offset < 0) {
+    return false;
+  }
+
+  // The next read refills the buffer from the new position
+  if (lseek(fd_, offset, SEEK_SET) < 0) {
+    return false;
+  }
+  curr_length_ = 0;
+  curr_index_ = 0;
+  buffer_offset_ = offset;
+  good_ = true;
+  return true;
+}
+
 bool BufferedFileReader::good() const {
   return good_ && (fd_ >= 0);
 }
\ No newline at end of file
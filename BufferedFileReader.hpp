@@ -13,8 +13,25 @@
 #define BUFFEREDFILEREADER_HPP_
 
 #include <array>
+#include <cstdint>
+#include <memory_resource>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <sys/types.h>
+
+class TermDictionary;
+class TokenBatch;
+
+// A token along with where it was found in the file
+struct PositionedToken {
+  std::string text;  // The token itself
+  off_t offset;      // Offset of the token's first char from the start
+                     // of the file
+  uint64_t ordinal;  // The number of tokens read before this one
+};
 
 ///////////////////////////////////////////////////////////////////////////////
 // A BufferedFileReader is a class for reading files.
@@ -89,6 +106,20 @@ class BufferedFileReader {
   //   or if there is no file open currently, then EOF is returned.
   char get_char();
 
+  // Gets the next chunk of unread characters from the file: whatever
+  // is left in the buffer, or if that is nothing, the next fill of the
+  // buffer. Useful for scanning the raw bytes of the file without
+  // going through get_char.
+  //
+  // Arguments: None
+  //
+  // Returns:
+  // - a view of the characters read. The characters are marked as read
+  //   and the view is only valid until the next read from the file.
+  //   Call tell() first to know the offset of the first character.
+  // - nullopt if at the end of the file or if there is no file open
+  std::optional<std::string_view> get_chunk();
+
   // The next two functions deal with the reading of "tokens".
   // A token is a sequence of characters whose end is marked by a delimiter
   // character and does not contain any delimiters in it. Note that the
@@ -130,6 +161,102 @@ class BufferedFileReader {
   std::optional<std::string> get_token(
       const std::string& delims = " \t\n\r\v\f");
 
+  // Reads the next token from the file into a string whose memory comes
+  // from `resource`.
+  //
+  // Tokens are read exactly as in get_token. Passing a
+  // std::pmr::monotonic_buffer_resource lets all of the tokens of a
+  // document or batch be released at once by releasing the resource.
+  //
+  // Arguments:
+  // - resource: the memory resource to allocate the token from
+  // - delims: a string containing all of the characters to
+  //   be used as delimiters for reading tokens.
+  //
+  // Returns:
+  // - the next token in the file,
+  // - nullopt if already at EOF or if the file is not open.
+  std::optional<std::pmr::string> get_token(
+      std::pmr::memory_resource* resource,
+      const std::string& delims = " \t\n\r\v\f");
+
+  // Reads the next token from the file along with its position.
+  //
+  // Tokens are read exactly as in get_token. The position is worked out
+  // from the state of the buffer, so no system calls are made and there
+  // is no need to call tell() before reading the token.
+  //
+  // Tokens read with any of the token reading functions count towards
+  // the ordinal, which starts at 0 when a file is opened or rewound.
+  //
+  // Arguments:
+  // - delims: a string containing all of the characters to
+  //   be used as delimiters for reading tokens.
+  //
+  // Returns:
+  // - the next token in the file with its offset and ordinal,
+  // - nullopt if alrady at EOF or if the file is not open.
+  std::optional<PositionedToken> get_token_with_pos(
+      const std::string& delims = " \t\n\r\v\f");
+
+  // Reads up to `max` tokens from the file into a batch.
+  //
+  // Tokens are read exactly as in get_token, but the whole batch is
+  // read in one call, scanning the buffer directly. Any tokens already
+  // in `batch` are removed first.
+  //
+  // Arguments:
+  // - batch: the batch to fill
+  // - max: the maximum number of tokens to read
+  // - delims: a string containing all of the characters to
+  //   be used as delimiters for reading tokens.
+  //
+  // Returns:
+  // - the number of tokens read. This is less than `max` only if the
+  //   end of file was reached, and 0 if already at EOF or if the file
+  //   is not open.
+  size_t get_tokens(TokenBatch& batch,
+                    size_t max,
+                    const std::string& delims = " \t\n\r\v\f");
+
+  // Reads the rest of the file token by token, passing each token
+  // to `sink`.
+  //
+  // Tokens are read exactly as in get_token, but this scans the buffer
+  // directly and never creates a string, so it is the cheapest way to
+  // look at every token once. This is a template so that the call to
+  // `sink` can be inlined.
+  //
+  // Arguments:
+  // - delims: a string containing all of the characters to
+  //   be used as delimiters for reading tokens.
+  // - sink: called as sink(std::string_view token) for each token. The
+  //   view is only valid during the call. If sink returns a bool,
+  //   returning false stops reading after that token.
+  //
+  // Returns:
+  // - the number of tokens passed to sink,
+  // - 0 if already at EOF or if the file is not open.
+  template <typename F>
+  size_t for_each_token(const std::string& delims, F&& sink);
+
+  // Reads the next token from the file and interns it into a dictionary.
+  //
+  // Tokens are read exactly as in get_token, but the token is scanned
+  // directly out of the buffer and no string is created for it.
+  //
+  // Arguments:
+  // - dict: the dictionary to intern the token into
+  // - delims: a string containing all of the characters to
+  //   be used as delimiters for reading tokens.
+  //
+  // Returns:
+  // - the id of the next token in `dict`,
+  // - nullopt if already at EOF or if the file is not open.
+  std::optional<uint32_t> get_token_id(
+      TermDictionary& dict,
+      const std::string& delims = " \t\n\r\v\f");
+
   // Returns the current position the user is in to the file.
   //
   // Arguments: None
@@ -149,6 +276,17 @@ class BufferedFileReader {
   // Arguments: None
   void rewind();
 
+  // Moves to a position in the file that is currently open, so that
+  // the next read starts there. Token ordinals are not changed.
+  //
+  // Arguments:
+  // - offset: the offset from the start of the file
+  //
+  // Returns:
+  // - true if the reader moved
+  // - false if there is no open file or the offset is negative
+  bool seek(off_t offset);
+
   // Returns whether or not the file is available for reading
   // (e.g. if the file is open and not at the end of file)
   // Note: The reader is only considered to be at the end of file
@@ -201,11 +339,107 @@ class BufferedFileReader {
   std::array<char, BUF_SIZE> buffer_;  // The buffer we maintiain for reading
                                        // from the file.
 
+  off_t buffer_offset_;  // Offset in the file of the first char in the
+                         // buffer. Lets us know where we are in the
+                         // file without calling lseek.
+
+  uint64_t token_ordinal_;  // The number of tokens read so far
+
   int fd_;     // The File Descriptor that we use to manage our file.
   bool good_;  // Whether or not the reader is good to read
 
+  std::string delims_;                  // The delimiters last used to read
+  std::array<bool, 256> delims_table_;  // For each byte, whether it is in
+                                        // delims_
+
+  std::string token_scratch_;  // Holds tokens that span more than one
+                               // fill of the buffer.
+
   // Helper method to fill the buffer with data from the file
   void fill_buffer();
+
+  // Helper method that returns a lookup table for a set of delimiters.
+  // The table is only rebuilt when the delimiters change.
+  const std::array<bool, 256>& delims_table(const std::string& delims);
+
+  // Helper method that reads the next token by scanning the buffer
+  // directly, without going through get_char.
+  //
+  // On success, `token` refers either into buffer_ or, if the token spans
+  // a refill, into token_scratch_. Either way it is only valid until
+  // the next read from the file.
+  //
+  // Returns false if already at EOF or if the file is not open.
+  bool next_token(const std::array<bool, 256>& table, std::string_view* token);
 };
 
+template <typename F>
+size_t BufferedFileReader::for_each_token(const std::string& delims,
+                                          F&& sink) {
+  if (!good_ || fd_ < 0) {
+    return 0;
+  }
+
+  // Passes a token to the sink, returns whether to keep reading
+  auto emit = [&sink](std::string_view token) {
+    if constexpr (std::is_same_v<std::invoke_result_t<F&, std::string_view>,
+                                 bool>) {
+      return sink(token);
+    } else {
+      sink(token);
+      return true;
+    }
+  };
+
+  const std::array<bool, 256>& table = delims_table(delims);
+  size_t count = 0;
+  bool spilled = false;  // Whether the current token is in token_scratch_
+
+  while (true) {
+    if (curr_length_ == 0 || curr_index_ >= curr_length_) {
+      fill_buffer();
+      if (curr_length_ == 0) {
+        // EOF acts as the delimiter of the last token
+        token_ordinal_++;
+        emit(spilled ? std::string_view(token_scratch_) : std::string_view());
+        return count + 1;
+      }
+    }
+
+    const char* buf = buffer_.data();
+    size_t start = curr_index_;
+    for (size_t i = curr_index_; i < curr_length_; i++) {
+      if (!table[static_cast<unsigned char>(buf[i])]) {
+        continue;
+      }
+
+      std::string_view token(buf + start, i - start);
+      if (spilled) {
+        token_scratch_.append(token);
+        token = token_scratch_;
+        spilled = false;
+      }
+
+      // mark the delimiter as read before handing out the token
+      curr_index_ = i + 1;
+      token_ordinal_++;
+      count++;
+      if (!emit(token)) {
+        return count;
+      }
+      start = i + 1;
+    }
+
+    // The token continues past the end of the buffer,
+    // save what we have before the buffer is refilled.
+    if (spilled) {
+      token_scratch_.append(buf + start, buf + curr_length_);
+    } else {
+      token_scratch_.assign(buf + start, buf + curr_length_);
+      spilled = true;
+    }
+    curr_index_ = curr_length_;
+  }
+}
+
 #endif  // BUFFEREDFILEREADER_HPP_
\ No newline at end of file
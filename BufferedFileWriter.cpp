@@ -0,0 +1,134 @@
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "BufferedFileWriter.hpp"
+#include "ByteIO.hpp"
+
+BufferedFileWriter::BufferedFileWriter(const std::string& fname,
+                                       RateLimiter* limiter)
+    : offset_(0), limiter_(limiter) {
+  fd_ = open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  good_ = (fd_ >= 0);
+  buffer_.reserve(BUF_SIZE);
+}
+
+BufferedFileWriter::~BufferedFileWriter() {
+  close_file();
+}
+
+BufferedFileWriter::BufferedFileWriter(BufferedFileWriter&& other)
+    : buffer_(std::move(other.buffer_)),
+      offset_(other.offset_),
+      limiter_(other.limiter_),
+      fd_(other.fd_),
+      good_(other.good_) {
+  other.fd_ = -1;
+  other.good_ = false;
+  other.buffer_.clear();
+}
+
+BufferedFileWriter& BufferedFileWriter::operator=(
+    BufferedFileWriter&& other) {
+  if (this == &other) {
+    return *this;
+  }
+  close_file();
+  buffer_ = std::move(other.buffer_);
+  offset_ = other.offset_;
+  limiter_ = other.limiter_;
+  fd_ = other.fd_;
+  good_ = other.good_;
+
+  other.fd_ = -1;
+  other.good_ = false;
+  other.buffer_.clear();
+  return *this;
+}
+
+bool BufferedFileWriter::write(const void* data, size_t len) {
+  if (!good_) {
+    return false;
+  }
+  const char* p = static_cast<const char*>(data);
+  if (buffer_.size() + len <= BUF_SIZE) {
+    buffer_.insert(buffer_.end(), p, p + len);
+    return true;
+  }
+
+  // Top up the buffer and write it out, then either write the
+  // rest straight out or start the next buffer with it
+  size_t fill = BUF_SIZE - buffer_.size();
+  buffer_.insert(buffer_.end(), p, p + fill);
+  flush();
+  p += fill;
+  len -= fill;
+  if (len >= BUF_SIZE) {
+    write_through(p, len);
+  } else {
+    buffer_.insert(buffer_.end(), p, p + len);
+  }
+  return good_;
+}
+
+bool BufferedFileWriter::write(std::string_view data) {
+  return write(data.data(), data.length());
+}
+
+bool BufferedFileWriter::write_varint(uint64_t value) {
+  uint8_t bytes[ByteIO::kMaxVarintBytes];
+  size_t len = ByteIO::encode_varint(value, bytes);
+  return write(bytes, len);
+}
+
+bool BufferedFileWriter::flush() {
+  if (!buffer_.empty()) {
+    write_through(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+  return good_;
+}
+
+bool BufferedFileWriter::close_file() {
+  if (fd_ < 0) {
+    return false;
+  }
+  flush();
+  good_ = (close(fd_) == 0) && good_;
+  fd_ = -1;
+  bool ok = good_;
+  good_ = false;
+  return ok;
+}
+
+uint64_t BufferedFileWriter::tell() const {
+  return offset_ + buffer_.size();
+}
+
+bool BufferedFileWriter::good() const {
+  return good_ && (fd_ >= 0);
+}
+
+void BufferedFileWriter::write_through(const char* data, size_t len) {
+  if (!good_) {
+    return;
+  }
+  if (limiter_ != nullptr) {
+    limiter_->acquire(len);
+  }
+  offset_ += len;
+  while (len > 0) {
+    ssize_t res = ::write(fd_, data, len);
+    if (res < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      good_ = false;
+      return;
+    }
+    data += res;
+    len -= static_cast<size_t>(res);
+  }
+}
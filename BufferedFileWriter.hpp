@@ -0,0 +1,97 @@
+#ifndef BUFFEREDFILEWRITER_HPP_
+#define BUFFEREDFILEWRITER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "RateLimiter.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// A BufferedFileWriter is the writing counterpart of a BufferedFileReader.
+//
+// Writes are collected in a buffer and handed to the OS a buffer at a
+// time, so many small writes cost few system calls. Writes larger than
+// the buffer go straight to the file. Every write to the file can be
+// made to wait on a RateLimiter first.
+//
+// Errors are sticky: once a write fails, good() is false and nothing
+// more is written, so a sequence of writes can be checked once at the end.
+///////////////////////////////////////////////////////////////////////////////
+class BufferedFileWriter {
+ public:
+  // Constructor for a BufferedFileWriter. Creates the file, truncating
+  // it if it exists. If it can't be created, good() is false.
+  //
+  // Arguments:
+  // - fname: The name of the file to be written
+  // - limiter: if not nullptr, every write to the file waits on it first
+  BufferedFileWriter(const std::string& fname, RateLimiter* limiter = nullptr);
+
+  // Destructor for a BufferedFileWriter. Writes out the buffer
+  // and closes the file.
+  ~BufferedFileWriter();
+
+  // Move Constructor for the BufferedFileWriter. `other` is left
+  // with no file.
+  BufferedFileWriter(BufferedFileWriter&& other);
+
+  // Move assignment operator for the BufferedFileWriter. Any file
+  // of *this is closed first. `other` is left with no file.
+  BufferedFileWriter& operator=(BufferedFileWriter&& other);
+
+  // Writes bytes to the file.
+  //
+  // Arguments:
+  // - data: the bytes to write
+  // - len: the number of bytes
+  //
+  // Returns:
+  // - whether every write so far has succeeded
+  bool write(const void* data, size_t len);
+
+  // Writes a string to the file, as above
+  bool write(std::string_view data);
+
+  // Writes a value with 7 bits per byte, low bits first, so small
+  // values take one byte. Returns as above.
+  bool write_varint(uint64_t value);
+
+  // Writes out the buffer. Returns as above.
+  bool flush();
+
+  // Writes out the buffer and closes the file.
+  //
+  // Returns:
+  // - whether everything written reached the file and it was closed
+  // - false if there is no file open
+  bool close_file();
+
+  // Returns the number of bytes written so far, including any
+  // still in the buffer
+  uint64_t tell() const;
+
+  // Returns whether the file is open and every write so far succeeded
+  bool good() const;
+
+  // Ignore These
+  // This is disabling the copy constructor and the assignment operator.
+  BufferedFileWriter(const BufferedFileWriter& other) = delete;
+  BufferedFileWriter& operator=(const BufferedFileWriter& other) = delete;
+
+ private:
+  static constexpr size_t BUF_SIZE = 64 * 1024;  // the size of the buffer.
+
+  // Helper method to write bytes straight to the file
+  void write_through(const char* data, size_t len);
+
+  std::vector<char> buffer_;  // Bytes not yet handed to the OS
+  uint64_t offset_;           // Bytes handed to the OS so far
+  RateLimiter* limiter_;
+  int fd_;
+  bool good_;
+};
+
+#endif  // BUFFEREDFILEWRITER_HPP_
@@ -0,0 +1,76 @@
+#ifndef BYTEIO_HPP_
+#define BYTEIO_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// ByteIO reads and writes the values the file formats are made of.
+//
+// Varints hold 7 bits per byte, low bits first, with the top bit set on
+// every byte but the last, so small values take one byte. Fixed size
+// values are read with memcpy, since in a mapped file they may not be
+// aligned.
+///////////////////////////////////////////////////////////////////////////////
+class ByteIO {
+ public:
+  // The most bytes a 64 bit varint takes
+  static constexpr size_t kMaxVarintBytes = 10;
+
+  // Encodes a varint.
+  //
+  // Arguments:
+  // - v: the value
+  // - out: where to store it, with room for kMaxVarintBytes
+  //
+  // Returns:
+  // - the number of bytes stored
+  static size_t encode_varint(uint64_t v, uint8_t* out) {
+    size_t len = 0;
+    while (v >= 0x80) {
+      out[len++] = static_cast<uint8_t>(v | 0x80);
+      v >>= 7;
+    }
+    out[len++] = static_cast<uint8_t>(v);
+    return len;
+  }
+
+  // Appends a varint to out
+  static void put_varint(uint64_t v, std::vector<uint8_t>* out) {
+    uint8_t bytes[kMaxVarintBytes];
+    size_t len = encode_varint(v, bytes);
+    out->insert(out->end(), bytes, bytes + len);
+  }
+
+  // Decodes a varint.
+  //
+  // Arguments:
+  // - p: the first byte of the varint
+  // - v: set to the value
+  //
+  // Returns:
+  // - a pointer just past the varint
+  static const uint8_t* get_varint(const uint8_t* p, uint64_t* v) {
+    uint64_t result = 0;
+    int shift = 0;
+    while ((*p & 0x80) != 0) {
+      result |= static_cast<uint64_t>(*p & 0x7F) << shift;
+      shift += 7;
+      p++;
+    }
+    *v = result | (static_cast<uint64_t>(*p) << shift);
+    return p + 1;
+  }
+
+  // Reads a fixed size value that may not be aligned
+  template <typename T>
+  static T load(const uint8_t* p) {
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+  }
+};
+
+#endif  // BYTEIO_HPP_
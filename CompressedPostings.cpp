@@ -0,0 +1,80 @@
+#include <algorithm>
+
+#include "CompressedPostings.hpp"
+#include "StreamVByte.hpp"
+
+// StreamVByte may read this far past the end of the data,
+// when there are at least 4 values to decode at once
+static constexpr size_t kPadding = 16;
+
+CompressedPostings::CompressedPostings() : size_(0) {}
+
+CompressedPostings::CompressedPostings(const PostingList& list)
+    : size_(list.size()) {
+  uint32_t gaps[kBlockSize];
+  uint32_t prev = 0;
+  for (size_t start = 0; start < size_; start += kBlockSize) {
+    size_t n = std::min(kBlockSize, size_ - start);
+    for (size_t i = 0; i < n; i++) {
+      uint32_t doc = list.docs[start + i];
+      gaps[i] = doc - prev;
+      prev = doc;
+    }
+    offsets_.push_back(static_cast<uint32_t>(bytes_.size()));
+    last_docs_.push_back(prev);
+    StreamVByte::encode(gaps, n, &bytes_);
+    StreamVByte::encode(list.freqs.data() + start, n, &bytes_);
+  }
+  if (size_ >= 4) {
+    bytes_.resize(bytes_.size() + kPadding, 0);
+  }
+  bytes_.shrink_to_fit();
+}
+
+size_t CompressedPostings::decode_block(size_t block,
+                                        uint32_t* docs,
+                                        uint32_t* freqs) const {
+  size_t n = std::min(kBlockSize, size_ - block * kBlockSize);
+  const uint8_t* p = bytes_.data() + offsets_[block];
+  p = StreamVByte::decode(p, n, docs);
+  StreamVByte::decode(p, n, freqs);
+  StreamVByte::prefix_sum(docs, n, block == 0 ? 0 : last_docs_[block - 1]);
+  return n;
+}
+
+PostingList CompressedPostings::decode() const {
+  PostingList list;
+  list.docs.resize(size_);
+  list.freqs.resize(size_);
+  for (size_t block = 0; block < num_blocks(); block++) {
+    decode_block(block, list.docs.data() + block * kBlockSize,
+                 list.freqs.data() + block * kBlockSize);
+  }
+  return list;
+}
+
+size_t CompressedPostings::find_block(uint32_t doc) const {
+  return std::lower_bound(last_docs_.begin(), last_docs_.end(), doc) -
+         last_docs_.begin();
+}
+
+uint32_t CompressedPostings::block_last_doc(size_t block) const {
+  return last_docs_[block];
+}
+
+size_t CompressedPostings::size() const {
+  return size_;
+}
+
+size_t CompressedPostings::num_blocks() const {
+  return offsets_.size();
+}
+
+size_t CompressedPostings::encoded_bytes() const {
+  return bytes_.size() - (size_ >= 4 ? kPadding : 0);
+}
+
+size_t CompressedPostings::memory_bytes() const {
+  return bytes_.capacity() +
+         (last_docs_.capacity() + offsets_.capacity()) * sizeof(uint32_t);
+}
@@ -0,0 +1,79 @@
+#ifndef COMPRESSEDPOSTINGS_HPP_
+#define COMPRESSEDPOSTINGS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "InvertedIndex.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// A CompressedPostings holds a posting list in compressed blocks.
+//
+// The postings are cut into blocks of kBlockSize. Within a block the doc
+// ids are replaced by the gaps between them, which are small, and the gaps
+// and the frequencies are each encoded with StreamVByte. The last doc id
+// of every block and where the block starts are kept uncompressed, so a
+// search can skip to the block that may hold a doc id and decode just it.
+///////////////////////////////////////////////////////////////////////////////
+class CompressedPostings {
+ public:
+  // The number of postings in a block. Only the last block may be shorter.
+  static constexpr size_t kBlockSize = 128;
+
+  // Constructor for an empty CompressedPostings
+  CompressedPostings();
+
+  // Constructor for a CompressedPostings. Compresses a posting list.
+  //
+  // Arguments:
+  // - list: the postings, with doc ids in increasing order
+  CompressedPostings(const PostingList& list);
+
+  // Decodes one block.
+  //
+  // Arguments:
+  // - block: the index of the block
+  // - docs: where to store the doc ids, room for kBlockSize
+  // - freqs: where to store the frequencies, room for kBlockSize
+  //
+  // Returns:
+  // - the number of postings in the block
+  size_t decode_block(size_t block, uint32_t* docs, uint32_t* freqs) const;
+
+  // Decodes all of the postings
+  PostingList decode() const;
+
+  // Finds the first block that may contain a doc id.
+  //
+  // Arguments:
+  // - doc: the doc id to look for
+  //
+  // Returns:
+  // - the index of the first block whose last doc id is >= doc
+  // - num_blocks() if doc is past every block
+  size_t find_block(uint32_t doc) const;
+
+  // Returns the last doc id of a block
+  uint32_t block_last_doc(size_t block) const;
+
+  // Returns the number of postings
+  size_t size() const;
+
+  // Returns the number of blocks
+  size_t num_blocks() const;
+
+  // Returns the number of bytes of encoded postings
+  size_t encoded_bytes() const;
+
+  // Returns the number of bytes used, including the block index
+  size_t memory_bytes() const;
+
+ private:
+  size_t size_;
+  std::vector<uint8_t> bytes_;        // Encoded blocks, then padding
+  std::vector<uint32_t> last_docs_;   // Last doc id of each block
+  std::vector<uint32_t> offsets_;     // Where each block starts in bytes_
+};
+
+#endif  // COMPRESSEDPOSTINGS_HPP_
@@ -0,0 +1,62 @@
+#include <algorithm>
+
+#include "CountMinSketch.hpp"
+#include "TermHash.hpp"
+
+CountMinSketch::CountMinSketch(size_t width, size_t depth)
+    : width_(std::max<size_t>(1, width)),
+      depth_(std::max<size_t>(1, depth)),
+      total_(0),
+      counters_(width_ * depth_, 0) {}
+
+void CountMinSketch::add(std::string_view term, uint64_t by) {
+  uint64_t h = hash_term(term);
+  for (size_t row = 0; row < depth_; row++) {
+    counters_[index(h, row)] += by;
+  }
+  total_ += by;
+}
+
+uint64_t CountMinSketch::estimate(std::string_view term) const {
+  uint64_t h = hash_term(term);
+  uint64_t res = UINT64_MAX;
+  for (size_t row = 0; row < depth_; row++) {
+    res = std::min(res, counters_[index(h, row)]);
+  }
+  return res;
+}
+
+bool CountMinSketch::merge(const CountMinSketch& other) {
+  if (width_ != other.width_ || depth_ != other.depth_) {
+    return false;
+  }
+  for (size_t i = 0; i < counters_.size(); i++) {
+    counters_[i] += other.counters_[i];
+  }
+  total_ += other.total_;
+  return true;
+}
+
+uint64_t CountMinSketch::total() const {
+  return total_;
+}
+
+size_t CountMinSketch::width() const {
+  return width_;
+}
+
+size_t CountMinSketch::depth() const {
+  return depth_;
+}
+
+size_t CountMinSketch::memory_bytes() const {
+  return counters_.size() * sizeof(uint64_t);
+}
+
+size_t CountMinSketch::index(uint64_t hash, size_t row) const {
+  // Double hashing: row r uses h1 + r * h2, which is as good as
+  // independent hash functions for this purpose
+  uint64_t h1 = hash & 0xFFFFFFFF;
+  uint64_t h2 = (hash >> 32) | 1;
+  return row * width_ + (h1 + row * h2) % width_;
+}
@@ -0,0 +1,71 @@
+#ifndef COUNTMINSKETCH_HPP_
+#define COUNTMINSKETCH_HPP_
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// A CountMinSketch estimates how often each term of a stream occurs,
+// in a fixed amount of memory no matter how many distinct terms there are.
+//
+// The sketch is `depth` rows of `width` counters. A term increments one
+// counter in each row, chosen by a hash of the term, and its estimate is
+// the smallest of those counters. Collisions only ever add to a counter,
+// so estimates are never too low, and with probability 1 - e^-depth an
+// estimate is within e * total / width of the true count.
+///////////////////////////////////////////////////////////////////////////////
+class CountMinSketch {
+ public:
+  // Constructor for an empty CountMinSketch.
+  //
+  // Arguments:
+  // - width: the number of counters per row, at least 1
+  // - depth: the number of rows, at least 1
+  CountMinSketch(size_t width = 4096, size_t depth = 4);
+
+  // Counts occurrences of a term.
+  //
+  // Arguments:
+  // - term: the term
+  // - by: the number of occurrences
+  void add(std::string_view term, uint64_t by = 1);
+
+  // Returns the estimated count of a term, never less than the true count
+  uint64_t estimate(std::string_view term) const;
+
+  // Adds the counts of another sketch to this one. The result is the
+  // sketch of both streams together.
+  //
+  // Arguments:
+  // - other: the sketch to merge in
+  //
+  // Returns:
+  // - true if the sketches were merged
+  // - false if they have different dimensions, in which case
+  //   this sketch is unchanged
+  bool merge(const CountMinSketch& other);
+
+  // Returns the total of all counts added
+  uint64_t total() const;
+
+  // Returns the number of counters per row
+  size_t width() const;
+
+  // Returns the number of rows
+  size_t depth() const;
+
+  // Returns the number of bytes used by the counters
+  size_t memory_bytes() const;
+
+ private:
+  // Helper method that returns the counter for a term in a row
+  size_t index(uint64_t hash, size_t row) const;
+
+  size_t width_;
+  size_t depth_;
+  uint64_t total_;
+  std::vector<uint64_t> counters_;  // Row r is [r * width_, (r + 1) * width_)
+};
+
+#endif  // COUNTMINSKETCH_HPP_
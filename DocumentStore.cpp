@@ -0,0 +1,141 @@
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "DocumentStore.hpp"
+#include "LZCodec.hpp"
+
+// Reads len bytes at offset, returning false if they can't all be read
+static bool read_at(int fd, void* buf, size_t len, uint64_t offset) {
+  char* p = static_cast<char*>(buf);
+  while (len > 0) {
+    ssize_t n = pread(fd, p, len, static_cast<off_t>(offset));
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    p += n;
+    len -= n;
+    offset += n;
+  }
+  return true;
+}
+
+DocumentStore::DocumentStore(const std::string& fname)
+    : fd_(-1), raw_bytes_(0), file_bytes_(0), good_(false) {
+  fd_ = open(fname.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd_ < 0 || fstat(fd_, &st) < 0) {
+    return;
+  }
+  uint64_t size = static_cast<uint64_t>(st.st_size);
+  if (size < sizeof(Header) + sizeof(Footer)) {
+    return;
+  }
+
+  Header header;
+  Footer footer;
+  if (!read_at(fd_, &header, sizeof(header), 0) ||
+      !read_at(fd_, &footer, sizeof(footer), size - sizeof(footer)) ||
+      memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion ||
+      memcmp(footer.magic, kMagic, sizeof(kMagic)) != 0) {
+    return;
+  }
+
+  // Check that the tables are in order and inside the file
+  // before sizing anything by them
+  uint64_t end = size - sizeof(Footer);
+  if (footer.blocks_offset < sizeof(Header) || footer.blocks_offset > end ||
+      footer.num_blocks > (end - footer.blocks_offset) / sizeof(BlockEntry) ||
+      footer.docs_offset !=
+          footer.blocks_offset + footer.num_blocks * sizeof(BlockEntry) ||
+      footer.num_docs > (end - footer.docs_offset) / sizeof(DocEntry) ||
+      footer.docs_offset + footer.num_docs * sizeof(DocEntry) != end) {
+    return;
+  }
+  blocks_.resize(footer.num_blocks);
+  docs_.resize(footer.num_docs);
+  if (!read_at(fd_, blocks_.data(), blocks_.size() * sizeof(BlockEntry),
+               footer.blocks_offset) ||
+      !read_at(fd_, docs_.data(), docs_.size() * sizeof(DocEntry),
+               footer.docs_offset)) {
+    return;
+  }
+
+  // and that every block is in the file and every document in its block
+  for (const BlockEntry& block : blocks_) {
+    if (block.offset < sizeof(Header) ||
+        block.offset + block.compressed_len > footer.blocks_offset) {
+      return;
+    }
+  }
+  for (const DocEntry& doc : docs_) {
+    if (doc.block >= blocks_.size() ||
+        static_cast<uint64_t>(doc.offset) + doc.length >
+            blocks_[doc.block].raw_len) {
+      return;
+    }
+  }
+  raw_bytes_ = footer.raw_bytes;
+  file_bytes_ = size;
+  good_ = true;
+}
+
+DocumentStore::~DocumentStore() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+bool DocumentStore::good() const {
+  return good_;
+}
+
+std::optional<std::string> DocumentStore::fetch(uint32_t doc) const {
+  if (!good_ || doc >= docs_.size()) {
+    return std::nullopt;
+  }
+  const DocEntry& entry = docs_[doc];
+  const BlockEntry& block = blocks_[entry.block];
+  std::vector<uint8_t> compressed(block.compressed_len);
+  std::vector<uint8_t> raw(block.raw_len);
+  if (!read_at(fd_, compressed.data(), compressed.size(), block.offset) ||
+      !LZCodec::decompress(compressed.data(), compressed.size(), raw.data(),
+                           raw.size())) {
+    return std::nullopt;
+  }
+  return std::string(reinterpret_cast<const char*>(raw.data()) + entry.offset,
+                     entry.length);
+}
+
+uint32_t DocumentStore::doc_bytes(uint32_t doc) const {
+  return docs_[doc].length;
+}
+
+size_t DocumentStore::num_docs() const {
+  return docs_.size();
+}
+
+size_t DocumentStore::num_blocks() const {
+  return blocks_.size();
+}
+
+uint64_t DocumentStore::raw_bytes() const {
+  return raw_bytes_;
+}
+
+uint64_t DocumentStore::file_bytes() const {
+  return file_bytes_;
+}
+
+size_t DocumentStore::memory_bytes() const {
+  return blocks_.capacity() * sizeof(BlockEntry) +
+         docs_.capacity() * sizeof(DocEntry);
+}
@@ -0,0 +1,126 @@
+#ifndef DOCUMENTSTORE_HPP_
+#define DOCUMENTSTORE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// A DocumentStore holds the text of every document of an index, packed
+// into compressed blocks, so a result's text can be shown without going
+// back to its file.
+//
+// Documents are packed into blocks of up to kBlockBytes, and each block
+// is compressed with LZCodec on its own. A document is never split: one
+// that doesn't fit in what is left of a block starts the next one, and
+// one larger than kBlockBytes gets a block of its own, so fetching a
+// small document never decompresses more than kBlockBytes.
+//
+// Opening a store reads the block and document tables into memory, 12
+// bytes per document and 16 per block. Fetching a document then takes
+// one pread() of its block and one decompression.
+//
+// The file is laid out as:
+// - a header with a magic number and version
+// - the compressed blocks
+// - the block table: the offset and size of each block
+// - the document table: each document's block, offset in the
+//   decompressed block and length
+// - a footer, at the end of the file, with the offsets of the above
+///////////////////////////////////////////////////////////////////////////////
+class DocumentStore {
+ public:
+  // The number of bytes of text a block is filled to
+  static constexpr size_t kBlockBytes = 16 * 1024;
+
+  // Constructor for a DocumentStore. Opens the file and reads its
+  // tables. If it can't be read or is not a store, good() is false.
+  //
+  // Arguments:
+  // - fname: the name of the store file
+  DocumentStore(const std::string& fname);
+
+  // Destructor for a DocumentStore. Closes the file.
+  ~DocumentStore();
+
+  // Returns whether the store was opened
+  bool good() const;
+
+  // Reads the text of a document. Safe to call from several threads.
+  //
+  // Arguments:
+  // - doc: the id of the document
+  //
+  // Returns:
+  // - the text of the document
+  // - nullopt if there is no such document or its block can't be read
+  std::optional<std::string> fetch(uint32_t doc) const;
+
+  // Returns the length of a document in bytes
+  uint32_t doc_bytes(uint32_t doc) const;
+
+  // Returns the number of documents
+  size_t num_docs() const;
+
+  // Returns the number of blocks
+  size_t num_blocks() const;
+
+  // Returns the number of bytes of text in all documents
+  uint64_t raw_bytes() const;
+
+  // Returns the size of the store file in bytes
+  uint64_t file_bytes() const;
+
+  // Returns the number of bytes allocated for the tables
+  size_t memory_bytes() const;
+
+  // Ignore These
+  // This is disabling the copy constructor and the assignment operator.
+  DocumentStore(const DocumentStore& other) = delete;
+  DocumentStore& operator=(const DocumentStore& other) = delete;
+
+ private:
+  friend class DocumentStoreWriter;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t reserved[2];
+  };
+
+  struct Footer {
+    uint64_t blocks_offset;  // The block table
+    uint64_t num_blocks;
+    uint64_t docs_offset;    // The document table
+    uint64_t num_docs;
+    uint64_t raw_bytes;
+    char magic[8];
+  };
+
+  struct BlockEntry {
+    uint64_t offset;
+    uint32_t compressed_len;
+    uint32_t raw_len;
+  };
+
+  struct DocEntry {
+    uint32_t block;
+    uint32_t offset;  // In the decompressed block
+    uint32_t length;
+  };
+
+  static constexpr char kMagic[8] = {'D', 'O', 'C', 'S', 'T', 'O', 'R', 'E'};
+  static constexpr uint32_t kVersion = 1;
+
+  int fd_;
+  std::vector<BlockEntry> blocks_;
+  std::vector<DocEntry> docs_;
+  uint64_t raw_bytes_;
+  uint64_t file_bytes_;
+  bool good_;
+};
+
+#endif  // DOCUMENTSTORE_HPP_
@@ -0,0 +1,106 @@
+#include <cstring>
+#include <limits>
+
+#include "DocumentStoreWriter.hpp"
+#include "LZCodec.hpp"
+#include "MappedFile.hpp"
+
+bool DocumentStoreWriter::write(const InvertedIndex& index,
+                                const std::string& fname) {
+  DocumentStoreWriter writer(fname);
+  for (uint32_t doc = 0; doc < index.num_docs(); doc++) {
+    if (writer.add_file(index.doc_name(doc)) != doc) {
+      return false;
+    }
+  }
+  return writer.finish();
+}
+
+DocumentStoreWriter::DocumentStoreWriter(const std::string& fname,
+                                         size_t block_bytes)
+    : out_(fname),
+      block_bytes_(block_bytes),
+      finished_(false),
+      raw_bytes_(0) {
+  DocumentStore::Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, DocumentStore::kMagic, sizeof(header.magic));
+  header.version = DocumentStore::kVersion;
+  out_.write(&header, sizeof(header));
+}
+
+bool DocumentStoreWriter::good() const {
+  return out_.good();
+}
+
+std::optional<uint32_t> DocumentStoreWriter::add(std::string_view text) {
+  constexpr uint64_t kMax = std::numeric_limits<uint32_t>::max();
+  if (finished_ || !out_.good() || text.size() > kMax ||
+      docs_.size() == kMax) {
+    return std::nullopt;
+  }
+
+  // A document that doesn't fit starts a new block, so a small
+  // document never shares its block with a large one
+  if (!block_.empty() && block_.size() + text.size() > block_bytes_) {
+    flush_block();
+  }
+  uint32_t id = static_cast<uint32_t>(docs_.size());
+  docs_.push_back(DocumentStore::DocEntry{
+      static_cast<uint32_t>(blocks_.size()),
+      static_cast<uint32_t>(block_.size()),
+      static_cast<uint32_t>(text.size())});
+  block_.append(text);
+  raw_bytes_ += text.size();
+  if (block_.size() >= block_bytes_) {
+    flush_block();
+  }
+  if (!out_.good()) {
+    return std::nullopt;
+  }
+  return id;
+}
+
+std::optional<uint32_t> DocumentStoreWriter::add_file(
+    const std::string& fname) {
+  MappedFile file(fname);
+  if (!file.good()) {
+    return std::nullopt;
+  }
+  return add(file.contents());
+}
+
+bool DocumentStoreWriter::finish() {
+  if (finished_) {
+    return false;
+  }
+  // The last block may hold only empty documents, but it still has to exist
+  if (!docs_.empty() && docs_.back().block == blocks_.size()) {
+    flush_block();
+  }
+  finished_ = true;
+
+  DocumentStore::Footer footer;
+  footer.blocks_offset = out_.tell();
+  footer.num_blocks = blocks_.size();
+  out_.write(blocks_.data(),
+             blocks_.size() * sizeof(DocumentStore::BlockEntry));
+  footer.docs_offset = out_.tell();
+  footer.num_docs = docs_.size();
+  out_.write(docs_.data(), docs_.size() * sizeof(DocumentStore::DocEntry));
+  footer.raw_bytes = raw_bytes_;
+  memcpy(footer.magic, DocumentStore::kMagic, sizeof(footer.magic));
+  out_.write(&footer, sizeof(footer));
+  return out_.close_file();
+}
+
+void DocumentStoreWriter::flush_block() {
+  compressed_.clear();
+  LZCodec::compress(reinterpret_cast<const uint8_t*>(block_.data()),
+                    block_.size(), &compressed_);
+  blocks_.push_back(DocumentStore::BlockEntry{
+      out_.tell(), static_cast<uint32_t>(compressed_.size()),
+      static_cast<uint32_t>(block_.size())});
+  out_.write(compressed_.data(), compressed_.size());
+  block_.clear();
+}
@@ -0,0 +1,96 @@
+#ifndef DOCUMENTSTOREWRITER_HPP_
+#define DOCUMENTSTOREWRITER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BufferedFileWriter.hpp"
+#include "DocumentStore.hpp"
+#include "InvertedIndex.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// A DocumentStoreWriter writes a DocumentStore file one document at a time.
+//
+// Only the block being filled and the tables are held in memory. Each
+// block is compressed and written out once it is full, and finish()
+// writes the tables and the footer.
+///////////////////////////////////////////////////////////////////////////////
+class DocumentStoreWriter {
+ public:
+  // Writes the documents of an InvertedIndex to a store, reading
+  // each one from its file.
+  //
+  // Arguments:
+  // - index: the index. The documents keep their ids.
+  // - fname: the name of the store file
+  //
+  // Returns:
+  // - true if the store was written
+  // - false if a document could not be read or the store written
+  static bool write(const InvertedIndex& index, const std::string& fname);
+
+  // Constructor for a DocumentStoreWriter. Creates the file,
+  // truncating it if it exists. If it can't be created, good() is false.
+  //
+  // Arguments:
+  // - fname: the name of the store file
+  // - block_bytes: the number of bytes of text to fill each block to
+  DocumentStoreWriter(const std::string& fname,
+                      size_t block_bytes = DocumentStore::kBlockBytes);
+
+  // Returns whether everything so far has been written
+  bool good() const;
+
+  // Adds the next document. Documents are numbered in the order
+  // they are added, from 0.
+  //
+  // Arguments:
+  // - text: the text of the document
+  //
+  // Returns:
+  // - the id of the document
+  // - nullopt if the document is too large or writing failed
+  std::optional<uint32_t> add(std::string_view text);
+
+  // Adds a file as the next document, as above.
+  //
+  // Arguments:
+  // - fname: the name of the file
+  //
+  // Returns:
+  // - the id of the document
+  // - nullopt if the file could not be read, or as above
+  std::optional<uint32_t> add_file(const std::string& fname);
+
+  // Writes the last block, the tables and the footer
+  // and closes the file. Nothing can be added after.
+  //
+  // Returns:
+  // - true if the store was written, false otherwise
+  bool finish();
+
+  // Ignore These
+  // This is disabling the copy constructor and the assignment operator.
+  DocumentStoreWriter(const DocumentStoreWriter& other) = delete;
+  DocumentStoreWriter& operator=(const DocumentStoreWriter& other) = delete;
+
+ private:
+  // Helper method that compresses and writes out the current block
+  void flush_block();
+
+  BufferedFileWriter out_;
+  size_t block_bytes_;
+  bool finished_;
+
+  std::string block_;                // The text of the block being filled
+  std::vector<uint8_t> compressed_;  // Its compression
+  std::vector<DocumentStore::BlockEntry> blocks_;
+  std::vector<DocumentStore::DocEntry> docs_;
+  uint64_t raw_bytes_;
+};
+
+#endif  // DOCUMENTSTOREWRITER_HPP_
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+
+#include <unistd.h>
+
+#include "BufferedFileReader.hpp"
+#include "BufferedFileWriter.hpp"
+#include "ByteIO.hpp"
+#include "ExternalIndexBuilder.hpp"
+#include "MappedFile.hpp"
+#include "SegmentWriter.hpp"
+
+// Numbers the builders of this process, so their runs get distinct names
+static std::atomic<uint64_t> next_builder(0);
+
+// Reads a run: for each term in order, the length of the term, the
+// term, the number of postings and then each posting as the gap from
+// the doc id before it and the frequency, all as varints
+struct RunReader {
+  RunReader(const std::string& fname)
+      : file(fname),
+        p(reinterpret_cast<const uint8_t*>(file.contents().data())),
+        end(p + file.size()),
+        num_postings(0) {}
+
+  // Moves to the next term, returns false if there is none
+  bool next() {
+    if (!file.good() || p == end) {
+      return false;
+    }
+    uint64_t len;
+    p = ByteIO::get_varint(p, &len);
+    term = std::string_view(reinterpret_cast<const char*>(p), len);
+    p = ByteIO::get_varint(p + len, &num_postings);
+    return true;
+  }
+
+  // Appends the postings of the current term to list. The doc ids of
+  // a run are all at least those of the runs before it, but the first
+  // may be the document the last run ended in.
+  void read_postings(PostingList* list) {
+    uint64_t doc = 0;
+    for (uint64_t i = 0; i < num_postings; i++) {
+      uint64_t gap;
+      uint64_t freq;
+      p = ByteIO::get_varint(p, &gap);
+      p = ByteIO::get_varint(p, &freq);
+      doc += gap;
+      if (i == 0 && list->size() > 0 && list->docs.back() == doc) {
+        list->freqs.back() += static_cast<uint32_t>(freq);
+      } else {
+        list->docs.push_back(static_cast<uint32_t>(doc));
+        list->freqs.push_back(static_cast<uint32_t>(freq));
+      }
+    }
+  }
+
+  MappedFile file;
+  const uint8_t* p;
+  const uint8_t* end;
+  std::string_view term;
+  uint64_t num_postings;
+};
+
+ExternalIndexBuilder::ExternalIndexBuilder(const std::string& temp_dir,
+                                           size_t budget_bytes,
+                                           const std::string& delims,
+                                           bool fold_case)
+    : temp_dir_(temp_dir),
+      budget_bytes_(std::max(budget_bytes, kMinBudget)),
+      delims_(delims),
+      fold_case_(fold_case),
+      good_(true),
+      memory_bytes_(dict_.memory_bytes()),
+      peak_memory_bytes_(memory_bytes_),
+      num_runs_(0) {}
+
+ExternalIndexBuilder::~ExternalIndexBuilder() {
+  remove_runs();
+}
+
+bool ExternalIndexBuilder::good() const {
+  return good_;
+}
+
+std::optional<uint32_t> ExternalIndexBuilder::add_file(
+    const std::string& fname) {
+  BufferedFileReader reader(fname);
+  if (!good_ || !reader.good()) {
+    return std::nullopt;
+  }
+  uint32_t doc = static_cast<uint32_t>(doc_names_.size());
+  doc_names_.push_back(fname);
+  doc_lengths_.push_back(0);
+
+  std::string scratch;
+  reader.for_each_token(delims_, [&](std::string_view token) {
+    if (token.empty()) {
+      return;
+    }
+    doc_lengths_[doc]++;
+    if (fold_case_) {
+      token = fold_token(token, &scratch);
+    }
+    add_token(token);
+  });
+  if (!good_) {
+    return std::nullopt;
+  }
+  return doc;
+}
+
+bool ExternalIndexBuilder::add_directory(const std::string& dir) {
+  std::optional<std::vector<std::string>> files = list_directory(dir);
+  if (!files.has_value()) {
+    return false;
+  }
+  for (const std::string& fname : files.value()) {
+    add_file(fname);
+  }
+  return true;
+}
+
+bool ExternalIndexBuilder::build(const std::string& fname) {
+  if (!good_ || !spill()) {
+    remove_runs();
+    return false;
+  }
+  good_ = false;
+
+  SegmentWriter writer(fname);
+  for (uint32_t doc = 0; doc < doc_names_.size(); doc++) {
+    writer.add_doc(doc_names_[doc], doc_lengths_[doc]);
+  }
+
+  // A min heap of the runs by their current term. Ties go to the
+  // earlier run, so equal terms come off the heap in doc id order.
+  std::vector<RunReader> readers;
+  readers.reserve(runs_.size());
+  std::vector<size_t> heap;
+  for (size_t i = 0; i < runs_.size(); i++) {
+    readers.emplace_back(runs_[i]);
+    if (!readers[i].file.good()) {
+      remove_runs();
+      return false;
+    }
+    if (readers[i].next()) {
+      heap.push_back(i);
+    }
+  }
+  auto greater = [&readers](size_t a, size_t b) {
+    int cmp = readers[a].term.compare(readers[b].term);
+    return cmp > 0 || (cmp == 0 && a > b);
+  };
+  std::make_heap(heap.begin(), heap.end(), greater);
+
+  std::string term;
+  PostingList merged;
+  bool ok = true;
+  while (ok && !heap.empty()) {
+    term.assign(readers[heap.front()].term);
+    merged.docs.clear();
+    merged.freqs.clear();
+    while (!heap.empty() && readers[heap.front()].term == term) {
+      size_t i = heap.front();
+      std::pop_heap(heap.begin(), heap.end(), greater);
+      heap.pop_back();
+      readers[i].read_postings(&merged);
+      if (readers[i].next()) {
+        heap.push_back(i);
+        std::push_heap(heap.begin(), heap.end(), greater);
+      }
+    }
+    ok = writer.add_term(term, merged);
+  }
+  ok = ok && writer.finish();
+
+  readers.clear();
+  remove_runs();
+  return ok;
+}
+
+size_t ExternalIndexBuilder::num_runs() const {
+  return num_runs_;
+}
+
+size_t ExternalIndexBuilder::memory_bytes() const {
+  return memory_bytes_;
+}
+
+size_t ExternalIndexBuilder::peak_memory_bytes() const {
+  return peak_memory_bytes_;
+}
+
+void ExternalIndexBuilder::add_token(std::string_view term) {
+  uint32_t doc = static_cast<uint32_t>(doc_names_.size() - 1);
+  std::optional<uint32_t> id = dict_.find(term);
+  if (!id.has_value()) {
+    // A new term grows the dictionary, and may grow the table of
+    // postings. The old buffers are alive until they are moved, so
+    // spill first if the new ones would go over the budget.
+    size_t dict_growth = dict_.growth_bytes(term.length());
+    size_t capacity = postings_.capacity();
+    if (postings_.size() == capacity) {
+      capacity = std::max<size_t>(64, capacity * 2);
+    }
+    size_t table_growth = capacity == postings_.capacity()
+                              ? 0
+                              : capacity * sizeof(PostingList);
+    if (memory_bytes_ + dict_growth + table_growth > budget_bytes_ &&
+        dict_.size() > 0) {
+      if (!spill()) {
+        return;
+      }
+      add_token(term);
+      return;
+    }
+
+    size_t dict_bytes = dict_.memory_bytes();
+    id = dict_.intern(term);
+    if (dict_.memory_bytes() != dict_bytes) {
+      peak_memory_bytes_ =
+          std::max(peak_memory_bytes_, memory_bytes_ + dict_growth);
+      memory_bytes_ += dict_.memory_bytes() - dict_bytes;
+    }
+    if (table_growth > 0) {
+      peak_memory_bytes_ =
+          std::max(peak_memory_bytes_, memory_bytes_ + table_growth);
+      memory_bytes_ += (capacity - postings_.capacity()) * sizeof(PostingList);
+      postings_.reserve(capacity);
+    }
+    postings_.emplace_back();
+  }
+
+  PostingList* list = &postings_[id.value()];
+  if (!list->docs.empty() && list->docs.back() == doc) {
+    list->freqs.back()++;
+    return;
+  }
+
+  // Grow the list ourselves, so we know what it costs, and spill
+  // first if that would go over the budget
+  if (list->docs.size() == list->docs.capacity()) {
+    size_t capacity = std::max<size_t>(4, list->docs.capacity() * 2);
+    size_t growth = (capacity - list->docs.capacity()) * 2 * sizeof(uint32_t);
+    if (memory_bytes_ + growth > budget_bytes_) {
+      if (!spill()) {
+        return;
+      }
+      add_token(term);
+      return;
+    }
+    list->docs.reserve(capacity);
+    list->freqs.reserve(capacity);
+    memory_bytes_ += growth;
+  }
+  list->docs.push_back(doc);
+  list->freqs.push_back(1);
+  peak_memory_bytes_ = std::max(peak_memory_bytes_, memory_bytes_);
+}
+
+bool ExternalIndexBuilder::spill() {
+  if (dict_.size() == 0) {
+    return good_;
+  }
+
+  std::vector<uint32_t> ids(dict_.size());
+  for (uint32_t id = 0; id < ids.size(); id++) {
+    ids[id] = id;
+  }
+  std::sort(ids.begin(), ids.end(), [this](uint32_t a, uint32_t b) {
+    return dict_.term(a) < dict_.term(b);
+  });
+
+  if (runs_.empty()) {
+    // the first run picks the names of all of them
+    run_prefix_ = "run" + std::to_string(getpid()) + "_" +
+                  std::to_string(next_builder++) + "_";
+  }
+  std::string fname =
+      (std::filesystem::path(temp_dir_) /
+       (run_prefix_ + std::to_string(runs_.size()) + ".tmp"))
+          .string();
+  runs_.push_back(fname);
+  num_runs_++;
+
+  BufferedFileWriter out(fname);
+  for (uint32_t id : ids) {
+    std::string_view term = dict_.term(id);
+    const PostingList& list = postings_[id];
+    out.write_varint(term.length());
+    out.write(term);
+    out.write_varint(list.size());
+    uint32_t prev = 0;
+    for (size_t i = 0; i < list.size(); i++) {
+      out.write_varint(list.docs[i] - prev);
+      out.write_varint(list.freqs[i]);
+      prev = list.docs[i];
+    }
+  }
+  good_ = out.close_file() && good_;
+
+  // Start over, giving the memory back
+  dict_ = TermDictionary();
+  postings_ = std::vector<PostingList>();
+  memory_bytes_ = dict_.memory_bytes();
+  return good_;
+}
+
+void ExternalIndexBuilder::remove_runs() {
+  for (const std::string& run : runs_) {
+    std::remove(run.c_str());
+  }
+  runs_.clear();
+}
@@ -0,0 +1,133 @@
+#ifndef EXTERNALINDEXBUILDER_HPP_
+#define EXTERNALINDEXBUILDER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "InvertedIndex.hpp"
+#include "TermDictionary.hpp"
+#include "TextUtil.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// An ExternalIndexBuilder builds an IndexSegment of more text than fits
+// in memory, keeping its postings within a fixed budget of bytes.
+//
+// Postings are collected in memory as in an InvertedIndex. Once they
+// reach the budget, the terms are sorted and the postings written out
+// as a run with a BufferedFileWriter, and collecting starts over. This
+// can happen partway through a document. build() then merges all of the
+// runs in one pass, a k-way merge on a heap that holds one term per run,
+// and writes the segment with a SegmentWriter. Runs are read through
+// MappedFile, so the OS pages them in and out as the merge moves along.
+//
+// The terms and postings in memory count towards the budget, including
+// the old buffers that are alive while a table grows. The names and
+// lengths of the documents are kept in memory until the end, as is the
+// dictionary of the segment being written: one front coded entry per
+// term.
+///////////////////////////////////////////////////////////////////////////////
+class ExternalIndexBuilder {
+ public:
+  // The smallest budget allowed, smaller budgets are raised to it
+  static constexpr size_t kMinBudget = 64 * 1024;
+
+  // Constructor for an ExternalIndexBuilder.
+  //
+  // Arguments:
+  // - temp_dir: the directory to write the runs to
+  // - budget_bytes: the most memory the terms and postings may take
+  // - delims: the delimiters used to split files into tokens
+  // - fold_case: whether to convert ASCII letters to lower case
+  ExternalIndexBuilder(
+      const std::string& temp_dir,
+      size_t budget_bytes,
+      const std::string& delims = kDefaultDelims,
+      bool fold_case = true);
+
+  // Destructor for an ExternalIndexBuilder. Removes any runs.
+  ~ExternalIndexBuilder();
+
+  // Returns whether every run so far was written
+  bool good() const;
+
+  // Adds a file to the index as a new document. Its id is
+  // the number of documents added before it.
+  //
+  // Arguments:
+  // - fname: The name of the file
+  //
+  // Returns:
+  // - the id of the document
+  // - nullopt if the file could not be opened or a run
+  //   could not be written
+  std::optional<uint32_t> add_file(const std::string& fname);
+
+  // Adds every regular file in a directory, in order of file name.
+  // Sub directories are not searched.
+  //
+  // Arguments:
+  // - dir: the name of the directory
+  //
+  // Returns:
+  // - true if the directory was read
+  // - false otherwise
+  bool add_directory(const std::string& dir);
+
+  // Writes out what is left in memory, merges every run into a
+  // segment and removes the runs. Nothing can be added after.
+  //
+  // Arguments:
+  // - fname: the name of the segment file
+  //
+  // Returns:
+  // - true if the segment was written, false otherwise
+  bool build(const std::string& fname);
+
+  // Returns the number of runs written so far
+  size_t num_runs() const;
+
+  // Returns about how much memory the terms and postings take now
+  size_t memory_bytes() const;
+
+  // Returns the most memory_bytes() has been
+  size_t peak_memory_bytes() const;
+
+  // Ignore These
+  // This is disabling the copy constructor and the assignment operator.
+  ExternalIndexBuilder(const ExternalIndexBuilder& other) = delete;
+  ExternalIndexBuilder& operator=(const ExternalIndexBuilder& other) = delete;
+
+ private:
+  // Helper method that sorts the postings in memory by term,
+  // writes them out as a run, and clears them
+  bool spill();
+
+  // Helper method that adds a posting of a term to the current document
+  void add_token(std::string_view term);
+
+  // Helper method to remove the run files
+  void remove_runs();
+
+  std::string temp_dir_;
+  size_t budget_bytes_;
+  std::string delims_;
+  bool fold_case_;
+  bool good_;
+
+  TermDictionary dict_;
+  std::vector<PostingList> postings_;  // Indexed by term id
+  size_t memory_bytes_;
+  size_t peak_memory_bytes_;
+
+  std::string run_prefix_;         // Makes the names of the runs unique
+  std::vector<std::string> runs_;  // The file names of the runs
+  size_t num_runs_;
+  std::vector<std::string> doc_names_;
+  std::vector<uint32_t> doc_lengths_;
+};
+
+#endif  // EXTERNALINDEXBUILDER_HPP_
@@ -0,0 +1,162 @@
+#include <cstring>
+#include <functional>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "FlatTermTable.hpp"
+
+static constexpr size_t kInitialGroups = 16;
+
+// The hash of a term. The low 7 bits go in the control byte,
+// the rest pick the group to start probing at.
+static uint64_t hash_term(std::string_view term) {
+  uint64_t h = std::hash<std::string_view>()(term);
+  // std::hash may be weak in the low bits, mix them up
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// Returns a bit mask with bit i set if ctrl[i] == value, for
+// the kGroupSize control bytes starting at ctrl.
+static uint32_t match_group(const int8_t* ctrl, int8_t value) {
+#ifdef __SSE2__
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+  __m128i cmp = _mm_cmpeq_epi8(group, _mm_set1_epi8(value));
+  return static_cast<uint32_t>(_mm_movemask_epi8(cmp));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < 16; i++) {
+    if (ctrl[i] == value) {
+      mask |= 1U << i;
+    }
+  }
+  return mask;
+#endif
+}
+
+FlatTermTable::FlatTermTable() : size_(0), group_mask_(0) {
+  clear();
+}
+
+uint64_t FlatTermTable::increment(std::string_view term, uint64_t by) {
+  uint64_t h = hash_term(term);
+  bool found;
+  size_t slot = probe(term, h, &found);
+  if (found) {
+    entries_[slot].count += by;
+    return entries_[slot].count;
+  }
+
+  // Insert the term. Grow first if that would make the table more than
+  // 7/8 full, which keeps probe sequences short.
+  if ((size_ + 1) * 8 > ctrl_.size() * 7) {
+    grow();
+    slot = probe(term, h, &found);
+  }
+
+  Entry& e = entries_[slot];
+  e.offset = static_cast<uint32_t>(arena_.size());
+  e.length = static_cast<uint32_t>(term.length());
+  e.count = by;
+  arena_.insert(arena_.end(), term.begin(), term.end());
+  ctrl_[slot] = static_cast<int8_t>(h & 0x7f);
+  size_++;
+  return by;
+}
+
+std::optional<uint64_t> FlatTermTable::find(std::string_view term) const {
+  bool found;
+  size_t slot = probe(term, hash_term(term), &found);
+  if (!found) {
+    return std::nullopt;
+  }
+  return entries_[slot].count;
+}
+
+size_t FlatTermTable::size() const {
+  return size_;
+}
+
+size_t FlatTermTable::memory_bytes() const {
+  return ctrl_.capacity() * sizeof(int8_t) +
+         entries_.capacity() * sizeof(Entry) + arena_.capacity();
+}
+
+void FlatTermTable::clear() {
+  ctrl_.assign(kInitialGroups * kGroupSize, kEmpty);
+  entries_.assign(kInitialGroups * kGroupSize, Entry());
+  arena_.clear();
+  size_ = 0;
+  group_mask_ = kInitialGroups - 1;
+}
+
+size_t FlatTermTable::probe(std::string_view term,
+                            uint64_t hash,
+                            bool* found) const {
+  int8_t h2 = static_cast<int8_t>(hash & 0x7f);
+  size_t group = (hash >> 7) & group_mask_;
+
+  // Triangular probing over groups visits every group once,
+  // since the number of groups is a power of 2.
+  for (size_t step = 1;; step++) {
+    const int8_t* ctrl = ctrl_.data() + group * kGroupSize;
+
+    uint32_t matches = match_group(ctrl, h2);
+    while (matches != 0) {
+      size_t slot = group * kGroupSize + __builtin_ctz(matches);
+      const Entry& e = entries_[slot];
+      if (e.length == term.length() &&
+          memcmp(arena_.data() + e.offset, term.data(), e.length) == 0) {
+        *found = true;
+        return slot;
+      }
+      matches &= matches - 1;
+    }
+
+    // Nothing is ever removed, so an empty slot in the group
+    // means the term is not in the table.
+    uint32_t empties = match_group(ctrl, kEmpty);
+    if (empties != 0) {
+      *found = false;
+      return group * kGroupSize + __builtin_ctz(empties);
+    }
+
+    group = (group + step) & group_mask_;
+  }
+}
+
+void FlatTermTable::grow() {
+  std::vector<int8_t> old_ctrl = std::move(ctrl_);
+  std::vector<Entry> old_entries = std::move(entries_);
+
+  ctrl_.assign(old_ctrl.size() * 2, kEmpty);
+  entries_.assign(old_entries.size() * 2, Entry());
+  group_mask_ = ctrl_.size() / kGroupSize - 1;
+
+  // Every term is distinct, so each one goes in the first
+  // empty slot of its probe sequence.
+  for (size_t i = 0; i < old_ctrl.size(); i++) {
+    if (old_ctrl[i] == kEmpty) {
+      continue;
+    }
+    const Entry& e = old_entries[i];
+    std::string_view term(arena_.data() + e.offset, e.length);
+    uint64_t h = hash_term(term);
+    size_t group = (h >> 7) & group_mask_;
+    for (size_t step = 1;; step++) {
+      uint32_t empties =
+          match_group(ctrl_.data() + group * kGroupSize, kEmpty);
+      if (empties != 0) {
+        size_t slot = group * kGroupSize + __builtin_ctz(empties);
+        ctrl_[slot] = static_cast<int8_t>(h & 0x7f);
+        entries_[slot] = e;
+        break;
+      }
+      group = (group + step) & group_mask_;
+    }
+  }
+}
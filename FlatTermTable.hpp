@@ -0,0 +1,98 @@
+#ifndef FLATTERMTABLE_HPP_
+#define FLATTERMTABLE_HPP_
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// A FlatTermTable maps terms to counts. It is meant for counting the
+// tokens of a file, where almost every operation is "add one to the
+// count of this term, inserting it if it is new".
+//
+// Unlike std::unordered_map, nothing is allocated per entry. The table
+// is a flat array of entries plus one control byte per entry, in the
+// style of Abseil's Swiss tables: a control byte is either "empty" or
+// holds 7 bits of the entry's hash. Lookups compare a group of 16 control
+// bytes at once with SSE2, and only look at the entries whose control
+// byte matches. Terms are copied into one contiguous arena and entries
+// refer to them by offset.
+///////////////////////////////////////////////////////////////////////////////
+class FlatTermTable {
+ public:
+  // Constructor for an empty FlatTermTable.
+  FlatTermTable();
+
+  // Adds to the count of a term, inserting the term if it is
+  // not in the table yet.
+  //
+  // Arguments:
+  // - term: the term to count
+  // - by: the amount to add to its count
+  //
+  // Returns:
+  // - the new count of the term
+  uint64_t increment(std::string_view term, uint64_t by = 1);
+
+  // Looks up the count of a term.
+  //
+  // Arguments:
+  // - term: the term to look for
+  //
+  // Returns:
+  // - the count of the term
+  // - nullopt if the term is not in the table
+  std::optional<uint64_t> find(std::string_view term) const;
+
+  // Calls f(std::string_view term, uint64_t count) for every term
+  // in the table, in no particular order.
+  template <typename F>
+  void for_each(F&& f) const;
+
+  // Returns the number of distinct terms in the table
+  size_t size() const;
+
+  // Returns the number of bytes of memory used by the table
+  size_t memory_bytes() const;
+
+  // Removes all terms from the table
+  void clear();
+
+ private:
+  // Number of control bytes compared at once
+  static constexpr size_t kGroupSize = 16;
+  static constexpr int8_t kEmpty = -128;
+
+  struct Entry {
+    uint32_t offset;  // Where the term starts in the arena
+    uint32_t length;  // Length of the term
+    uint64_t count;
+  };
+
+  // Helper method that finds the slot holding `term` or, if the
+  // term is not present, the slot it should be inserted into.
+  // `found` is set to say which it is.
+  size_t probe(std::string_view term, uint64_t hash, bool* found) const;
+
+  // Helper method that doubles the number of slots
+  void grow();
+
+  std::vector<int8_t> ctrl_;     // One control byte per slot
+  std::vector<Entry> entries_;   // One entry per slot
+  std::vector<char> arena_;      // The bytes of every term
+  size_t size_;                  // Number of full slots
+  size_t group_mask_;            // Number of groups - 1
+};
+
+template <typename F>
+void FlatTermTable::for_each(F&& f) const {
+  for (size_t i = 0; i < ctrl_.size(); i++) {
+    if (ctrl_[i] != kEmpty) {
+      const Entry& e = entries_[i];
+      f(std::string_view(arena_.data() + e.offset, e.length), e.count);
+    }
+  }
+}
+
+#endif  // FLATTERMTABLE_HPP_
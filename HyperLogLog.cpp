@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <cmath>
+
+#include "HyperLogLog.hpp"
+#include "TermHash.hpp"
+
+HyperLogLog::HyperLogLog(int precision)
+    : precision_(std::clamp(precision, kMinPrecision, kMaxPrecision)),
+      registers_(size_t(1) << precision_, 0) {}
+
+void HyperLogLog::add(std::string_view term) {
+  uint64_t h = hash_term(term);
+  size_t index = h >> (64 - precision_);
+
+  // Leading zeros of the remaining bits, plus one. The 1 bit put
+  // after them caps the run when they are all zero.
+  uint64_t rest = (h << precision_) | (uint64_t(1) << (precision_ - 1));
+  uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+  registers_[index] = std::max(registers_[index], rank);
+}
+
+uint64_t HyperLogLog::estimate() const {
+  double m = static_cast<double>(registers_.size());
+  double sum = 0;
+  size_t zeros = 0;
+  for (uint8_t r : registers_) {
+    sum += std::ldexp(1.0, -r);
+    zeros += (r == 0);
+  }
+
+  // The raw estimate, with the bias correction from the paper
+  double alpha = 0.7213 / (1 + 1.079 / m);
+  if (registers_.size() == 16) {
+    alpha = 0.673;
+  } else if (registers_.size() == 32) {
+    alpha = 0.697;
+  } else if (registers_.size() == 64) {
+    alpha = 0.709;
+  }
+  double estimate = alpha * m * m / sum;
+
+  // For small counts, counting the empty registers is more accurate
+  if (estimate <= 2.5 * m && zeros > 0) {
+    estimate = m * std::log(m / static_cast<double>(zeros));
+  }
+  return static_cast<uint64_t>(std::llround(estimate));
+}
+
+bool HyperLogLog::merge(const HyperLogLog& other) {
+  if (precision_ != other.precision_) {
+    return false;
+  }
+  for (size_t i = 0; i < registers_.size(); i++) {
+    registers_[i] = std::max(registers_[i], other.registers_[i]);
+  }
+  return true;
+}
+
+int HyperLogLog::precision() const {
+  return precision_;
+}
+
+size_t HyperLogLog::memory_bytes() const {
+  return registers_.size();
+}
@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "ByteIO.hpp"
+#include "IndexSegment.hpp"
+#include "PhraseQuery.hpp"
+#include "StreamVByte.hpp"
+
+SegmentPostings::SegmentPostings(const uint8_t* start,
+                                 size_t size,
+                                 const uint8_t* positions)
+    : table_(start),
+      data_(start + (size + kBlockSize - 1) / kBlockSize * 2 *
+                        sizeof(uint32_t)),
+      positions_(positions),
+      size_(size) {}
+
+size_t SegmentPostings::decode_block(size_t block,
+                                     uint32_t* docs,
+                                     uint32_t* freqs) const {
+  size_t n = std::min(kBlockSize, size_ - block * kBlockSize);
+  const uint8_t* p = data_ + ByteIO::load<uint32_t>(
+                                 table_ + (block * 2 + 1) * sizeof(uint32_t));
+  p = StreamVByte::decode(p, n, docs);
+  StreamVByte::decode(p, n, freqs);
+  StreamVByte::prefix_sum(docs, n, block == 0 ? 0 : block_last_doc(block - 1));
+  return n;
+}
+
+PostingList SegmentPostings::decode() const {
+  PostingList list;
+  list.docs.resize(size_);
+  list.freqs.resize(size_);
+  for (size_t block = 0; block < num_blocks(); block++) {
+    decode_block(block, list.docs.data() + block * kBlockSize,
+                 list.freqs.data() + block * kBlockSize);
+  }
+  return list;
+}
+
+void SegmentPostings::decode_positions(size_t block,
+                                       const uint32_t* freqs,
+                                       std::vector<uint32_t>* positions) const {
+  size_t n = std::min(kBlockSize, size_ - block * kBlockSize);
+  size_t total = 0;
+  for (size_t i = 0; i < n; i++) {
+    total += freqs[i];
+  }
+  const uint8_t* p =
+      positions_ + num_blocks() * sizeof(uint32_t) +
+      ByteIO::load<uint32_t>(positions_ + block * sizeof(uint32_t));
+  positions->resize(total);
+  StreamVByte::decode(p, total, positions->data());
+
+  // the gaps start over at each document
+  uint32_t* doc_positions = positions->data();
+  for (size_t i = 0; i < n; i++) {
+    StreamVByte::prefix_sum(doc_positions, freqs[i], 0);
+    doc_positions += freqs[i];
+  }
+}
+
+std::vector<uint32_t> SegmentPostings::decode_positions() const {
+  std::vector<uint32_t> res;
+  if (positions_ == nullptr) {
+    return res;
+  }
+  uint32_t docs[kBlockSize];
+  uint32_t freqs[kBlockSize];
+  std::vector<uint32_t> block_positions;
+  for (size_t block = 0; block < num_blocks(); block++) {
+    decode_block(block, docs, freqs);
+    decode_positions(block, freqs, &block_positions);
+    res.insert(res.end(), block_positions.begin(), block_positions.end());
+  }
+  return res;
+}
+
+bool SegmentPostings::has_positions() const {
+  return positions_ != nullptr;
+}
+
+size_t SegmentPostings::find_block(uint32_t doc) const {
+  size_t lo = 0;
+  size_t hi = num_blocks();
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (block_last_doc(mid) < doc) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+uint32_t SegmentPostings::block_last_doc(size_t block) const {
+  return ByteIO::load<uint32_t>(table_ + block * 2 * sizeof(uint32_t));
+}
+
+size_t SegmentPostings::size() const {
+  return size_;
+}
+
+size_t SegmentPostings::num_blocks() const {
+  return (size_ + kBlockSize - 1) / kBlockSize;
+}
+
+IndexSegment::IndexSegment(const std::string& fname)
+    : file_(fname), base_(nullptr), positions_(false), good_(false) {
+  memset(&footer_, 0, sizeof(footer_));
+  size_t size = file_.size();
+  if (!file_.good() || size < sizeof(Header) + sizeof(Footer)) {
+    return;
+  }
+  base_ = reinterpret_cast<const uint8_t*>(file_.contents().data());
+
+  Header header = ByteIO::load<Header>(base_);
+  Footer footer = ByteIO::load<Footer>(base_ + size - sizeof(Footer));
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion ||
+      memcmp(footer.magic, kMagic, sizeof(kMagic)) != 0) {
+    return;
+  }
+
+  // Check that the sections are in order and inside the file, so
+  // a damaged footer can't send a lookup outside of the mapping
+  uint64_t end = size - sizeof(Footer);
+  if (footer.postings_end < sizeof(Header) ||
+      footer.positions_offset < footer.postings_end ||
+      footer.positions_end < footer.positions_offset ||
+      footer.dict_offset < footer.positions_end ||
+      footer.dict_end < footer.dict_offset ||
+      footer.sparse_offset < footer.dict_end ||
+      footer.num_blocks > end / sizeof(SparseEntry) ||
+      footer.sparse_keys_offset <
+          footer.sparse_offset + footer.num_blocks * sizeof(SparseEntry) ||
+      footer.docs_offset < footer.sparse_keys_offset ||
+      footer.num_docs > end / sizeof(DocEntry) ||
+      footer.doc_names_offset <
+          footer.docs_offset + footer.num_docs * sizeof(DocEntry) ||
+      footer.doc_names_offset > end ||
+      footer.num_blocks !=
+          (footer.num_terms + kTermsPerBlock - 1) / kTermsPerBlock) {
+    return;
+  }
+  footer_ = footer;
+  positions_ = (header.flags & kHasPositions) != 0;
+  good_ = true;
+}
+
+bool IndexSegment::good() const {
+  return good_;
+}
+
+std::optional<SegmentPostings> IndexSegment::postings(
+    std::string_view term) const {
+  if (!good_ || footer_.num_blocks == 0) {
+    return std::nullopt;
+  }
+
+  // Find the last block whose first term is <= term
+  size_t lo = 0;
+  size_t hi = footer_.num_blocks;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (block_key(mid) <= term) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == 0) {
+    return std::nullopt;
+  }
+  size_t block = lo - 1;
+
+  // and scan it. The terms are sorted, so stop at the first one past term.
+  const uint8_t* p = block_start(block);
+  std::string current;
+  DictEntry entry{0, 0, 0};
+  for (size_t i = 0; i < block_terms(block); i++) {
+    p = read_entry(p, &current, &entry);
+    if (current == term) {
+      return entry_postings(entry);
+    }
+    if (current > term) {
+      break;
+    }
+  }
+  return std::nullopt;
+}
+
+// The postings of one term of a phrase, with the block
+// the last document looked for was in decoded
+struct PhraseCursor {
+  SegmentPostings postings;
+  size_t block = SIZE_MAX;
+  size_t num_docs = 0;
+  uint32_t docs[SegmentPostings::kBlockSize];
+  uint32_t freqs[SegmentPostings::kBlockSize];
+  bool have_positions = false;
+  std::vector<uint32_t> positions;  // Of the decoded block
+  std::vector<uint32_t> starts;     // Of each document in positions
+
+  explicit PhraseCursor(const SegmentPostings& p) : postings(p) {}
+};
+
+std::vector<Posting> IndexSegment::find_phrase(
+    const std::vector<std::string_view>& terms) const {
+  if (!positions_ || terms.empty()) {
+    return {};
+  }
+  std::vector<PhraseCursor> cursors;
+  cursors.reserve(terms.size());
+  size_t rarest = 0;
+  for (std::string_view term : terms) {
+    std::optional<SegmentPostings> list = postings(term);
+    if (!list.has_value()) {
+      return {};
+    }
+    cursors.emplace_back(list.value());
+    if (list->size() < cursors[rarest].postings.size()) {
+      rarest = cursors.size() - 1;
+    }
+  }
+
+  // Take the documents of the rarest term and skip the others to each,
+  // decoding only the blocks they land in
+  std::vector<Posting> res;
+  std::vector<std::span<const uint32_t>> doc_positions(terms.size());
+  const SegmentPostings& driver = cursors[rarest].postings;
+  uint32_t driver_docs[SegmentPostings::kBlockSize];
+  uint32_t driver_freqs[SegmentPostings::kBlockSize];
+  for (size_t block = 0; block < driver.num_blocks(); block++) {
+    size_t n = driver.decode_block(block, driver_docs, driver_freqs);
+    for (size_t d = 0; d < n; d++) {
+      uint32_t doc = driver_docs[d];
+      bool all = true;
+      for (size_t i = 0; i < cursors.size() && all; i++) {
+        PhraseCursor& c = cursors[i];
+        size_t b = c.postings.find_block(doc);
+        if (b == c.postings.num_blocks()) {
+          // this term has no more documents, so neither does the phrase
+          return res;
+        }
+        if (b != c.block) {
+          c.block = b;
+          c.num_docs = c.postings.decode_block(b, c.docs, c.freqs);
+          c.have_positions = false;
+        }
+        const uint32_t* it = std::lower_bound(c.docs, c.docs + c.num_docs, doc);
+        all = *it == doc;
+        if (!all) {
+          break;
+        }
+        if (!c.have_positions) {
+          c.postings.decode_positions(b, c.freqs, &c.positions);
+          c.starts.resize(c.num_docs);
+          uint32_t start = 0;
+          for (size_t j = 0; j < c.num_docs; j++) {
+            c.starts[j] = start;
+            start += c.freqs[j];
+          }
+          c.have_positions = true;
+        }
+        size_t j = it - c.docs;
+        doc_positions[i] = std::span<const uint32_t>(
+            c.positions.data() + c.starts[j], c.freqs[j]);
+      }
+      if (all) {
+        size_t count = PhraseQuery::count(doc_positions);
+        if (count > 0) {
+          res.push_back(Posting{doc, static_cast<uint32_t>(count)});
+        }
+      }
+    }
+  }
+  return res;
+}
+
+bool IndexSegment::has_positions() const {
+  return positions_;
+}
+
+std::string_view IndexSegment::doc_name(uint32_t doc) const {
+  DocEntry entry = ByteIO::load<DocEntry>(base_ + footer_.docs_offset +
+                                          doc * sizeof(DocEntry));
+  return std::string_view(reinterpret_cast<const char*>(
+                              base_ + footer_.doc_names_offset +
+                              entry.name_offset),
+                          entry.name_len);
+}
+
+uint32_t IndexSegment::doc_length(uint32_t doc) const {
+  return ByteIO::load<DocEntry>(base_ + footer_.docs_offset +
+                                doc * sizeof(DocEntry))
+      .length;
+}
+
+size_t IndexSegment::num_docs() const {
+  return footer_.num_docs;
+}
+
+size_t IndexSegment::num_terms() const {
+  return footer_.num_terms;
+}
+
+uint64_t IndexSegment::num_postings() const {
+  return footer_.num_postings;
+}
+
+uint64_t IndexSegment::total_tokens() const {
+  return footer_.total_tokens;
+}
+
+size_t IndexSegment::file_bytes() const {
+  return file_.size();
+}
+
+IndexSegment::TermIterator IndexSegment::terms() const {
+  return TermIterator(this);
+}
+
+const uint8_t* IndexSegment::read_entry(const uint8_t* p,
+                                        std::string* term,
+                                        DictEntry* entry) const {
+  uint64_t prefix;
+  uint64_t suffix;
+  uint64_t doc_freq;
+  uint64_t delta;
+  p = ByteIO::get_varint(p, &prefix);
+  p = ByteIO::get_varint(p, &suffix);
+  p = ByteIO::get_varint(p, &doc_freq);
+  p = ByteIO::get_varint(p, &delta);
+  entry->postings_offset += delta;
+  if (positions_) {
+    p = ByteIO::get_varint(p, &delta);
+    entry->positions_offset += delta;
+  }
+  term->resize(prefix);
+  term->append(reinterpret_cast<const char*>(p), suffix);
+  entry->doc_freq = static_cast<uint32_t>(doc_freq);
+  return p + suffix;
+}
+
+SegmentPostings IndexSegment::entry_postings(const DictEntry& entry) const {
+  return SegmentPostings(
+      base_ + entry.postings_offset, entry.doc_freq,
+      positions_ ? base_ + footer_.positions_offset + entry.positions_offset
+                 : nullptr);
+}
+
+const uint8_t* IndexSegment::block_start(size_t block) const {
+  SparseEntry entry = ByteIO::load<SparseEntry>(base_ + footer_.sparse_offset +
+                                        block * sizeof(SparseEntry));
+  return base_ + footer_.dict_offset + entry.block_offset;
+}
+
+size_t IndexSegment::block_terms(size_t block) const {
+  return std::min<uint64_t>(kTermsPerBlock,
+                            footer_.num_terms - block * kTermsPerBlock);
+}
+
+std::string_view IndexSegment::block_key(size_t block) const {
+  SparseEntry entry = ByteIO::load<SparseEntry>(base_ + footer_.sparse_offset +
+                                        block * sizeof(SparseEntry));
+  return std::string_view(reinterpret_cast<const char*>(
+                              base_ + footer_.sparse_keys_offset +
+                              entry.key_offset),
+                          entry.key_len);
+}
+
+IndexSegment::TermIterator::TermIterator(const IndexSegment* segment)
+    : segment_(segment), index_(0), p_(nullptr), entry_{0, 0, 0} {
+  if (segment_->good_ && segment_->footer_.num_terms > 0) {
+    p_ = segment_->read_entry(segment_->block_start(0), &term_, &entry_);
+  }
+}
+
+bool IndexSegment::TermIterator::valid() const {
+  return p_ != nullptr;
+}
+
+void IndexSegment::TermIterator::next() {
+  index_++;
+  if (index_ == segment_->footer_.num_terms) {
+    p_ = nullptr;
+    return;
+  }
+  if (index_ % kTermsPerBlock == 0) {
+    // the first term of a block is stored whole
+    // with absolute offsets
+    p_ = segment_->block_start(index_ / kTermsPerBlock);
+    term_.clear();
+    entry_ = DictEntry{0, 0, 0};
+  }
+  p_ = segment_->read_entry(p_, &term_, &entry_);
+}
+
+std::string_view IndexSegment::TermIterator::term() const {
+  return term_;
+}
+
+SegmentPostings IndexSegment::TermIterator::postings() const {
+  return segment_->entry_postings(entry_);
+}
@@ -0,0 +1,284 @@
+#ifndef INDEXSEGMENT_HPP_
+#define INDEXSEGMENT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "InvertedIndex.hpp"
+#include "MappedFile.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// The postings of one term in an IndexSegment, read straight out of the
+// mapped file. The blocks are laid out like those of a CompressedPostings:
+// blocks of up to 128 postings with the doc gaps and frequencies encoded
+// with StreamVByte, after a table of the last doc id and start of each.
+//
+// If the segment has positions, each block of postings has a block of
+// positions in a separate part of the file, so they are only read when
+// asked for: a table of where each block starts, then for each block
+// the positions of its postings, as gaps from the position before in
+// the same document, encoded with StreamVByte.
+///////////////////////////////////////////////////////////////////////////////
+class SegmentPostings {
+ public:
+  // The number of postings in a block. Only the last block may be shorter.
+  static constexpr size_t kBlockSize = 128;
+
+  // Constructor for a SegmentPostings.
+  //
+  // Arguments:
+  // - start: where the postings start in the mapped file
+  // - size: the number of postings
+  // - positions: where the positions start in the mapped file,
+  //   nullptr if there are none
+  SegmentPostings(const uint8_t* start,
+                  size_t size,
+                  const uint8_t* positions = nullptr);
+
+  // Decodes one block, as CompressedPostings::decode_block
+  size_t decode_block(size_t block, uint32_t* docs, uint32_t* freqs) const;
+
+  // Decodes all of the postings
+  PostingList decode() const;
+
+  // Finds the first block whose last doc id is >= doc,
+  // num_blocks() if there is none
+  size_t find_block(uint32_t doc) const;
+
+  // Returns the last doc id of a block
+  uint32_t block_last_doc(size_t block) const;
+
+  // Decodes the positions of one block.
+  //
+  // Arguments:
+  // - block: the block
+  // - freqs: the frequencies of the block, from decode_block()
+  // - positions: set to the positions of each posting of the block in
+  //   turn, the first freqs[0] of them for its first posting and so on
+  void decode_positions(size_t block,
+                        const uint32_t* freqs,
+                        std::vector<uint32_t>* positions) const;
+
+  // Decodes all of the positions, in the order of InvertedIndex::positions
+  std::vector<uint32_t> decode_positions() const;
+
+  // Returns whether there are positions
+  bool has_positions() const;
+
+  // Returns the number of postings
+  size_t size() const;
+
+  // Returns the number of blocks
+  size_t num_blocks() const;
+
+ private:
+  const uint8_t* table_;      // (last doc id, offset) of each block
+  const uint8_t* data_;       // The encoded blocks
+  const uint8_t* positions_;  // Offset of each block's positions
+  size_t size_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// An IndexSegment is an immutable inverted index stored in one file,
+// as written by a SegmentWriter. It is opened by mapping the file into
+// memory: nothing is read or decoded up front, so opening costs the same
+// for any size of segment, and only the parts a query touches are read.
+//
+// The file holds, in order:
+// - a header: magic number and version
+// - the postings of every term, in term order
+// - the positions of every term, in term order, if they were written
+// - the term dictionary: the terms in sorted order, in blocks of
+//   kTermsPerBlock. Within a block each term is stored as the length of
+//   the prefix it shares with the term before it plus the rest of it
+//   (front coding), with its document frequency and the offsets of its
+//   postings and positions.
+// - the sparse index: the first term and offset of each dictionary
+//   block, searched with binary search to find the one block a term
+//   can be in
+// - the document table: each document's name and length in tokens
+// - a footer, at the end of the file, with the offsets of the above
+///////////////////////////////////////////////////////////////////////////////
+class IndexSegment {
+ public:
+  // The number of terms in a block of the dictionary
+  static constexpr size_t kTermsPerBlock = 64;
+
+  // Constructor for an IndexSegment. Maps the file.
+  // If the file can't be mapped or is not a segment, good() is false.
+  //
+  // Arguments:
+  // - fname: The name of the segment file
+  IndexSegment(const std::string& fname);
+
+  // Returns whether the segment was opened
+  bool good() const;
+
+  // Looks up the postings of a term. The term is not case folded.
+  //
+  // Arguments:
+  // - term: the term to look for
+  //
+  // Returns:
+  // - the postings of the term, valid while the segment is open
+  // - nullopt if the term is not in the segment
+  std::optional<SegmentPostings> postings(std::string_view term) const;
+
+  // Walks the terms of a segment in sorted order, decoding the
+  // dictionary one entry at a time
+  class TermIterator;
+
+  // Returns an iterator at the first term, valid while the segment is open
+  TermIterator terms() const;
+
+  // Finds the documents that contain a phrase, as
+  // InvertedIndex::find_phrase. The terms are not case folded. Positions
+  // are only read for the blocks of documents that have every term.
+  std::vector<Posting> find_phrase(
+      const std::vector<std::string_view>& terms) const;
+
+  // Returns whether the segment has the positions of its terms
+  bool has_positions() const;
+
+  // Calls f(std::string_view term, const SegmentPostings& postings)
+  // for every term, in sorted order
+  template <typename F>
+  void for_each_term(F&& f) const;
+
+  // Returns the name of the file of a document
+  std::string_view doc_name(uint32_t doc) const;
+
+  // Returns the number of tokens in a document
+  uint32_t doc_length(uint32_t doc) const;
+
+  // Returns the number of documents
+  size_t num_docs() const;
+
+  // Returns the number of distinct terms
+  size_t num_terms() const;
+
+  // Returns the number of (term, doc) postings
+  uint64_t num_postings() const;
+
+  // Returns the number of tokens in all documents
+  uint64_t total_tokens() const;
+
+  // Returns the size of the segment file in bytes
+  size_t file_bytes() const;
+
+ private:
+  friend class SegmentWriter;
+
+  // The layout of the fixed size parts of the file. Stored as is,
+  // so segments are only portable between little endian machines.
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t reserved[2];
+  };
+
+  // Set in Header::flags if there is a positions section
+  static constexpr uint32_t kHasPositions = 1;
+
+  struct Footer {
+    uint64_t postings_end;        // Postings are [sizeof(Header), this)
+    uint64_t positions_offset;    // The positions, empty if there are none
+    uint64_t positions_end;
+    uint64_t dict_offset;         // The dictionary blocks
+    uint64_t dict_end;
+    uint64_t sparse_offset;       // One SparseEntry per dictionary block
+    uint64_t num_blocks;
+    uint64_t sparse_keys_offset;  // The first term of each block
+    uint64_t docs_offset;         // One DocEntry per document
+    uint64_t doc_names_offset;    // The names of the documents
+    uint64_t num_terms;
+    uint64_t num_docs;
+    uint64_t num_postings;
+    uint64_t total_tokens;
+    char magic[8];
+  };
+
+  struct SparseEntry {
+    uint64_t block_offset;  // Offset of the block from dict_offset
+    uint32_t key_offset;    // Offset of its first term from sparse_keys
+    uint32_t key_len;
+  };
+
+  struct DocEntry {
+    uint32_t name_offset;  // Offset of the name from doc_names
+    uint32_t name_len;
+    uint32_t length;
+  };
+
+  // A term in the dictionary, see read_entry()
+  struct DictEntry {
+    uint32_t doc_freq;
+    uint64_t postings_offset;
+    uint64_t positions_offset;  // From positions_offset in the footer
+  };
+
+  static constexpr char kMagic[8] = {'I', 'D', 'X', 'S', 'E', 'G', '0', '1'};
+  static constexpr uint32_t kVersion = 2;
+
+  // Helper method that decodes the dictionary entry at p, which follows
+  // the entry for `term` in its block (or is the first, with term empty
+  // and entry zeroed). Updates both and returns the next entry.
+  const uint8_t* read_entry(const uint8_t* p,
+                            std::string* term,
+                            DictEntry* entry) const;
+
+  // Helper method that returns the postings of a dictionary entry
+  SegmentPostings entry_postings(const DictEntry& entry) const;
+
+  // Helper methods for the dictionary blocks
+  const uint8_t* block_start(size_t block) const;
+  size_t block_terms(size_t block) const;
+  std::string_view block_key(size_t block) const;
+
+  MappedFile file_;
+  const uint8_t* base_;
+  Footer footer_;
+  bool positions_;  // Whether the segment has positions
+  bool good_;
+};
+
+class IndexSegment::TermIterator {
+ public:
+  // Returns whether the iterator is at a term
+  bool valid() const;
+
+  // Moves to the next term
+  void next();
+
+  // Returns the current term, valid until next()
+  std::string_view term() const;
+
+  // Returns the postings of the current term
+  SegmentPostings postings() const;
+
+ private:
+  friend class IndexSegment;
+
+  // Constructor for a TermIterator at the first term
+  TermIterator(const IndexSegment* segment);
+
+  const IndexSegment* segment_;
+  size_t index_;       // The number of the current term
+  const uint8_t* p_;   // The entry after the current one
+  std::string term_;
+  DictEntry entry_;
+};
+
+template <typename F>
+void IndexSegment::for_each_term(F&& f) const {
+  for (TermIterator it = terms(); it.valid(); it.next()) {
+    f(it.term(), it.postings());
+  }
+}
+
+#endif  // INDEXSEGMENT_HPP_
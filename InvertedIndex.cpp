@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <iterator>
+#include <span>
+
+#include "BufferedFileReader.hpp"
+#include "InvertedIndex.hpp"
+#include "PhraseQuery.hpp"
+
+InvertedIndex::InvertedIndex(const std::string& delims,
+                             bool fold_case,
+                             bool store_positions)
+    : delims_(delims),
+      fold_case_(fold_case),
+      store_positions_(store_positions),
+      num_postings_(0),
+      total_tokens_(0) {}
+
+std::optional<uint32_t> InvertedIndex::add_file(const std::string& fname) {
+  BufferedFileReader reader(fname);
+  if (!reader.good()) {
+    return std::nullopt;
+  }
+  uint32_t doc = static_cast<uint32_t>(doc_names_.size());
+
+  uint32_t length = 0;
+  std::string scratch;
+  reader.for_each_token(delims_, [&](std::string_view token) {
+    if (token.empty()) {
+      return;
+    }
+    uint32_t position = length++;
+    uint32_t id = dict_.intern(normalize(token, &scratch));
+    if (id == postings_.size()) {
+      postings_.emplace_back();
+    }
+    if (store_positions_) {
+      if (id == positions_.size()) {
+        positions_.emplace_back();
+      }
+      positions_[id].push_back(position);
+    }
+
+    // This document's posting is the last one, if the
+    // term has been seen in it already
+    PostingList& list = postings_[id];
+    if (!list.docs.empty() && list.docs.back() == doc) {
+      list.freqs.back()++;
+    } else {
+      list.docs.push_back(doc);
+      list.freqs.push_back(1);
+      num_postings_++;
+    }
+  });
+
+  doc_names_.push_back(fname);
+  doc_lengths_.push_back(length);
+  total_tokens_ += length;
+  return doc;
+}
+
+bool InvertedIndex::add_directory(const std::string& dir) {
+  std::optional<std::vector<std::string>> files = list_directory(dir);
+  if (!files.has_value()) {
+    return false;
+  }
+  for (const std::string& fname : files.value()) {
+    add_file(fname);
+  }
+  return true;
+}
+
+const PostingList* InvertedIndex::postings(std::string_view term) const {
+  std::string scratch;
+  std::optional<uint32_t> id = dict_.find(normalize(term, &scratch));
+  if (!id.has_value()) {
+    return nullptr;
+  }
+  return &postings_[id.value()];
+}
+
+std::vector<uint32_t> InvertedIndex::docs_with_all(
+    const std::vector<std::string_view>& terms) const {
+  std::vector<const PostingList*> lists;
+  for (std::string_view term : terms) {
+    const PostingList* list = postings(term);
+    if (list == nullptr) {
+      return {};
+    }
+    lists.push_back(list);
+  }
+  if (lists.empty()) {
+    return {};
+  }
+
+  // Start from the shortest list, it bounds the result
+  std::sort(lists.begin(), lists.end(),
+            [](const PostingList* a, const PostingList* b) {
+              return a->size() < b->size();
+            });
+  std::vector<uint32_t> res = lists[0]->docs;
+  std::vector<uint32_t> merged;
+  for (size_t i = 1; i < lists.size() && !res.empty(); i++) {
+    merged.clear();
+    std::set_intersection(res.begin(), res.end(), lists[i]->docs.begin(),
+                          lists[i]->docs.end(), std::back_inserter(merged));
+    res.swap(merged);
+  }
+  return res;
+}
+
+std::vector<Posting> InvertedIndex::find_phrase(
+    const std::vector<std::string_view>& terms) const {
+  if (!store_positions_ || terms.empty()) {
+    return {};
+  }
+  std::vector<uint32_t> ids;
+  std::string scratch;
+  for (std::string_view term : terms) {
+    std::optional<uint32_t> id = dict_.find(normalize(term, &scratch));
+    if (!id.has_value()) {
+      return {};
+    }
+    ids.push_back(id.value());
+  }
+
+  // Walk the postings of every term together. next[i] is the next
+  // posting of term i and starts[i] where its positions are.
+  std::vector<size_t> next(ids.size(), 0);
+  std::vector<size_t> starts(ids.size(), 0);
+  std::vector<std::span<const uint32_t>> doc_positions(ids.size());
+  std::vector<Posting> res;
+  const PostingList& first = postings_[ids[0]];
+  for (uint32_t doc : first.docs) {
+    bool all = true;
+    for (size_t i = 0; i < ids.size() && all; i++) {
+      const PostingList& list = postings_[ids[i]];
+      while (next[i] < list.size() && list.docs[next[i]] < doc) {
+        starts[i] += list.freqs[next[i]];
+        next[i]++;
+      }
+      all = next[i] < list.size() && list.docs[next[i]] == doc;
+      if (all) {
+        doc_positions[i] = std::span<const uint32_t>(
+            positions_[ids[i]].data() + starts[i], list.freqs[next[i]]);
+      }
+    }
+    if (all) {
+      size_t count = PhraseQuery::count(doc_positions);
+      if (count > 0) {
+        res.push_back(Posting{doc, static_cast<uint32_t>(count)});
+      }
+    }
+  }
+  return res;
+}
+
+const TermDictionary& InvertedIndex::dictionary() const {
+  return dict_;
+}
+
+const PostingList& InvertedIndex::postings(uint32_t term_id) const {
+  return postings_[term_id];
+}
+
+const std::vector<uint32_t>& InvertedIndex::positions(uint32_t term_id) const {
+  static const std::vector<uint32_t> kNoPositions;
+  if (!store_positions_) {
+    return kNoPositions;
+  }
+  return positions_[term_id];
+}
+
+bool InvertedIndex::has_positions() const {
+  return store_positions_;
+}
+
+const std::string& InvertedIndex::doc_name(uint32_t doc) const {
+  return doc_names_[doc];
+}
+
+uint32_t InvertedIndex::doc_length(uint32_t doc) const {
+  return doc_lengths_[doc];
+}
+
+size_t InvertedIndex::num_docs() const {
+  return doc_names_.size();
+}
+
+size_t InvertedIndex::num_terms() const {
+  return dict_.size();
+}
+
+uint64_t InvertedIndex::num_postings() const {
+  return num_postings_;
+}
+
+uint64_t InvertedIndex::total_tokens() const {
+  return total_tokens_;
+}
+
+size_t InvertedIndex::memory_bytes() const {
+  size_t bytes = dict_.memory_bytes();
+  bytes += postings_.capacity() * sizeof(PostingList);
+  for (const PostingList& list : postings_) {
+    bytes += (list.docs.capacity() + list.freqs.capacity()) * sizeof(uint32_t);
+  }
+  bytes += positions_.capacity() * sizeof(std::vector<uint32_t>);
+  for (const std::vector<uint32_t>& list : positions_) {
+    bytes += list.capacity() * sizeof(uint32_t);
+  }
+  for (const std::string& name : doc_names_) {
+    bytes += sizeof(std::string) + name.capacity();
+  }
+  bytes += doc_lengths_.capacity() * sizeof(uint32_t);
+  return bytes;
+}
+
+std::string_view InvertedIndex::normalize(std::string_view term,
+                                         std::string* scratch) const {
+  if (!fold_case_) {
+    return term;
+  }
+  return fold_token(term, scratch);
+}
@@ -0,0 +1,173 @@
+#ifndef INVERTEDINDEX_HPP_
+#define INVERTEDINDEX_HPP_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "TermDictionary.hpp"
+#include "TextUtil.hpp"
+
+// One entry of a posting list: a document and the number
+// of times the term occurs in it
+struct Posting {
+  uint32_t doc;
+  uint32_t freq;
+
+  bool operator==(const Posting& other) const = default;
+};
+
+// The postings of one term, ordered by doc id. The doc ids and
+// frequencies are kept in two parallel arrays.
+struct PostingList {
+  std::vector<uint32_t> docs;
+  std::vector<uint32_t> freqs;
+
+  // Returns the number of postings
+  size_t size() const { return docs.size(); }
+
+  // Returns the i'th posting
+  Posting operator[](size_t i) const { return Posting{docs[i], freqs[i]}; }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// An InvertedIndex maps each term to the documents it occurs in.
+//
+// Files are tokenized with a BufferedFileReader, and every file is one
+// document. Terms are interned into a TermDictionary, and the posting
+// list of term id t is postings_[t]: two growable arrays, so a list is
+// stored contiguously and is appended to in amortized O(1). Documents are
+// added in id order, so a term's postings are always sorted by doc id
+// and the frequency for the current document is always the last entry.
+///////////////////////////////////////////////////////////////////////////////
+class InvertedIndex {
+ public:
+  // Constructor for an empty InvertedIndex.
+  //
+  // Arguments:
+  // - delims: the delimiters used to split files into tokens
+  // - fold_case: whether to convert ASCII letters to lower case
+  // - store_positions: whether to keep where in each document every
+  //   term occurs, for find_phrase()
+  InvertedIndex(const std::string& delims = kDefaultDelims,
+                bool fold_case = true,
+                bool store_positions = false);
+
+  // Adds a file to the index as a new document. Its id is
+  // the number of documents added before it.
+  //
+  // Arguments:
+  // - fname: The name of the file
+  //
+  // Returns:
+  // - the id of the document
+  // - nullopt if the file could not be opened
+  std::optional<uint32_t> add_file(const std::string& fname);
+
+  // Adds every regular file in a directory to the index, in
+  // order of file name. Sub directories are not searched.
+  //
+  // Arguments:
+  // - dir: the name of the directory
+  //
+  // Returns:
+  // - true if the directory was read
+  // - false otherwise
+  bool add_directory(const std::string& dir);
+
+  // Looks up the postings of a term. The term is case folded
+  // in the same way as the documents were.
+  //
+  // Arguments:
+  // - term: the term to look for
+  //
+  // Returns:
+  // - the postings of the term, invalidated by adding a document
+  // - nullptr if the term occurs in no document
+  const PostingList* postings(std::string_view term) const;
+
+  // Finds the documents that contain every one of a set of terms.
+  //
+  // Arguments:
+  // - terms: the terms to look for
+  //
+  // Returns:
+  // - the ids of the documents, in increasing order.
+  //   Empty if terms is empty.
+  std::vector<uint32_t> docs_with_all(
+      const std::vector<std::string_view>& terms) const;
+
+  // Finds the documents that contain a phrase: the terms one after the
+  // other. Needs the positions of the terms to be stored.
+  //
+  // Arguments:
+  // - terms: the terms of the phrase, in order
+  //
+  // Returns:
+  // - the documents with the phrase, in increasing order of doc id,
+  //   each with the number of times the phrase occurs in it.
+  //   Empty if terms is empty or positions are not stored.
+  std::vector<Posting> find_phrase(
+      const std::vector<std::string_view>& terms) const;
+
+  // Returns the dictionary of terms. The postings of the term with
+  // id t are postings(t).
+  const TermDictionary& dictionary() const;
+
+  // Returns the postings of the term with the specified id
+  const PostingList& postings(uint32_t term_id) const;
+
+  // Returns the positions of every occurrence of the term with the
+  // specified id, in posting order: the first postings(t).freqs[0] are
+  // in postings(t).docs[0], and so on. The position of an occurrence is
+  // the number of tokens before it in its document. Empty if positions
+  // are not stored.
+  const std::vector<uint32_t>& positions(uint32_t term_id) const;
+
+  // Returns whether positions are stored
+  bool has_positions() const;
+
+  // Returns the name of the file of a document
+  const std::string& doc_name(uint32_t doc) const;
+
+  // Returns the number of tokens in a document
+  uint32_t doc_length(uint32_t doc) const;
+
+  // Returns the number of documents
+  size_t num_docs() const;
+
+  // Returns the number of distinct terms
+  size_t num_terms() const;
+
+  // Returns the number of (term, doc) postings
+  uint64_t num_postings() const;
+
+  // Returns the number of tokens in all documents
+  uint64_t total_tokens() const;
+
+  // Returns the number of bytes allocated for the terms,
+  // the posting lists and the documents
+  size_t memory_bytes() const;
+
+ private:
+  // Helper method that folds the case of a term if needed,
+  // using scratch as storage
+  std::string_view normalize(std::string_view term,
+                             std::string* scratch) const;
+
+  std::string delims_;
+  bool fold_case_;
+  bool store_positions_;
+
+  TermDictionary dict_;
+  std::vector<PostingList> postings_;  // Indexed by term id
+  std::vector<std::vector<uint32_t>> positions_;  // Indexed by term id
+  std::vector<std::string> doc_names_;
+  std::vector<uint32_t> doc_lengths_;
+  uint64_t num_postings_;
+  uint64_t total_tokens_;
+};
+
+#endif  // INVERTEDINDEX_HPP_
@@ -0,0 +1,182 @@
+#include <cstring>
+
+#include "ByteIO.hpp"
+#include "LZCodec.hpp"
+
+// The hash table has 1 << kHashBits entries
+static constexpr int kHashBits = 14;
+
+// The number of earlier positions tried for a match
+static constexpr int kMaxChain = 64;
+
+// The last bytes are always literals, so looking
+// for a match never reads past the end
+static constexpr size_t kLastLiterals = 5;
+
+static uint32_t hash(uint32_t v) {
+  return (v * 2654435761U) >> (32 - kHashBits);
+}
+
+// Appends the extra bytes of a length whose 4 bit field was 15
+static void put_length(size_t len, std::vector<uint8_t>* out) {
+  while (len >= 255) {
+    out->push_back(255);
+    len -= 255;
+  }
+  out->push_back(static_cast<uint8_t>(len));
+}
+
+// Reads the extra bytes of a length, returning false past the end
+static bool get_length(const uint8_t** p, const uint8_t* end, size_t* len) {
+  uint8_t b;
+  do {
+    if (*p == end) {
+      return false;
+    }
+    b = *(*p)++;
+    *len += b;
+  } while (b == 255);
+  return true;
+}
+
+// Appends one sequence: literals then a match, if match_len is not 0
+static void put_sequence(const uint8_t* literals,
+                         size_t num_literals,
+                         size_t distance,
+                         size_t match_len,
+                         std::vector<uint8_t>* out) {
+  bool has_match = match_len > 0;
+  size_t lit_field = num_literals < 15 ? num_literals : 15;
+  size_t match_field = 0;
+  if (has_match) {
+    match_len -= LZCodec::kMinMatch;
+    match_field = match_len < 15 ? match_len : 15;
+  }
+  out->push_back(static_cast<uint8_t>(lit_field << 4 | match_field));
+  if (lit_field == 15) {
+    put_length(num_literals - 15, out);
+  }
+  out->insert(out->end(), literals, literals + num_literals);
+  if (has_match) {
+    out->push_back(static_cast<uint8_t>(distance));
+    out->push_back(static_cast<uint8_t>(distance >> 8));
+    if (match_field == 15) {
+      put_length(match_len - 15, out);
+    }
+  }
+}
+
+void LZCodec::compress(const uint8_t* in,
+                       size_t n,
+                       std::vector<uint8_t>* out) {
+  // head[h] is the last position whose 4 bytes hash to h, and
+  // chain[p % kWindow] the position before p with the same hash.
+  // Positions are stored plus one, so 0 ends a chain.
+  constexpr size_t kWindow = kMaxDistance + 1;
+  std::vector<uint32_t> head(1 << kHashBits, 0);
+  std::vector<uint32_t> chain(n < kWindow ? n : kWindow, 0);
+  size_t inserted = 0;
+  auto insert_up_to = [&](size_t pos) {
+    for (; inserted < pos; inserted++) {
+      uint32_t h = hash(ByteIO::load<uint32_t>(in + inserted));
+      chain[inserted % kWindow] = head[h];
+      head[h] = static_cast<uint32_t>(inserted + 1);
+    }
+  };
+
+  size_t anchor = 0;
+  size_t i = 0;
+  size_t limit = n >= kLastLiterals ? n - kLastLiterals : 0;
+  while (i + kMinMatch <= limit) {
+    insert_up_to(i);
+
+    // Take the longest match among the last kMaxChain
+    // positions that shared a hash with this one
+    uint32_t seq = ByteIO::load<uint32_t>(in + i);
+    size_t best_len = 0;
+    size_t best_distance = 0;
+    size_t candidate = head[hash(seq)];
+    for (int tries = 0; tries < kMaxChain && candidate != 0; tries++) {
+      candidate--;
+      if (i - candidate > kMaxDistance) {
+        break;
+      }
+      if (ByteIO::load<uint32_t>(in + candidate) == seq &&
+          in[candidate + best_len] == in[i + best_len]) {
+        size_t len = kMinMatch;
+        while (i + len < limit && in[candidate + len] == in[i + len]) {
+          len++;
+        }
+        if (len > best_len) {
+          best_len = len;
+          best_distance = i - candidate;
+        }
+      }
+      candidate = chain[candidate % kWindow];
+    }
+
+    if (best_len < kMinMatch) {
+      i++;
+      continue;
+    }
+    put_sequence(in + anchor, i - anchor, best_distance, best_len, out);
+    i += best_len;
+    anchor = i;
+  }
+  put_sequence(in + anchor, n - anchor, 0, 0, out);
+}
+
+bool LZCodec::decompress(const uint8_t* in,
+                         size_t n,
+                         uint8_t* out,
+                         size_t out_len) {
+  const uint8_t* end = in + n;
+  size_t written = 0;
+  while (in < end) {
+    uint8_t token = *in++;
+    size_t num_literals = token >> 4;
+    if (num_literals == 15 && !get_length(&in, end, &num_literals)) {
+      return false;
+    }
+    if (num_literals > static_cast<size_t>(end - in) ||
+        num_literals > out_len - written) {
+      return false;
+    }
+    memcpy(out + written, in, num_literals);
+    in += num_literals;
+    written += num_literals;
+    if (in == end) {
+      // the last sequence has no match
+      break;
+    }
+
+    if (end - in < 2) {
+      return false;
+    }
+    size_t distance = in[0] | (static_cast<size_t>(in[1]) << 8);
+    in += 2;
+    size_t match_len = token & 0x0F;
+    if (match_len == 15 && !get_length(&in, end, &match_len)) {
+      return false;
+    }
+    match_len += kMinMatch;
+    if (distance == 0 || distance > written ||
+        match_len > out_len - written) {
+      return false;
+    }
+
+    // The match may overlap what it is copying, a run
+    // of one byte repeated, so copy forwards a byte at a time
+    const uint8_t* from = out + written - distance;
+    uint8_t* to = out + written;
+    if (distance >= match_len) {
+      memcpy(to, from, match_len);
+    } else {
+      for (size_t j = 0; j < match_len; j++) {
+        to[j] = from[j];
+      }
+    }
+    written += match_len;
+  }
+  return written == out_len;
+}
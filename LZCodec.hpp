@@ -0,0 +1,56 @@
+#ifndef LZCODEC_HPP_
+#define LZCODEC_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// LZCodec is a small byte oriented LZ77 compressor in the style of LZ4,
+// meant for blocks of text that are decompressed often and compressed once.
+//
+// The output is a list of sequences. Each is a token byte holding the
+// number of literal bytes (high 4 bits) and the length of the match less
+// kMinMatch (low 4 bits), where 15 means more length bytes follow, each
+// added on until one is less than 255. Then come the literals, then the
+// match's distance back as 2 bytes, low byte first. The last sequence
+// has literals only. Matches are found by hashing the 4 bytes at each
+// position and trying the longest of the last few positions with the
+// same hash, which is slower to compress than taking the first but
+// gives better compression for the same decompression speed.
+///////////////////////////////////////////////////////////////////////////////
+class LZCodec {
+ public:
+  // The shortest match that is encoded
+  static constexpr size_t kMinMatch = 4;
+
+  // The furthest back a match can be
+  static constexpr size_t kMaxDistance = 65535;
+
+  // Appends the compression of `n` bytes to out.
+  //
+  // Arguments:
+  // - in: the bytes to compress
+  // - n: the number of bytes
+  // - out: the buffer to append to
+  static void compress(const uint8_t* in, size_t n, std::vector<uint8_t>* out);
+
+  // Decompresses bytes written by compress(). Damaged input is caught
+  // rather than read or written past.
+  //
+  // Arguments:
+  // - in: the compressed bytes
+  // - n: the number of compressed bytes
+  // - out: where to store the bytes
+  // - out_len: the number of bytes that were compressed
+  //
+  // Returns:
+  // - true if exactly out_len bytes were decompressed
+  // - false if the input is damaged
+  static bool decompress(const uint8_t* in,
+                         size_t n,
+                         uint8_t* out,
+                         size_t out_len);
+};
+
+#endif  // LZCODEC_HPP_
@@ -0,0 +1,89 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "MappedFile.hpp"
+
+MappedFile::MappedFile(const std::string& fname)
+    : data_(nullptr), size_(0), good_(false) {
+  int fd = open(fname.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return;
+  }
+
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ == 0) {
+    // mmap of length 0 fails, but an empty file is fine
+    good_ = true;
+  } else {
+    void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      data_ = static_cast<const char*>(addr);
+      good_ = true;
+    } else {
+      size_ = 0;
+    }
+  }
+
+  // The mapping stays valid after the file is closed
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+    : data_(other.data_), size_(other.size_), good_(other.good_) {
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.good_ = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+  if (this == &other) {
+    return *this;
+  }
+
+  unmap();
+  data_ = other.data_;
+  size_ = other.size_;
+  good_ = other.good_;
+
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.good_ = false;
+  return *this;
+}
+
+std::string_view MappedFile::contents() const {
+  if (data_ == nullptr) {
+    return std::string_view();
+  }
+  return std::string_view(data_, size_);
+}
+
+size_t MappedFile::size() const {
+  return size_;
+}
+
+bool MappedFile::good() const {
+  return good_;
+}
+
+void MappedFile::unmap() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  good_ = false;
+}
@@ -0,0 +1,58 @@
+#ifndef MAPPEDFILE_HPP_
+#define MAPPEDFILE_HPP_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+///////////////////////////////////////////////////////////////////////////////
+// A MappedFile maps the contents of a file into memory with mmap.
+//
+// The whole file can then be accessed as one read only string_view,
+// without copying it. Pages are read in by the OS as they are touched.
+///////////////////////////////////////////////////////////////////////////////
+class MappedFile {
+ public:
+  // Constructor for a MappedFile. Opens the file and maps it.
+  // If the file can't be opened or mapped, good() is false.
+  //
+  // Arguments:
+  // - fname: The name of the file to be mapped
+  MappedFile(const std::string& fname);
+
+  // Destructor for a MappedFile. Unmaps the file.
+  ~MappedFile();
+
+  // Move Constructor for the MappedFile. `other` is left unmapped.
+  MappedFile(MappedFile&& other);
+
+  // Move assignment operator for the MappedFile. Any file mapped
+  // by *this is unmapped first. `other` is left unmapped.
+  MappedFile& operator=(MappedFile&& other);
+
+  // Returns the contents of the file. The view is valid for as
+  // long as the file stays mapped. Empty if the file is not mapped.
+  std::string_view contents() const;
+
+  // Returns the size of the file in bytes
+  size_t size() const;
+
+  // Returns whether the file is mapped. An empty file
+  // is considered mapped, with no contents.
+  bool good() const;
+
+  // Ignore These
+  // This is disabling the copy constructor and the assignment operator.
+  MappedFile(const MappedFile& other) = delete;
+  MappedFile& operator=(const MappedFile& other) = delete;
+
+ private:
+  // Helper method to unmap the file, if any
+  void unmap();
+
+  const char* data_;  // Start of the mapping, nullptr if none
+  size_t size_;       // Size of the file
+  bool good_;         // Whether the file was mapped
+};
+
+#endif  // MAPPEDFILE_HPP_
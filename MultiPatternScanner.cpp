@@ -0,0 +1,149 @@
+#include <algorithm>
+
+#include "MultiPatternScanner.hpp"
+
+// Marks a missing edge of the trie while building
+static constexpr uint32_t kNoState = UINT32_MAX;
+
+MultiPatternScanner::MultiPatternScanner(
+    const std::vector<std::string>& patterns)
+    : classes_(), num_classes_(1) {
+  // Give every byte used in a pattern its own class.
+  // Class 0 is shared by all the other bytes.
+  std::array<bool, 256> used{};
+  size_t num_used = 0;
+  for (const std::string& pattern : patterns) {
+    for (char c : pattern) {
+      uint8_t b = static_cast<uint8_t>(c);
+      if (!used[b]) {
+        used[b] = true;
+        num_used++;
+      }
+    }
+  }
+  if (num_used == 256) {
+    // No byte is left over for class 0
+    for (size_t b = 0; b < 256; b++) {
+      classes_[b] = static_cast<uint8_t>(b);
+    }
+    num_classes_ = 256;
+  } else {
+    for (size_t b = 0; b < 256; b++) {
+      if (used[b]) {
+        classes_[b] = static_cast<uint8_t>(num_classes_++);
+      }
+    }
+  }
+
+  // Build the trie of the patterns. Rows of `trie` are
+  // indexed by state number, not row offset.
+  size_t nc = num_classes_;
+  std::vector<uint32_t> trie(nc, kNoState);
+  std::vector<std::vector<uint32_t>> matches(1);
+  for (uint32_t p = 0; p < patterns.size(); p++) {
+    lengths_.push_back(static_cast<uint32_t>(patterns[p].length()));
+    if (patterns[p].empty()) {
+      continue;
+    }
+    uint32_t s = 0;
+    for (char c : patterns[p]) {
+      uint32_t& next = trie[s * nc + classes_[static_cast<uint8_t>(c)]];
+      if (next == kNoState) {
+        next = static_cast<uint32_t>(matches.size());
+        matches.emplace_back();
+        // careful, `next` is invalidated by the resize
+        trie.resize(trie.size() + nc, kNoState);
+      }
+      s = trie[s * nc + classes_[static_cast<uint8_t>(c)]];
+    }
+    matches[s].push_back(p);
+  }
+  size_t num_states = matches.size();
+
+  // Breadth first search to fill in the failure transitions. Missing
+  // edges of a state become edges of the state's failure state, which is
+  // closer to the root and so already complete. A state also matches
+  // whatever its failure state matches.
+  std::vector<uint32_t> fail(num_states, 0);
+  std::vector<uint32_t> order;
+  order.reserve(num_states);
+  order.push_back(0);
+  for (size_t c = 0; c < nc; c++) {
+    uint32_t t = trie[c];
+    if (t == kNoState) {
+      trie[c] = 0;
+    } else {
+      fail[t] = 0;
+      order.push_back(t);
+    }
+  }
+  for (size_t i = 1; i < order.size(); i++) {
+    uint32_t s = order[i];
+    const std::vector<uint32_t>& inherited = matches[fail[s]];
+    matches[s].insert(matches[s].end(), inherited.begin(), inherited.end());
+    for (size_t c = 0; c < nc; c++) {
+      uint32_t t = trie[s * nc + c];
+      uint32_t f = trie[fail[s] * nc + c];
+      if (t == kNoState) {
+        trie[s * nc + c] = f;
+      } else {
+        fail[t] = f;
+        order.push_back(t);
+      }
+    }
+  }
+
+  // Renumber the states in breadth first order and
+  // lay out the final tables.
+  std::vector<uint32_t> number(num_states);
+  for (uint32_t i = 0; i < num_states; i++) {
+    number[order[i]] = i;
+  }
+  delta_.resize(num_states * nc);
+  output_starts_.assign(num_states + 1, 0);
+  for (uint32_t i = 0; i < num_states; i++) {
+    uint32_t s = order[i];
+    std::sort(matches[s].begin(), matches[s].end());
+    output_starts_[i] = static_cast<uint32_t>(outputs_.size());
+    outputs_.insert(outputs_.end(), matches[s].begin(), matches[s].end());
+  }
+  output_starts_[num_states] = static_cast<uint32_t>(outputs_.size());
+  for (uint32_t i = 0; i < num_states; i++) {
+    uint32_t s = order[i];
+    for (size_t c = 0; c < nc; c++) {
+      uint32_t t = number[trie[s * nc + c]];
+      uint32_t entry = static_cast<uint32_t>(t * nc);
+      if (!matches[trie[s * nc + c]].empty()) {
+        entry |= kMatchBit;
+      }
+      delta_[i * nc + c] = entry;
+    }
+  }
+}
+
+std::vector<PatternMatch> MultiPatternScanner::find_all(
+    std::string_view text) const {
+  std::vector<PatternMatch> result;
+  uint32_t state = kStartState;
+  scan(text, 0, &state, [&result](uint32_t pattern, off_t offset) {
+    result.push_back(PatternMatch{pattern, offset});
+  });
+  return result;
+}
+
+std::vector<PatternMatch> MultiPatternScanner::find_all(
+    BufferedFileReader& reader) const {
+  std::vector<PatternMatch> result;
+  scan(reader, [&result](uint32_t pattern, off_t offset) {
+    result.push_back(PatternMatch{pattern, offset});
+  });
+  return result;
+}
+
+size_t MultiPatternScanner::num_patterns() const {
+  return lengths_.size();
+}
+
+size_t MultiPatternScanner::num_states() const {
+  return output_starts_.size() - 1;
+}
@@ -0,0 +1,141 @@
+#ifndef MULTIPATTERNSCANNER_HPP_
+#define MULTIPATTERNSCANNER_HPP_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "BufferedFileReader.hpp"
+
+// A match of one of the patterns of a MultiPatternScanner
+struct PatternMatch {
+  uint32_t pattern;  // Index of the pattern that matched
+  off_t offset;      // Offset of the first char of the match
+
+  bool operator==(const PatternMatch& other) const = default;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// A MultiPatternScanner finds every occurrence of any of a set of literal
+// patterns in one pass over the text, using the Aho-Corasick algorithm.
+//
+// The patterns are compiled into a DFA, so scanning costs one table
+// lookup per byte no matter how many patterns there are. To keep the
+// table small, bytes are first mapped to classes (all bytes that appear
+// in no pattern share one class), and the states are numbered in
+// breadth first order so the states near the root, which are visited
+// the most, sit together in memory.
+//
+// The state of a scan is a single integer, so a scan can be carried on
+// across buffer refills: matches that span two chunks are found.
+///////////////////////////////////////////////////////////////////////////////
+class MultiPatternScanner {
+ public:
+  // The state of a scan at the start of the text
+  static constexpr uint32_t kStartState = 0;
+
+  // Constructor for a MultiPatternScanner. Compiles the patterns.
+  // Empty patterns are allowed but never match.
+  //
+  // Arguments:
+  // - patterns: the patterns to look for. A match reports the index
+  //   of the pattern in this vector.
+  MultiPatternScanner(const std::vector<std::string>& patterns);
+
+  // Scans a chunk of text, carrying on from a previous chunk.
+  //
+  // Arguments:
+  // - chunk: the text to scan
+  // - chunk_offset: the offset of the chunk's first char in the text
+  // - state: the state of the scan. Should be kStartState for the
+  //   first chunk of a text, and is updated for the next chunk.
+  // - sink: called as sink(uint32_t pattern, off_t offset) for each
+  //   match, in order of where the matches end.
+  template <typename F>
+  void scan(std::string_view chunk,
+            off_t chunk_offset,
+            uint32_t* state,
+            F&& sink) const;
+
+  // Scans the rest of a file, reading it chunk by chunk.
+  //
+  // Arguments:
+  // - reader: the file to scan. Offsets are relative to
+  //   the start of the file.
+  // - sink: as above
+  template <typename F>
+  void scan(BufferedFileReader& reader, F&& sink) const;
+
+  // Returns every match in a text, such as the contents of a MappedFile
+  std::vector<PatternMatch> find_all(std::string_view text) const;
+
+  // Returns every match in the rest of a file
+  std::vector<PatternMatch> find_all(BufferedFileReader& reader) const;
+
+  // Returns the number of patterns
+  size_t num_patterns() const;
+
+  // Returns the number of states in the automaton
+  size_t num_states() const;
+
+ private:
+  // Transitions that lead to a state with matches have this bit set
+  static constexpr uint32_t kMatchBit = 1U << 31;
+
+  std::array<uint8_t, 256> classes_;  // The class of each byte
+  uint32_t num_classes_;
+
+  // The transitions. The row for state s is
+  // delta_[s * num_classes_ .. (s + 1) * num_classes_), and entries hold
+  // the start of the next state's row, possibly with kMatchBit set.
+  std::vector<uint32_t> delta_;
+
+  // The patterns matched on entering state s are
+  // outputs_[output_starts_[s] .. output_starts_[s + 1])
+  std::vector<uint32_t> output_starts_;
+  std::vector<uint32_t> outputs_;
+
+  std::vector<uint32_t> lengths_;  // The length of each pattern
+};
+
+template <typename F>
+void MultiPatternScanner::scan(std::string_view chunk,
+                               off_t chunk_offset,
+                               uint32_t* state,
+                               F&& sink) const {
+  const uint32_t* delta = delta_.data();
+  const uint8_t* classes = classes_.data();
+  uint32_t row = *state * num_classes_;
+
+  for (size_t i = 0; i < chunk.length(); i++) {
+    uint32_t next = delta[row + classes[static_cast<uint8_t>(chunk[i])]];
+    row = next & ~kMatchBit;
+    if ((next & kMatchBit) != 0) {
+      uint32_t s = row / num_classes_;
+      off_t end = chunk_offset + static_cast<off_t>(i) + 1;
+      for (uint32_t j = output_starts_[s]; j < output_starts_[s + 1]; j++) {
+        sink(outputs_[j], end - static_cast<off_t>(lengths_[outputs_[j]]));
+      }
+    }
+  }
+  *state = row / num_classes_;
+}
+
+template <typename F>
+void MultiPatternScanner::scan(BufferedFileReader& reader, F&& sink) const {
+  uint32_t state = kStartState;
+  while (true) {
+    off_t offset = reader.tell();
+    std::optional<std::string_view> chunk = reader.get_chunk();
+    if (!chunk.has_value()) {
+      return;
+    }
+    scan(chunk.value(), offset, &state, sink);
+  }
+}
+
+#endif  // MULTIPATTERNSCANNER_HPP_
@@ -0,0 +1,55 @@
+#include "NGramGenerator.hpp"
+
+NGramGenerator::NGramGenerator(size_t n)
+    : ring_(), n_(n), head_(0), pushed_(0) {}
+
+std::optional<uint64_t> NGramGenerator::push(uint32_t term_id) {
+  ring_[head_] = term_id;
+  head_ = (head_ + 1) % n_;
+  pushed_++;
+  if (pushed_ < n_) {
+    return std::nullopt;
+  }
+
+  // Once full, head_ is also where the oldest term is.
+  // Unroll the ring into order, it is at most kMaxN terms.
+  std::array<uint32_t, kMaxN> terms;
+  for (size_t i = 0; i < n_; i++) {
+    terms[i] = ring_[(head_ + i) % n_];
+  }
+  return ngram_id(terms.data(), n_);
+}
+
+void NGramGenerator::reset() {
+  head_ = 0;
+  pushed_ = 0;
+}
+
+uint32_t NGramGenerator::term(size_t i) const {
+  return ring_[(head_ + i) % n_];
+}
+
+size_t NGramGenerator::n() const {
+  return n_;
+}
+
+uint64_t NGramGenerator::ngram_id(const uint32_t* term_ids, size_t count) {
+  if (count == 1) {
+    return term_ids[0];
+  }
+  if (count == 2) {
+    return (static_cast<uint64_t>(term_ids[0]) << 32) | term_ids[1];
+  }
+
+  // Combine the ids in order, mixing after each so that
+  // the order of the terms matters.
+  uint64_t h = count;
+  for (size_t i = 0; i < count; i++) {
+    h ^= term_ids[i];
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 32;
+  }
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
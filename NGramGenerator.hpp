@@ -0,0 +1,109 @@
+#ifndef NGRAMGENERATOR_HPP_
+#define NGRAMGENERATOR_HPP_
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "BufferedFileReader.hpp"
+#include "TermDictionary.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// An NGramGenerator turns a stream of term ids into a stream of word
+// n-grams (bigrams, trigrams, ...).
+//
+// The last n term ids are kept in a fixed ring, and every term pushed
+// after the first n - 1 completes an n-gram. N-grams are identified by
+// a 64 bit id computed from the term ids, no strings are copied.
+// Bigram ids are exact (the two 32 bit term ids side by side), ids of
+// longer n-grams are hashes of their term ids.
+///////////////////////////////////////////////////////////////////////////////
+class NGramGenerator {
+ public:
+  // The largest n supported
+  static constexpr size_t kMaxN = 8;
+
+  // Constructor for an NGramGenerator.
+  // Undefined behaviour if n is 0 or greater than kMaxN.
+  //
+  // Arguments:
+  // - n: the number of words in each n-gram
+  NGramGenerator(size_t n);
+
+  // Adds the next term to the stream.
+  //
+  // Arguments:
+  // - term_id: the id of the next term
+  //
+  // Returns:
+  // - the id of the n-gram that ends with this term,
+  // - nullopt if fewer than n terms have been pushed since
+  //   construction or the last call to reset().
+  std::optional<uint64_t> push(uint32_t term_id);
+
+  // Forgets the recent terms, so that no n-gram spans the reset.
+  // Should be called between documents.
+  void reset();
+
+  // Returns the i'th term of the most recent n-gram, oldest first.
+  // Undefined behaviour if i >= n() or no n-gram has been completed.
+  uint32_t term(size_t i) const;
+
+  // Returns the number of words in each n-gram
+  size_t n() const;
+
+  // Returns the id an n-gram made of the specified terms would have.
+  //
+  // Arguments:
+  // - term_ids: the ids of the terms, count of them
+  // - count: number of terms in the n-gram
+  static uint64_t ngram_id(const uint32_t* term_ids, size_t count);
+
+  // Reads the rest of a file and generates the n-grams of its words.
+  // Empty tokens are skipped, they are not words.
+  //
+  // Arguments:
+  // - reader: the file to read
+  // - dict: the dictionary to intern the words into
+  // - delims: the delimiters used to read tokens
+  // - sink: called as sink(uint64_t ngram_id, uint64_t position) for
+  //   each n-gram, where position is the number of words before the
+  //   n-gram's first word.
+  //
+  // Returns:
+  // - the number of n-grams generated
+  template <typename F>
+  size_t for_each_ngram(BufferedFileReader& reader,
+                        TermDictionary& dict,
+                        const std::string& delims,
+                        F&& sink);
+
+ private:
+  std::array<uint32_t, kMaxN> ring_;  // The most recent terms
+  size_t n_;                          // Number of words in an n-gram
+  size_t head_;                       // Where the next term goes in ring_
+  uint64_t pushed_;                   // Terms pushed since the last reset
+};
+
+template <typename F>
+size_t NGramGenerator::for_each_ngram(BufferedFileReader& reader,
+                                      TermDictionary& dict,
+                                      const std::string& delims,
+                                      F&& sink) {
+  size_t count = 0;
+  reader.for_each_token(delims, [&](std::string_view token) {
+    if (token.empty()) {
+      return;
+    }
+    std::optional<uint64_t> id = push(dict.intern(token));
+    if (id.has_value()) {
+      sink(id.value(), pushed_ - n_);
+      count++;
+    }
+  });
+  return count;
+}
+
+#endif  // NGRAMGENERATOR_HPP_
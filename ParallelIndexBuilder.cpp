@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <array>
+
+#include "InvertedIndex.hpp"
+#include "ParallelIndexBuilder.hpp"
+#include "SegmentWriter.hpp"
+#include "TermDictionary.hpp"
+
+// A range of one document, [begin, end) in bytes
+struct DocRange {
+  uint32_t doc;
+  size_t begin;
+  size_t end;
+};
+
+// The postings collected by one thread. Once sorted, `order` lists the
+// term ids in term order and every list is sorted by doc id.
+struct PartialIndex {
+  TermDictionary dict;
+  std::vector<std::vector<Posting>> lists;  // Indexed by term id
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> doc_lengths;  // Tokens this thread saw per doc
+};
+
+// A run of merged terms, one per thread
+struct MergedPart {
+  std::vector<std::string> terms;
+  std::vector<PostingList> lists;
+};
+
+// Sorts postings by doc id and adds up those of the same doc,
+// which come from ranges of one file run on the same thread
+static void sort_postings(std::vector<Posting>* postings) {
+  std::sort(postings->begin(), postings->end(),
+            [](const Posting& a, const Posting& b) { return a.doc < b.doc; });
+  size_t out = 0;
+  for (size_t i = 0; i < postings->size(); i++) {
+    if (out > 0 && (*postings)[out - 1].doc == (*postings)[i].doc) {
+      (*postings)[out - 1].freq += (*postings)[i].freq;
+    } else {
+      (*postings)[out++] = (*postings)[i];
+    }
+  }
+  postings->resize(out);
+}
+
+ParallelIndexBuilder::ParallelIndexBuilder(size_t num_threads,
+                                           const std::string& delims,
+                                           bool fold_case,
+                                           size_t range_bytes)
+    : delims_(delims),
+      fold_case_(fold_case),
+      range_bytes_(std::max<size_t>(1, range_bytes)),
+      pool_(num_threads),
+      num_ranges_(0),
+      num_steals_(0) {}
+
+std::optional<uint32_t> ParallelIndexBuilder::add_file(
+    const std::string& fname) {
+  MappedFile file(fname);
+  if (!file.good()) {
+    return std::nullopt;
+  }
+  files_.push_back(std::move(file));
+  names_.push_back(fname);
+  return static_cast<uint32_t>(files_.size() - 1);
+}
+
+bool ParallelIndexBuilder::add_directory(const std::string& dir) {
+  std::optional<std::vector<std::string>> files = list_directory(dir);
+  if (!files.has_value()) {
+    return false;
+  }
+  for (const std::string& fname : files.value()) {
+    add_file(fname);
+  }
+  return true;
+}
+
+bool ParallelIndexBuilder::build(const std::string& fname) {
+  std::array<bool, 256> is_delim{};
+  for (char c : delims_) {
+    is_delim[static_cast<unsigned char>(c)] = true;
+  }
+
+  std::vector<DocRange> ranges;
+  for (uint32_t doc = 0; doc < files_.size(); doc++) {
+    size_t size = files_[doc].size();
+    for (size_t begin = 0; begin < size; begin += range_bytes_) {
+      ranges.push_back(
+          DocRange{doc, begin, std::min(size, begin + range_bytes_)});
+    }
+  }
+  num_ranges_ = ranges.size();
+
+  // Index the ranges
+  size_t num_workers = pool_.num_threads();
+  std::vector<PartialIndex> partials(num_workers);
+  for (PartialIndex& partial : partials) {
+    partial.doc_lengths.assign(files_.size(), 0);
+  }
+  pool_.run(ranges.size(), [&](size_t task, size_t worker) {
+    const DocRange& range = ranges[task];
+    PartialIndex& partial = partials[worker];
+    std::string_view text = files_[range.doc].contents();
+    auto delim = [&is_delim, text](size_t i) {
+      return is_delim[static_cast<unsigned char>(text[i])];
+    };
+
+    // Skip the end of a token that started in the range before
+    size_t p = range.begin;
+    if (p > 0 && !delim(p - 1)) {
+      while (p < text.length() && !delim(p)) {
+        p++;
+      }
+    }
+    std::string scratch;
+    while (true) {
+      while (p < range.end && delim(p)) {
+        p++;
+      }
+      if (p >= range.end) {
+        break;
+      }
+      size_t start = p;
+      while (p < text.length() && !delim(p)) {
+        p++;
+      }
+      std::string_view token = text.substr(start, p - start);
+      if (fold_case_) {
+        token = fold_token(token, &scratch);
+      }
+
+      uint32_t id = partial.dict.intern(token);
+      if (id == partial.lists.size()) {
+        partial.lists.emplace_back();
+      }
+      std::vector<Posting>& list = partial.lists[id];
+      if (!list.empty() && list.back().doc == range.doc) {
+        list.back().freq++;
+      } else {
+        list.push_back(Posting{range.doc, 1});
+      }
+      partial.doc_lengths[range.doc]++;
+    }
+  });
+
+  num_steals_ = pool_.num_steals();
+
+  // Sort each partial into a run
+  pool_.run(num_workers, [&partials](size_t task, size_t) {
+    PartialIndex& partial = partials[task];
+    partial.order.resize(partial.dict.size());
+    for (uint32_t id = 0; id < partial.order.size(); id++) {
+      partial.order[id] = id;
+    }
+    const TermDictionary& dict = partial.dict;
+    std::sort(partial.order.begin(), partial.order.end(),
+              [&dict](uint32_t a, uint32_t b) {
+                return dict.term(a) < dict.term(b);
+              });
+    for (std::vector<Posting>& list : partial.lists) {
+      sort_postings(&list);
+    }
+  });
+
+  // Split the terms into parts at evenly spaced terms of all the runs
+  std::vector<std::string> samples;
+  for (const PartialIndex& partial : partials) {
+    for (size_t k = 1; k < num_workers; k++) {
+      size_t i = partial.order.size() * k / num_workers;
+      if (i < partial.order.size()) {
+        samples.emplace_back(partial.dict.term(partial.order[i]));
+      }
+    }
+  }
+  std::sort(samples.begin(), samples.end());
+  std::vector<std::string> splits;
+  for (size_t k = 1; k < num_workers && !samples.empty(); k++) {
+    splits.push_back(samples[samples.size() * k / num_workers]);
+  }
+  size_t num_parts = splits.size() + 1;
+
+  // Merge each part of the runs on its own thread
+  std::vector<MergedPart> parts(num_parts);
+  pool_.run(num_parts, [&](size_t part, size_t) {
+    // Where the part starts and ends in each run
+    std::vector<size_t> pos(partials.size());
+    std::vector<size_t> end(partials.size());
+    for (size_t r = 0; r < partials.size(); r++) {
+      const PartialIndex& run = partials[r];
+      auto bound = [&run](const std::string& split) {
+        return static_cast<size_t>(
+            std::lower_bound(run.order.begin(), run.order.end(), split,
+                             [&run](uint32_t id, const std::string& s) {
+                               return run.dict.term(id) < s;
+                             }) -
+            run.order.begin());
+      };
+      pos[r] = part == 0 ? 0 : bound(splits[part - 1]);
+      end[r] = part == num_parts - 1 ? run.order.size() : bound(splits[part]);
+    }
+
+    auto term = [&](size_t r) {
+      return partials[r].dict.term(partials[r].order[pos[r]]);
+    };
+    auto greater = [&](size_t a, size_t b) { return term(a) > term(b); };
+    std::vector<size_t> heap;
+    for (size_t r = 0; r < partials.size(); r++) {
+      if (pos[r] < end[r]) {
+        heap.push_back(r);
+      }
+    }
+    std::make_heap(heap.begin(), heap.end(), greater);
+
+    MergedPart& out = parts[part];
+    std::vector<Posting> postings;
+    while (!heap.empty()) {
+      std::string current(term(heap.front()));
+      postings.clear();
+      while (!heap.empty() && term(heap.front()) == current) {
+        size_t r = heap.front();
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        heap.pop_back();
+        const std::vector<Posting>& list =
+            partials[r].lists[partials[r].order[pos[r]]];
+        postings.insert(postings.end(), list.begin(), list.end());
+        if (++pos[r] < end[r]) {
+          heap.push_back(r);
+          std::push_heap(heap.begin(), heap.end(), greater);
+        }
+      }
+
+      // A document cut into ranges on several threads
+      // has postings in several runs
+      sort_postings(&postings);
+      PostingList list;
+      for (const Posting& posting : postings) {
+        list.docs.push_back(posting.doc);
+        list.freqs.push_back(posting.freq);
+      }
+      out.terms.push_back(std::move(current));
+      out.lists.push_back(std::move(list));
+    }
+  });
+
+  SegmentWriter writer(fname);
+  for (uint32_t doc = 0; doc < files_.size(); doc++) {
+    uint32_t length = 0;
+    for (const PartialIndex& partial : partials) {
+      length += partial.doc_lengths[doc];
+    }
+    writer.add_doc(names_[doc], length);
+  }
+  for (const MergedPart& part : parts) {
+    for (size_t i = 0; i < part.terms.size(); i++) {
+      if (!writer.add_term(part.terms[i], part.lists[i])) {
+        return false;
+      }
+    }
+  }
+  return writer.finish();
+}
+
+size_t ParallelIndexBuilder::num_threads() const {
+  return pool_.num_threads();
+}
+
+size_t ParallelIndexBuilder::num_ranges() const {
+  return num_ranges_;
+}
+
+size_t ParallelIndexBuilder::num_steals() const {
+  return num_steals_;
+}
@@ -0,0 +1,101 @@
+#ifndef PARALLELINDEXBUILDER_HPP_
+#define PARALLELINDEXBUILDER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "TextUtil.hpp"
+#include "WorkStealingPool.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// A ParallelIndexBuilder builds an IndexSegment of a set of files on
+// several threads.
+//
+// Every file is one document, as in an InvertedIndex, but files are cut
+// into ranges of about range_bytes so one large file is shared between
+// threads instead of holding one up. A token belongs to the range it
+// starts in. The ranges run on a WorkStealingPool, and each thread
+// collects the postings of the ranges it ran into its own partial index.
+//
+// Each partial is then sorted by term into a run, and the runs are
+// merged: the terms are split into one part per thread at terms sampled
+// from the runs, and each thread merges its part of every run with a
+// k-way merge on a heap. The parts are then written in order with a
+// SegmentWriter. The result is the same segment SegmentWriter::write
+// would write for an InvertedIndex of the same files.
+///////////////////////////////////////////////////////////////////////////////
+class ParallelIndexBuilder {
+ public:
+  // The default size of the ranges files are cut into
+  static constexpr size_t kRangeBytes = 256 * 1024;
+
+  // Constructor for a ParallelIndexBuilder.
+  //
+  // Arguments:
+  // - num_threads: the number of threads to build with. 0 means use
+  //   one per core.
+  // - delims: the delimiters used to split files into tokens
+  // - fold_case: whether to convert ASCII letters to lower case
+  // - range_bytes: the size of the ranges files are cut into
+  ParallelIndexBuilder(
+      size_t num_threads = 0,
+      const std::string& delims = kDefaultDelims,
+      bool fold_case = true,
+      size_t range_bytes = kRangeBytes);
+
+  // Adds a file to be indexed as the next document.
+  //
+  // Arguments:
+  // - fname: The name of the file
+  //
+  // Returns:
+  // - the id the document will have
+  // - nullopt if the file could not be opened
+  std::optional<uint32_t> add_file(const std::string& fname);
+
+  // Adds every regular file in a directory, in order of file name.
+  // Sub directories are not searched.
+  //
+  // Arguments:
+  // - dir: the name of the directory
+  //
+  // Returns:
+  // - true if the directory was read
+  // - false otherwise
+  bool add_directory(const std::string& dir);
+
+  // Indexes the files added and writes the index as a segment
+  //
+  // Arguments:
+  // - fname: the name of the segment file
+  //
+  // Returns:
+  // - true if the segment was written, false otherwise
+  bool build(const std::string& fname);
+
+  // Returns the number of threads
+  size_t num_threads() const;
+
+  // Returns the number of ranges the files were cut into by build()
+  size_t num_ranges() const;
+
+  // Returns the number of times a thread stole ranges in build()
+  size_t num_steals() const;
+
+ private:
+  std::string delims_;
+  bool fold_case_;
+  size_t range_bytes_;
+  WorkStealingPool pool_;
+
+  std::vector<std::string> names_;
+  std::vector<MappedFile> files_;
+  size_t num_ranges_;
+  size_t num_steals_;
+};
+
+#endif  // PARALLELINDEXBUILDER_HPP_
@@ -0,0 +1,26 @@
+#include "PhraseQuery.hpp"
+
+size_t PhraseQuery::count(
+    const std::vector<std::span<const uint32_t>>& positions) {
+  if (positions.empty()) {
+    return 0;
+  }
+
+  // The starts tried only go up, so where each term's
+  // positions were left off is where to carry on from
+  std::vector<size_t> next(positions.size(), 0);
+  size_t count = 0;
+  for (uint32_t start : positions[0]) {
+    bool match = true;
+    for (size_t i = 1; i < positions.size() && match; i++) {
+      uint64_t target = static_cast<uint64_t>(start) + i;
+      std::span<const uint32_t> list = positions[i];
+      while (next[i] < list.size() && list[next[i]] < target) {
+        next[i]++;
+      }
+      match = next[i] < list.size() && list[next[i]] == target;
+    }
+    count += match;
+  }
+  return count;
+}
@@ -0,0 +1,33 @@
+#ifndef PHRASEQUERY_HPP_
+#define PHRASEQUERY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// PhraseQuery matches a phrase within one document, given where each
+// term of the phrase occurs in it.
+//
+// A position is the number of tokens before a term in its document, so
+// the phrase occurs at x when term i of the phrase is at x + i for every
+// i. Each term's positions are sorted, so one pass over each of them
+// finds every occurrence.
+///////////////////////////////////////////////////////////////////////////////
+class PhraseQuery {
+ public:
+  // Counts the occurrences of a phrase in a document.
+  //
+  // Arguments:
+  // - positions: the sorted positions of each term of the phrase in
+  //   the document, in phrase order. A term that is in the phrase
+  //   twice has its positions in here twice.
+  //
+  // Returns:
+  // - the number of positions the phrase starts at, 0 if there
+  //   are no terms
+  static size_t count(const std::vector<std::span<const uint32_t>>& positions);
+};
+
+#endif  // PHRASEQUERY_HPP_
@@ -0,0 +1,37 @@
+#include <thread>
+
+#include "RateLimiter.hpp"
+
+RateLimiter::RateLimiter(uint64_t bytes_per_sec)
+    : bytes_per_sec_(bytes_per_sec),
+      next_free_(Clock::now()),
+      waited_(Clock::duration::zero()) {}
+
+void RateLimiter::acquire(uint64_t bytes) {
+  if (bytes_per_sec_ == 0) {
+    return;
+  }
+  Clock::time_point now = Clock::now();
+  if (next_free_ < now) {
+    next_free_ = now;
+  }
+
+  // This transfer has to wait for the ones before it
+  Clock::time_point start = next_free_;
+  next_free_ += std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(static_cast<double>(bytes) /
+                                    static_cast<double>(bytes_per_sec_)));
+  if (start > now) {
+    std::this_thread::sleep_until(start);
+    waited_ += start - now;
+  }
+}
+
+uint64_t RateLimiter::bytes_per_sec() const {
+  return bytes_per_sec_;
+}
+
+uint64_t RateLimiter::waited_ms() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(waited_)
+      .count();
+}
@@ -0,0 +1,41 @@
+#ifndef RATELIMITER_HPP_
+#define RATELIMITER_HPP_
+
+#include <chrono>
+#include <cstdint>
+
+///////////////////////////////////////////////////////////////////////////////
+// A RateLimiter keeps a stream of I/O under a number of bytes per second,
+// by sleeping before each transfer until the transfers before it would
+// have taken their share of time at that rate.
+//
+// Time that goes unused is not saved up, so the stream never bursts
+// above the rate after being idle. Not thread safe: each stream of I/O
+// should have its own RateLimiter.
+///////////////////////////////////////////////////////////////////////////////
+class RateLimiter {
+ public:
+  // Constructor for a RateLimiter.
+  //
+  // Arguments:
+  // - bytes_per_sec: the rate to keep to. 0 means no limit.
+  RateLimiter(uint64_t bytes_per_sec);
+
+  // Waits until `bytes` more can be transferred
+  void acquire(uint64_t bytes);
+
+  // Returns the rate, 0 if there is no limit
+  uint64_t bytes_per_sec() const;
+
+  // Returns the total time spent waiting, in milliseconds
+  uint64_t waited_ms() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  uint64_t bytes_per_sec_;
+  Clock::time_point next_free_;  // When the transfers so far are paid for
+  Clock::duration waited_;
+};
+
+#endif  // RATELIMITER_HPP_
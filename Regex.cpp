@@ -0,0 +1,755 @@
+#include <algorithm>
+#include <utility>
+
+#include "Regex.hpp"
+
+// Marks a failed parse
+static constexpr uint32_t kInvalid = UINT32_MAX;
+
+// Limits that keep a hostile pattern from using unbounded memory
+static constexpr int kMaxRepeat = 1000;
+static constexpr int kMaxDepth = 1000;
+static constexpr size_t kMaxNfaStates = 100000;
+
+// A piece of NFA under construction: its start state and the
+// (state, which out) pairs still to be pointed at what follows
+struct Regex::Fragment {
+  uint32_t start;
+  std::vector<std::pair<uint32_t, int>> holes;
+};
+
+static bool is_digit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+static bool is_alpha(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static int hex_value(char c) {
+  if (is_digit(c)) {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+// Parses the escape starting after a \ at p[*pos] into set.
+// Returns false if it is not a valid escape.
+static bool parse_escape(std::string_view p, size_t* pos,
+                         std::bitset<256>* set) {
+  if (*pos >= p.length()) {
+    return false;
+  }
+  char c = p[(*pos)++];
+  std::bitset<256> res;
+  switch (c) {
+    case 'd':
+    case 'D':
+      for (int b = '0'; b <= '9'; b++) {
+        res.set(b);
+      }
+      break;
+    case 'w':
+    case 'W':
+      for (int b = 0; b < 256; b++) {
+        if (is_alpha(b) || is_digit(b) || b == '_') {
+          res.set(b);
+        }
+      }
+      break;
+    case 's':
+    case 'S':
+      for (char b : {' ', '\t', '\n', '\r', '\v', '\f'}) {
+        res.set(static_cast<uint8_t>(b));
+      }
+      break;
+    case 'n':
+      res.set('\n');
+      break;
+    case 'r':
+      res.set('\r');
+      break;
+    case 't':
+      res.set('\t');
+      break;
+    case 'f':
+      res.set('\f');
+      break;
+    case 'v':
+      res.set('\v');
+      break;
+    case 'x': {
+      if (*pos + 2 > p.length() || hex_value(p[*pos]) < 0 ||
+          hex_value(p[*pos + 1]) < 0) {
+        return false;
+      }
+      res.set(hex_value(p[*pos]) * 16 + hex_value(p[*pos + 1]));
+      *pos += 2;
+      break;
+    }
+    default:
+      // Any other letter or digit is reserved
+      if (is_alpha(c) || is_digit(c)) {
+        return false;
+      }
+      res.set(static_cast<uint8_t>(c));
+  }
+  if (c == 'D' || c == 'W' || c == 'S') {
+    res.flip();
+  }
+  *set = res;
+  return true;
+}
+
+// Parses a number for a {m,n} repetition. Returns -1 if there is none.
+static int parse_count(std::string_view p, size_t* pos) {
+  if (*pos >= p.length() || !is_digit(p[*pos])) {
+    return -1;
+  }
+  int n = 0;
+  while (*pos < p.length() && is_digit(p[*pos])) {
+    n = n * 10 + (p[(*pos)++] - '0');
+    if (n > kMaxRepeat) {
+      return kMaxRepeat + 1;
+    }
+  }
+  return n;
+}
+
+Regex::Regex(std::string_view pattern)
+    : good_(false), root_(kInvalid), num_extend_steps_(0) {
+  size_t pos = 0;
+  root_ = parse_alt(pattern, &pos, 0);
+  if (root_ == kInvalid || pos != pattern.length() || nullable(root_) ||
+      nfa_size(root_) > kMaxNfaStates) {
+    return;
+  }
+
+  // Split the bytes into classes: two bytes are in the same class
+  // if every set in the pattern has both or neither of them.
+  classes_.fill(0);
+  num_classes_ = 1;
+  for (const Node& node : nodes_) {
+    if (node.kind != Node::kSet) {
+      continue;
+    }
+    std::map<std::pair<uint8_t, bool>, uint8_t> split;
+    for (int b = 0; b < 256; b++) {
+      auto key = std::make_pair(classes_[b], static_cast<bool>(node.set[b]));
+      auto it = split.find(key);
+      if (it == split.end()) {
+        it = split.emplace(key, static_cast<uint8_t>(split.size())).first;
+      }
+      classes_[b] = it->second;
+    }
+    num_classes_ = static_cast<uint32_t>(split.size());
+  }
+
+  compile(&forward_, false, true);
+  compile(&anchored_, false, false);
+  compile(&reverse_, true, true);
+  good_ = true;
+}
+
+bool Regex::good() const {
+  return good_;
+}
+
+bool Regex::matches(std::string_view text) {
+  if (!good_) {
+    return false;
+  }
+  uint32_t s = kStartState;
+  bool matched = false;
+  for (char c : text) {
+    uint32_t next = next_state(&anchored_, s, static_cast<uint8_t>(c));
+    s = next & ~kMatchBit;
+    if (s == kDeadState) {
+      return false;
+    }
+    matched = (next & kMatchBit) != 0;
+  }
+  return matched;
+}
+
+std::vector<off_t> Regex::find_ends(std::string_view text) {
+  std::vector<off_t> res;
+  uint32_t state = kStartState;
+  scan(text, 0, &state, [&res](off_t end) { res.push_back(end); });
+  return res;
+}
+
+std::vector<off_t> Regex::find_ends(BufferedFileReader& reader) {
+  std::vector<off_t> res;
+  scan(reader, [&res](off_t end) { res.push_back(end); });
+  return res;
+}
+
+std::vector<RegexMatch> Regex::find_all(std::string_view text) {
+  std::vector<RegexMatch> res;
+  if (!good_) {
+    return res;
+  }
+
+  // Reading the text backwards, the reversed pattern
+  // matches wherever a match starts
+  std::vector<bool> starts(text.length(), false);
+  uint32_t s = kStartState;
+  for (size_t i = text.length(); i-- > 0;) {
+    uint32_t next = next_state(&reverse_, s, static_cast<uint8_t>(text[i]));
+    s = next & ~kMatchBit;
+    starts[i] = (next & kMatchBit) != 0;
+  }
+
+  std::unordered_set<uint64_t> failed;
+  off_t pos = 0;
+  for (size_t i = 0; i < text.length(); i++) {
+    off_t start = static_cast<off_t>(i);
+    if (starts[i] && start >= pos) {
+      off_t end = longest_match(text, start, &failed);
+      res.push_back(RegexMatch{start, end});
+      pos = end;
+    }
+  }
+  return res;
+}
+
+std::vector<std::string> Regex::required_literals() const {
+  std::vector<std::string> res;
+  if (!good_) {
+    return res;
+  }
+
+  // Runs of single bytes in a concatenation at the top level
+  std::vector<uint32_t> kids;
+  if (nodes_[root_].kind == Node::kConcat) {
+    kids = nodes_[root_].kids;
+  } else {
+    kids.push_back(root_);
+  }
+  std::string run;
+  for (uint32_t kid : kids) {
+    const Node& node = nodes_[kid];
+    if (node.kind == Node::kSet && node.set.count() == 1) {
+      for (int b = 0; b < 256; b++) {
+        if (node.set[b]) {
+          run += static_cast<char>(b);
+        }
+      }
+    } else if (!run.empty()) {
+      res.push_back(std::move(run));
+      run.clear();
+    }
+  }
+  if (!run.empty()) {
+    res.push_back(std::move(run));
+  }
+  return res;
+}
+
+size_t Regex::num_nfa_states() const {
+  return forward_.nfa.size();
+}
+
+size_t Regex::num_dfa_states() const {
+  return forward_.sets.size();
+}
+
+uint64_t Regex::num_extend_steps() const {
+  return num_extend_steps_;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Parsing
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t Regex::add_node(Node node) {
+  nodes_.push_back(std::move(node));
+  return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+uint32_t Regex::parse_alt(std::string_view p, size_t* pos, int depth) {
+  if (depth > kMaxDepth) {
+    return kInvalid;
+  }
+  uint32_t first = parse_concat(p, pos, depth);
+  if (first == kInvalid || *pos >= p.length() || p[*pos] != '|') {
+    return first;
+  }
+
+  Node alt{Node::kAlt, {}, {first}, 0, 0};
+  while (*pos < p.length() && p[*pos] == '|') {
+    (*pos)++;
+    uint32_t next = parse_concat(p, pos, depth);
+    if (next == kInvalid) {
+      return kInvalid;
+    }
+    alt.kids.push_back(next);
+  }
+  return add_node(std::move(alt));
+}
+
+uint32_t Regex::parse_concat(std::string_view p, size_t* pos, int depth) {
+  Node concat{Node::kConcat, {}, {}, 0, 0};
+  while (*pos < p.length() && p[*pos] != '|' && p[*pos] != ')') {
+    uint32_t next = parse_repeat(p, pos, depth);
+    if (next == kInvalid) {
+      return kInvalid;
+    }
+    // Flatten groups, so that runs of literals can be seen
+    if (nodes_[next].kind == Node::kConcat) {
+      std::vector<uint32_t> kids = nodes_[next].kids;
+      concat.kids.insert(concat.kids.end(), kids.begin(), kids.end());
+    } else {
+      concat.kids.push_back(next);
+    }
+  }
+
+  if (concat.kids.empty()) {
+    return add_node(Node{Node::kEmpty, {}, {}, 0, 0});
+  }
+  if (concat.kids.size() == 1) {
+    return concat.kids[0];
+  }
+  return add_node(std::move(concat));
+}
+
+uint32_t Regex::parse_repeat(std::string_view p, size_t* pos, int depth) {
+  uint32_t atom = parse_atom(p, pos, depth);
+  while (atom != kInvalid && *pos < p.length()) {
+    int min;
+    int max;
+    char c = p[*pos];
+    if (c == '*') {
+      min = 0;
+      max = -1;
+    } else if (c == '+') {
+      min = 1;
+      max = -1;
+    } else if (c == '?') {
+      min = 0;
+      max = 1;
+    } else if (c == '{') {
+      size_t end = *pos + 1;
+      min = parse_count(p, &end);
+      max = min;
+      if (end < p.length() && p[end] == ',') {
+        end++;
+        max = parse_count(p, &end);
+      }
+      if (min < 0 || min > kMaxRepeat || max > kMaxRepeat ||
+          (max >= 0 && max < min) || end >= p.length() || p[end] != '}') {
+        return kInvalid;
+      }
+      *pos = end;
+    } else {
+      break;
+    }
+    (*pos)++;
+    atom = add_node(Node{Node::kRepeat, {}, {atom}, min, max});
+  }
+  return atom;
+}
+
+uint32_t Regex::parse_atom(std::string_view p, size_t* pos, int depth) {
+  char c = p[(*pos)++];
+  Node node{Node::kSet, {}, {}, 0, 0};
+  switch (c) {
+    case '(': {
+      uint32_t inner = parse_alt(p, pos, depth + 1);
+      if (inner == kInvalid || *pos >= p.length() || p[*pos] != ')') {
+        return kInvalid;
+      }
+      (*pos)++;
+      return inner;
+    }
+    case '.':
+      node.set.set();
+      node.set.reset('\n');
+      break;
+    case '\\':
+      if (!parse_escape(p, pos, &node.set)) {
+        return kInvalid;
+      }
+      break;
+    case '[': {
+      bool negate = *pos < p.length() && p[*pos] == '^';
+      if (negate) {
+        (*pos)++;
+      }
+      bool first = true;
+      while (true) {
+        if (*pos >= p.length()) {
+          return kInvalid;
+        }
+        if (p[*pos] == ']' && !first) {
+          (*pos)++;
+          break;
+        }
+        first = false;
+
+        // One byte, a range of bytes, or an escape like \d
+        ByteSet lo;
+        if (p[*pos] == '\\') {
+          (*pos)++;
+          if (!parse_escape(p, pos, &lo)) {
+            return kInvalid;
+          }
+        } else {
+          lo.set(static_cast<uint8_t>(p[(*pos)++]));
+        }
+        if (lo.count() == 1 && *pos + 1 < p.length() && p[*pos] == '-' &&
+            p[*pos + 1] != ']') {
+          (*pos)++;
+          ByteSet hi;
+          if (p[*pos] == '\\') {
+            (*pos)++;
+            if (!parse_escape(p, pos, &hi) || hi.count() != 1) {
+              return kInvalid;
+            }
+          } else {
+            hi.set(static_cast<uint8_t>(p[(*pos)++]));
+          }
+          int lo_byte = 0;
+          int hi_byte = 0;
+          while (!lo[lo_byte]) {
+            lo_byte++;
+          }
+          while (!hi[hi_byte]) {
+            hi_byte++;
+          }
+          if (lo_byte > hi_byte) {
+            return kInvalid;
+          }
+          for (int b = lo_byte; b <= hi_byte; b++) {
+            node.set.set(b);
+          }
+        } else {
+          node.set |= lo;
+        }
+      }
+      if (negate) {
+        node.set.flip();
+      }
+      break;
+    }
+    case ')':
+    case '|':
+    case '*':
+    case '+':
+    case '?':
+    case '{':
+    case '^':
+    case '$':
+      // Nothing to repeat, or not supported
+      return kInvalid;
+    default:
+      node.set.set(static_cast<uint8_t>(c));
+  }
+  return add_node(std::move(node));
+}
+
+bool Regex::nullable(uint32_t id) const {
+  const Node& node = nodes_[id];
+  switch (node.kind) {
+    case Node::kSet:
+      return false;
+    case Node::kEmpty:
+      return true;
+    case Node::kConcat:
+      for (uint32_t kid : node.kids) {
+        if (!nullable(kid)) {
+          return false;
+        }
+      }
+      return true;
+    case Node::kAlt:
+      for (uint32_t kid : node.kids) {
+        if (nullable(kid)) {
+          return true;
+        }
+      }
+      return false;
+    case Node::kRepeat:
+      return node.min == 0 || nullable(node.kids[0]);
+  }
+  return false;
+}
+
+size_t Regex::nfa_size(uint32_t id) const {
+  const Node& node = nodes_[id];
+  size_t size = 1;
+  switch (node.kind) {
+    case Node::kSet:
+    case Node::kEmpty:
+      break;
+    case Node::kConcat:
+    case Node::kAlt:
+      for (uint32_t kid : node.kids) {
+        size = std::min(size + nfa_size(kid), kMaxNfaStates + 1);
+      }
+      break;
+    case Node::kRepeat: {
+      // Every repetition is a copy of the NFA for the sub node
+      size_t copies = node.max < 0 ? node.min + 1 : node.max;
+      size = std::min(copies * (nfa_size(node.kids[0]) + 1),
+                      kMaxNfaStates + 1);
+      break;
+    }
+  }
+  return size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Compiling to an NFA
+///////////////////////////////////////////////////////////////////////////////
+
+void Regex::compile(Automaton* a, bool reverse, bool unanchored) {
+  a->nfa.clear();
+  Fragment f = compile_node(a, root_, reverse);
+  a->nfa.push_back(NfaState{NfaState::kMatch, {}, 0, 0});
+  uint32_t match = static_cast<uint32_t>(a->nfa.size() - 1);
+  for (auto [s, which] : f.holes) {
+    (which == 0 ? a->nfa[s].out : a->nfa[s].out1) = match;
+  }
+  a->start = f.start;
+  a->unanchored = unanchored;
+  a->marks.assign(a->nfa.size(), 0);
+  a->mark = 0;
+  a->resets = 0;
+  reset_dfa(a);
+}
+
+Regex::Fragment Regex::compile_node(Automaton* a, uint32_t id,
+                                    bool reverse) const {
+  auto add_state = [a](NfaState::Kind kind, const ByteSet& set) {
+    a->nfa.push_back(NfaState{kind, set, 0, 0});
+    return static_cast<uint32_t>(a->nfa.size() - 1);
+  };
+  auto patch = [a](const Fragment& f, uint32_t target) {
+    for (auto [s, which] : f.holes) {
+      (which == 0 ? a->nfa[s].out : a->nfa[s].out1) = target;
+    }
+  };
+  // Joins fragments one after the other
+  auto concat = [&patch](std::vector<Fragment>& parts) {
+    for (size_t i = 1; i < parts.size(); i++) {
+      patch(parts[i - 1], parts[i].start);
+    }
+    Fragment f{parts.front().start, std::move(parts.back().holes)};
+    return f;
+  };
+
+  const Node& node = nodes_[id];
+  switch (node.kind) {
+    case Node::kSet: {
+      uint32_t s = add_state(NfaState::kSet, node.set);
+      return Fragment{s, {{s, 0}}};
+    }
+    case Node::kEmpty: {
+      uint32_t s = add_state(NfaState::kSplit, {});
+      return Fragment{s, {{s, 0}, {s, 1}}};
+    }
+    case Node::kConcat: {
+      std::vector<Fragment> parts;
+      for (uint32_t kid : node.kids) {
+        parts.push_back(compile_node(a, kid, reverse));
+      }
+      if (reverse) {
+        std::reverse(parts.begin(), parts.end());
+      }
+      return concat(parts);
+    }
+    case Node::kAlt: {
+      Fragment f = compile_node(a, node.kids.back(), reverse);
+      for (size_t i = node.kids.size() - 1; i-- > 0;) {
+        Fragment g = compile_node(a, node.kids[i], reverse);
+        uint32_t s = add_state(NfaState::kSplit, {});
+        a->nfa[s].out = g.start;
+        a->nfa[s].out1 = f.start;
+        g.holes.insert(g.holes.end(), f.holes.begin(), f.holes.end());
+        f = Fragment{s, std::move(g.holes)};
+      }
+      return f;
+    }
+    case Node::kRepeat: {
+      // min copies, then either a loop or max - min optional copies
+      std::vector<Fragment> parts;
+      for (int i = 0; i < node.min; i++) {
+        parts.push_back(compile_node(a, node.kids[0], reverse));
+      }
+      int optional = node.max < 0 ? 1 : node.max - node.min;
+      for (int i = 0; i < optional; i++) {
+        Fragment f = compile_node(a, node.kids[0], reverse);
+        uint32_t s = add_state(NfaState::kSplit, {});
+        a->nfa[s].out = f.start;
+        if (node.max < 0) {
+          patch(f, s);
+          parts.push_back(Fragment{s, {{s, 1}}});
+        } else {
+          f.holes.emplace_back(s, 1);
+          parts.push_back(Fragment{s, std::move(f.holes)});
+        }
+      }
+      if (parts.empty()) {
+        uint32_t s = add_state(NfaState::kSplit, {});
+        return Fragment{s, {{s, 0}, {s, 1}}};
+      }
+      return concat(parts);
+    }
+  }
+  return Fragment{0, {}};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The lazy DFA
+///////////////////////////////////////////////////////////////////////////////
+
+void Regex::reset_dfa(Automaton* a) {
+  a->resets++;
+  a->delta.clear();
+  a->sets.clear();
+  a->ids.clear();
+
+  // State 0 is dead and state 1 the start, every time
+  find_or_add_state(a, {});
+  std::vector<uint32_t> start;
+  a->mark++;
+  add_closure(a, a->start, &start);
+  std::sort(start.begin(), start.end());
+  find_or_add_state(a, start);
+}
+
+uint32_t Regex::find_or_add_state(Automaton* a,
+                                  const std::vector<uint32_t>& set) {
+  auto it = a->ids.find(set);
+  if (it != a->ids.end()) {
+    return it->second;
+  }
+  uint32_t id = static_cast<uint32_t>(a->sets.size());
+  a->sets.push_back(set);
+  a->ids.emplace(set, id);
+  a->delta.resize(a->delta.size() + num_classes_, kUnknown);
+  return id;
+}
+
+void Regex::add_closure(Automaton* a, uint32_t s, std::vector<uint32_t>* set) {
+  // Follow the splits. Only the states that consume a byte
+  // or match tell DFA states apart, so only they are kept.
+  std::vector<uint32_t> stack = {s};
+  while (!stack.empty()) {
+    uint32_t t = stack.back();
+    stack.pop_back();
+    if (a->marks[t] == a->mark) {
+      continue;
+    }
+    a->marks[t] = a->mark;
+    const NfaState& state = a->nfa[t];
+    if (state.kind == NfaState::kSplit) {
+      stack.push_back(state.out1);
+      stack.push_back(state.out);
+    } else {
+      set->push_back(t);
+    }
+  }
+}
+
+uint32_t Regex::step(Automaton* a, uint32_t state, uint8_t byte) {
+  // Start a new closure, handling the mark wrapping around
+  if (++a->mark == 0) {
+    std::fill(a->marks.begin(), a->marks.end(), 0);
+    a->mark = 1;
+  }
+
+  std::vector<uint32_t> next;
+  bool match = false;
+  for (uint32_t s : a->sets[state]) {
+    const NfaState& nfa_state = a->nfa[s];
+    if (nfa_state.kind == NfaState::kSet && nfa_state.set[byte]) {
+      add_closure(a, nfa_state.out, &next);
+    }
+  }
+  for (uint32_t s : next) {
+    match = match || a->nfa[s].kind == NfaState::kMatch;
+  }
+  if (a->unanchored) {
+    add_closure(a, a->start, &next);
+  }
+  std::sort(next.begin(), next.end());
+
+  bool cache = true;
+  if (a->ids.find(next) == a->ids.end() && a->sets.size() >= kMaxDfaStates) {
+    // Out of room: start the cache over. The transition
+    // out of `state` can't be cached, as state is gone.
+    reset_dfa(a);
+    cache = false;
+  }
+  uint32_t entry = find_or_add_state(a, next) | (match ? kMatchBit : 0);
+  if (cache) {
+    a->delta[state * num_classes_ + classes_[byte]] = entry;
+  }
+  return entry;
+}
+
+uint32_t Regex::next_state(Automaton* a, uint32_t state, uint8_t byte) {
+  uint32_t next = a->delta[state * num_classes_ + classes_[byte]];
+  if (next == kUnknown) {
+    next = step(a, state, byte);
+  }
+  return next;
+}
+
+off_t Regex::longest_match(std::string_view text, off_t start,
+                           std::unordered_set<uint64_t>* failed) {
+  // Once a scan is past the end of its match, every state it goes
+  // through is one from which no match ends. Those are remembered,
+  // and a later scan that reaches one stops there, since it would
+  // find nothing more. This is Reps' memoization for maximal munch:
+  // each pair fails at most once, so find_all() stays linear even
+  // for patterns like a|a.*c whose scans run far past their matches.
+  std::vector<uint64_t> visited;
+  uint64_t resets = anchored_.resets;
+  off_t end = -1;
+  uint32_t s = kStartState;
+  for (size_t i = start; i < text.length(); i++) {
+    uint64_t key = fail_key(s, i);
+    if (failed->count(key) != 0) {
+      break;
+    }
+    visited.push_back(key);
+    num_extend_steps_++;
+    uint32_t next = next_state(&anchored_, s, static_cast<uint8_t>(text[i]));
+    if (anchored_.resets != resets) {
+      // The states were numbered afresh, so what was learnt is lost
+      failed->clear();
+      visited.clear();
+      resets = anchored_.resets;
+    }
+    s = next & ~kMatchBit;
+    if (s == kDeadState) {
+      break;
+    }
+    if ((next & kMatchBit) != 0) {
+      end = static_cast<off_t>(i) + 1;
+    }
+  }
+
+  uint64_t first_failed = fail_key(0, std::max(start, end));
+  for (uint64_t key : visited) {
+    if (key >= first_failed) {
+      failed->insert(key);
+    }
+  }
+  return end;
+}
+
+uint64_t Regex::fail_key(uint32_t state, size_t pos) {
+  // Cached states are numbered below kMaxDfaStates
+  return static_cast<uint64_t>(pos) * kMaxDfaStates + state;
+}
@@ -0,0 +1,266 @@
+#ifndef REGEX_HPP_
+#define REGEX_HPP_
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "BufferedFileReader.hpp"
+
+// A match of a Regex in a text
+struct RegexMatch {
+  off_t start;  // Offset of the first char of the match
+  off_t end;    // Offset one past the last char of the match
+
+  bool operator==(const RegexMatch& other) const = default;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// A Regex searches a text for matches of a regular expression in time
+// linear in the length of the text, with no backtracking.
+//
+// The pattern is parsed and compiled into a Thompson NFA. Searches run a
+// DFA whose states are sets of NFA states. The DFA is built lazily: a
+// transition is computed from the NFA the first time it is taken and then
+// cached in a table, so a scan costs one table lookup per byte once the
+// states it visits are built. Bytes are mapped to classes of bytes the
+// pattern can't tell apart, to keep the table small. If the cache grows
+// past kMaxDfaStates it is thrown away and rebuilt as the scan goes on.
+//
+// The syntax is a byte oriented subset of POSIX ERE:
+// - literal bytes, and `.` for any byte but newline
+// - classes like [a-z_] and [^0-9], and the escapes \d \w \s \D \W \S
+// - the escapes \n \r \t \f \v \xHH, and \ before punctuation
+// - grouping with ( ), alternation with |
+// - the repetitions * + ? {m} {m,} {m,n}
+// Anchors (^ and $) are not supported, and neither are patterns that
+// match the empty string: such patterns are rejected.
+//
+// The DFA cache is updated by searches, so a Regex must not be used by
+// several threads at once. Give each thread its own.
+///////////////////////////////////////////////////////////////////////////////
+class Regex {
+ public:
+  // The state of a scan at the start of the text
+  static constexpr uint32_t kStartState = 1;
+
+  // The most DFA states cached at a time
+  static constexpr size_t kMaxDfaStates = 4096;
+
+  // Constructor for a Regex. Parses and compiles the pattern.
+  // If the pattern is invalid, good() is false.
+  //
+  // Arguments:
+  // - pattern: the regular expression
+  Regex(std::string_view pattern);
+
+  // Returns whether the pattern was compiled
+  bool good() const;
+
+  // Checks whether a whole text matches the pattern.
+  //
+  // Arguments:
+  // - text: the text to check
+  //
+  // Returns:
+  // - true if all of the text matches
+  // - false otherwise, or if the pattern is not good
+  bool matches(std::string_view text);
+
+  // Scans a chunk of text for where matches end, carrying on from
+  // a previous chunk. Each time a match ends, the end is reported
+  // and the scan starts over, so the next match reported starts
+  // after it. The earliest possible end is the one reported.
+  //
+  // Arguments:
+  // - chunk: the text to scan
+  // - chunk_offset: the offset of the chunk's first char in the text
+  // - state: the state of the scan. Should be kStartState for the
+  //   first chunk of a text, and is updated for the next chunk.
+  // - sink: called as sink(off_t end) for each match, where end is
+  //   the offset one past its last char
+  template <typename F>
+  void scan(std::string_view chunk, off_t chunk_offset, uint32_t* state,
+            F&& sink);
+
+  // Scans the rest of a file as above, reading it chunk by chunk.
+  //
+  // Arguments:
+  // - reader: the file to scan. Offsets are relative to
+  //   the start of the file.
+  // - sink: as above
+  template <typename F>
+  void scan(BufferedFileReader& reader, F&& sink);
+
+  // Returns the ends of the matches in a text, such as the contents
+  // of a MappedFile, or in the rest of a file, as found by scan()
+  std::vector<off_t> find_ends(std::string_view text);
+  std::vector<off_t> find_ends(BufferedFileReader& reader);
+
+  // Finds the matches in a text: the leftmost longest match, then the
+  // leftmost longest match after it, and so on. The starts are found
+  // in one backwards pass over the text with a DFA for the reversed
+  // pattern, then each match is extended as far as it goes. The
+  // extending remembers where it found nothing, so no DFA state is
+  // tried twice at the same position and the time stays linear.
+  //
+  // Arguments:
+  // - text: the text to search
+  //
+  // Returns:
+  // - the matches, in order. Empty if the pattern is not good.
+  std::vector<RegexMatch> find_all(std::string_view text);
+
+  // Returns strings that every match contains, for narrowing
+  // a search down with an index such as a TrigramIndex.
+  // May be empty even if such strings exist.
+  std::vector<std::string> required_literals() const;
+
+  // Returns the number of states in the NFA
+  size_t num_nfa_states() const;
+
+  // Returns the number of DFA states currently cached by scans
+  size_t num_dfa_states() const;
+
+  // Returns the number of bytes find_all() has read while
+  // extending matches, over all its calls
+  uint64_t num_extend_steps() const;
+
+ private:
+  // Transitions into a state that contains a match have this bit set
+  static constexpr uint32_t kMatchBit = 1U << 31;
+
+  // A transition that has not been computed yet
+  static constexpr uint32_t kUnknown = UINT32_MAX;
+
+  // The state with no NFA states, which can never match
+  static constexpr uint32_t kDeadState = 0;
+
+  using ByteSet = std::bitset<256>;
+
+  // A node of the parsed pattern
+  struct Node {
+    enum Kind { kSet, kEmpty, kConcat, kAlt, kRepeat };
+    Kind kind;
+    ByteSet set;                // kSet: the bytes it matches
+    std::vector<uint32_t> kids;  // Sub nodes
+    int min;                    // kRepeat: the repetitions allowed,
+    int max;                    // max is -1 for no limit
+  };
+
+  // A state of the NFA
+  struct NfaState {
+    enum Kind { kSet, kSplit, kMatch };
+    Kind kind;
+    ByteSet set;     // kSet: on these bytes go to out
+    uint32_t out;    // kSet, kSplit: the next state
+    uint32_t out1;   // kSplit: the other next state
+  };
+
+  // An NFA and the lazily built DFA for it
+  struct Automaton {
+    std::vector<NfaState> nfa;
+    uint32_t start;   // The start state of the NFA
+    bool unanchored;  // Whether a match may start at any position
+
+    // The transitions. The row for DFA state s is
+    // delta[s * num_classes_ .. (s + 1) * num_classes_), and entries
+    // hold the next state, possibly with kMatchBit set, or kUnknown.
+    std::vector<uint32_t> delta;
+    std::vector<std::vector<uint32_t>> sets;  // NFA states of each state
+    std::map<std::vector<uint32_t>, uint32_t> ids;  // Reverse of sets
+    std::vector<uint32_t> marks;  // Scratch for computing closures
+    uint32_t mark;
+    uint64_t resets;  // Times the cache has been thrown away
+  };
+
+  // Parsing, see Regex.cpp. Each returns the id of a node,
+  // or UINT32_MAX if the pattern is invalid.
+  uint32_t parse_alt(std::string_view p, size_t* pos, int depth);
+  uint32_t parse_concat(std::string_view p, size_t* pos, int depth);
+  uint32_t parse_repeat(std::string_view p, size_t* pos, int depth);
+  uint32_t parse_atom(std::string_view p, size_t* pos, int depth);
+  uint32_t add_node(Node node);
+  bool nullable(uint32_t node) const;
+  size_t nfa_size(uint32_t node) const;  // An upper bound
+
+  // Compiling the parsed pattern into the NFA of `a`. The NFA of the
+  // reversed pattern matches the reverse of every match.
+  struct Fragment;
+  void compile(Automaton* a, bool reverse, bool unanchored);
+  Fragment compile_node(Automaton* a, uint32_t node, bool reverse) const;
+
+  // The DFA. step() computes and caches the transition from `state`
+  // on `byte`, next_state() looks it up first.
+  void reset_dfa(Automaton* a);
+  uint32_t find_or_add_state(Automaton* a, const std::vector<uint32_t>& set);
+  void add_closure(Automaton* a, uint32_t s, std::vector<uint32_t>* set);
+  uint32_t step(Automaton* a, uint32_t state, uint8_t byte);
+  uint32_t next_state(Automaton* a, uint32_t state, uint8_t byte);
+
+  // Helper method for find_all(): the end of the longest match
+  // starting at start, or -1 if none. `failed` holds the pairs of
+  // a DFA state and a position from which no match can end, as
+  // returned by fail_key(), and is added to.
+  off_t longest_match(std::string_view text, off_t start,
+                      std::unordered_set<uint64_t>* failed);
+  static uint64_t fail_key(uint32_t state, size_t pos);
+
+  bool good_;
+  std::vector<Node> nodes_;
+  uint32_t root_;
+
+  std::array<uint8_t, 256> classes_;  // The class of each byte
+  uint32_t num_classes_;
+  uint64_t num_extend_steps_;
+
+  Automaton forward_;   // Finds where matches end, for scan()
+  Automaton anchored_;  // Matches starting at a given position
+  Automaton reverse_;   // Finds where matches start, read backwards
+};
+
+template <typename F>
+void Regex::scan(std::string_view chunk, off_t chunk_offset, uint32_t* state,
+                 F&& sink) {
+  if (!good_) {
+    return;
+  }
+  const uint8_t* classes = classes_.data();
+  uint32_t s = *state;
+
+  for (size_t i = 0; i < chunk.length(); i++) {
+    uint8_t byte = static_cast<uint8_t>(chunk[i]);
+    uint32_t next = forward_.delta[s * num_classes_ + classes[byte]];
+    if (next == kUnknown) {
+      next = step(&forward_, s, byte);
+    }
+    s = next & ~kMatchBit;
+    if ((next & kMatchBit) != 0) {
+      sink(chunk_offset + static_cast<off_t>(i) + 1);
+      s = kStartState;
+    }
+  }
+  *state = s;
+}
+
+template <typename F>
+void Regex::scan(BufferedFileReader& reader, F&& sink) {
+  uint32_t state = kStartState;
+  while (true) {
+    off_t offset = reader.tell();
+    std::optional<std::string_view> chunk = reader.get_chunk();
+    if (!chunk.has_value()) {
+      return;
+    }
+    scan(chunk.value(), offset, &state, sink);
+  }
+}
+
+#endif  // REGEX_HPP_
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <limits>
+
+#include "SegmentMerger.hpp"
+#include "SegmentWriter.hpp"
+
+bool SegmentMerger::merge(const std::vector<const IndexSegment*>& inputs,
+                          const std::string& fname,
+                          RateLimiter* limiter) {
+  // Positions are only kept if every input has them
+  bool store_positions = true;
+  for (const IndexSegment* input : inputs) {
+    if (!input->good()) {
+      return false;
+    }
+    store_positions = store_positions && input->has_positions();
+  }
+  SegmentWriter writer(fname, limiter, store_positions);
+
+  // The documents, renumbered after the documents of the inputs before
+  std::vector<uint32_t> bases;
+  uint64_t num_docs = 0;
+  for (const IndexSegment* input : inputs) {
+    bases.push_back(static_cast<uint32_t>(num_docs));
+    num_docs += input->num_docs();
+    if (num_docs > std::numeric_limits<uint32_t>::max()) {
+      return false;
+    }
+    for (uint32_t doc = 0; doc < input->num_docs(); doc++) {
+      writer.add_doc(input->doc_name(doc), input->doc_length(doc));
+    }
+  }
+
+  // A min heap of the inputs by their current term. Ties go to the
+  // earlier input, so equal terms come off the heap in doc id order.
+  std::vector<IndexSegment::TermIterator> its;
+  std::vector<size_t> heap;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    its.push_back(inputs[i]->terms());
+    if (its[i].valid()) {
+      heap.push_back(i);
+    }
+  }
+  auto greater = [&its](size_t a, size_t b) {
+    int cmp = its[a].term().compare(its[b].term());
+    return cmp > 0 || (cmp == 0 && a > b);
+  };
+  std::make_heap(heap.begin(), heap.end(), greater);
+
+  std::string term;
+  PostingList merged;
+  std::vector<uint32_t> positions;
+  std::vector<size_t> done;
+  while (!heap.empty()) {
+    term.assign(its[heap.front()].term());
+    merged.docs.clear();
+    merged.freqs.clear();
+    positions.clear();
+    done.clear();
+    while (!heap.empty() && its[heap.front()].term() == term) {
+      size_t i = heap.front();
+      std::pop_heap(heap.begin(), heap.end(), greater);
+      heap.pop_back();
+
+      SegmentPostings postings = its[i].postings();
+      PostingList list = postings.decode();
+      for (size_t j = 0; j < list.size(); j++) {
+        merged.docs.push_back(bases[i] + list.docs[j]);
+        merged.freqs.push_back(list.freqs[j]);
+      }
+      if (store_positions) {
+        std::vector<uint32_t> list_positions = postings.decode_positions();
+        positions.insert(positions.end(), list_positions.begin(),
+                         list_positions.end());
+      }
+      done.push_back(i);
+    }
+    if (!writer.add_term(term, merged, &positions)) {
+      return false;
+    }
+
+    for (size_t i : done) {
+      its[i].next();
+      if (its[i].valid()) {
+        heap.push_back(i);
+        std::push_heap(heap.begin(), heap.end(), greater);
+      }
+    }
+  }
+  return writer.finish();
+}
+
+std::optional<MergeSpec> SegmentMerger::pick_merge(
+    const std::vector<uint64_t>& sizes,
+    size_t merge_factor) {
+  merge_factor = std::max<size_t>(2, merge_factor);
+  std::optional<MergeSpec> best;
+  int best_tier = std::numeric_limits<int>::max();
+
+  // Find runs of adjacent segments in the same tier
+  size_t start = 0;
+  while (start < sizes.size()) {
+    int t = tier(sizes[start], merge_factor);
+    size_t end = start + 1;
+    while (end < sizes.size() && tier(sizes[end], merge_factor) == t) {
+      end++;
+    }
+    if (end - start >= merge_factor && t < best_tier) {
+      best = MergeSpec{start, merge_factor};
+      best_tier = t;
+    }
+    start = end;
+  }
+  return best;
+}
+
+int SegmentMerger::tier(uint64_t bytes, size_t merge_factor) {
+  uint64_t factor = std::max<size_t>(2, merge_factor);
+  int t = 0;
+  uint64_t limit = kFloorBytes;
+  while (bytes > limit &&
+         limit <= std::numeric_limits<uint64_t>::max() / factor) {
+    limit *= factor;
+    t++;
+  }
+  return t;
+}
@@ -0,0 +1,76 @@
+#ifndef SEGMENTMERGER_HPP_
+#define SEGMENTMERGER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "IndexSegment.hpp"
+#include "RateLimiter.hpp"
+
+// A run of adjacent segments chosen to be merged into one
+struct MergeSpec {
+  size_t first;  // Index of the first segment of the run
+  size_t count;  // Number of segments in the run
+
+  bool operator==(const MergeSpec& other) const = default;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// A SegmentMerger combines IndexSegments into one, and decides
+// which segments of an index should be combined.
+//
+// A merge streams the terms of every input in order through a k-way
+// merge on a heap, so only the postings of one term are ever in memory.
+// The documents of the inputs are concatenated in order, so the inputs
+// must hold consecutive ranges of doc ids for the ids to be kept.
+//
+// The merge policy is tiered: each segment is put in a tier by its
+// size, with each tier merge_factor times larger than the one below it,
+// and a merge is due once merge_factor adjacent segments share a tier.
+// Each document is then rewritten about log(n) times in all, rather
+// than every time a segment is added.
+///////////////////////////////////////////////////////////////////////////////
+class SegmentMerger {
+ public:
+  // Segments up to this size are all in the lowest tier
+  static constexpr uint64_t kFloorBytes = 64 * 1024;
+
+  // Merges segments into a new segment file.
+  //
+  // Arguments:
+  // - inputs: the segments to merge. The documents of inputs[i] follow
+  //   those of inputs[i - 1] in the merged segment. Positions are kept
+  //   if every input has them.
+  // - fname: the name of the segment file to write
+  // - limiter: if not nullptr, the writes of the merge wait on it
+  //
+  // Returns:
+  // - true if the merged segment was written
+  // - false if an input is not open, there are too many documents
+  //   for 32 bit ids, or the file could not be written
+  static bool merge(const std::vector<const IndexSegment*>& inputs,
+                    const std::string& fname,
+                    RateLimiter* limiter = nullptr);
+
+  // Picks the next merge to do, if any. Prefers the merge in the
+  // lowest tier, which is the cheapest.
+  //
+  // Arguments:
+  // - sizes: the size in bytes of each segment, oldest first
+  // - merge_factor: the number of segments to merge at once, at least 2
+  //
+  // Returns:
+  // - the run of segments to merge
+  // - nullopt if no tier has merge_factor adjacent segments
+  static std::optional<MergeSpec> pick_merge(
+      const std::vector<uint64_t>& sizes,
+      size_t merge_factor);
+
+  // Returns the tier of a segment of the specified size
+  static int tier(uint64_t bytes, size_t merge_factor);
+};
+
+#endif  // SEGMENTMERGER_HPP_
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "ByteIO.hpp"
+#include "MappedFile.hpp"
+#include "SegmentWriter.hpp"
+#include "StreamVByte.hpp"
+
+// StreamVByte may read this far past the end of the last postings
+// or positions
+static constexpr size_t kPadding = 16;
+
+bool SegmentWriter::write(const InvertedIndex& index,
+                          const std::string& fname) {
+  SegmentWriter writer(fname, nullptr, index.has_positions());
+  for (uint32_t doc = 0; doc < index.num_docs(); doc++) {
+    writer.add_doc(index.doc_name(doc), index.doc_length(doc));
+  }
+
+  const TermDictionary& dict = index.dictionary();
+  std::vector<uint32_t> ids(index.num_terms());
+  for (uint32_t id = 0; id < ids.size(); id++) {
+    ids[id] = id;
+  }
+  std::sort(ids.begin(), ids.end(), [&dict](uint32_t a, uint32_t b) {
+    return dict.term(a) < dict.term(b);
+  });
+  for (uint32_t id : ids) {
+    if (!writer.add_term(dict.term(id), index.postings(id),
+                         &index.positions(id))) {
+      return false;
+    }
+  }
+  return writer.finish();
+}
+
+SegmentWriter::SegmentWriter(const std::string& fname,
+                             RateLimiter* limiter,
+                             bool store_positions)
+    : out_(fname, limiter),
+      finished_(false),
+      last_offset_(0),
+      last_positions_offset_(0),
+      num_terms_(0),
+      num_postings_(0),
+      total_tokens_(0) {
+  IndexSegment::Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, IndexSegment::kMagic, sizeof(header.magic));
+  header.version = IndexSegment::kVersion;
+  if (store_positions) {
+    header.flags |= IndexSegment::kHasPositions;
+    positions_name_ = fname + ".positions";
+    positions_.emplace(positions_name_, limiter);
+  }
+  out_.write(&header, sizeof(header));
+}
+
+SegmentWriter::~SegmentWriter() {
+  if (positions_.has_value()) {
+    positions_.reset();
+    std::remove(positions_name_.c_str());
+  }
+}
+
+bool SegmentWriter::good() const {
+  return out_.good() && (!positions_.has_value() || positions_->good());
+}
+
+void SegmentWriter::add_doc(std::string_view name, uint32_t length) {
+  docs_.push_back(IndexSegment::DocEntry{
+      static_cast<uint32_t>(doc_names_.size()),
+      static_cast<uint32_t>(name.length()), length});
+  doc_names_.append(name);
+  total_tokens_ += length;
+}
+
+bool SegmentWriter::add_term(std::string_view term,
+                             const PostingList& postings,
+                             const std::vector<uint32_t>* positions) {
+  if (!good() || finished_ || postings.size() == 0 ||
+      (num_terms_ > 0 && term <= last_term_)) {
+    return false;
+  }
+  if (positions_.has_value()) {
+    uint64_t total = 0;
+    for (uint32_t freq : postings.freqs) {
+      total += freq;
+    }
+    if (positions == nullptr || positions->size() != total) {
+      return false;
+    }
+  }
+
+  // The postings: the (last doc, offset) table then the blocks,
+  // encoded as CompressedPostings does
+  constexpr size_t kBlockSize = SegmentPostings::kBlockSize;
+  uint64_t postings_offset = out_.tell();
+  size_t n = postings.size();
+  size_t num_blocks = (n + kBlockSize - 1) / kBlockSize;
+  size_t data = num_blocks * 2 * sizeof(uint32_t);
+  scratch_.resize(data);
+
+  uint32_t gaps[kBlockSize];
+  uint32_t prev = 0;
+  for (size_t block = 0; block < num_blocks; block++) {
+    size_t start = block * kBlockSize;
+    size_t len = std::min(kBlockSize, n - start);
+    for (size_t i = 0; i < len; i++) {
+      gaps[i] = postings.docs[start + i] - prev;
+      prev = postings.docs[start + i];
+    }
+    uint32_t entry[2] = {prev, static_cast<uint32_t>(scratch_.size() - data)};
+    memcpy(scratch_.data() + block * sizeof(entry), entry, sizeof(entry));
+    StreamVByte::encode(gaps, len, &scratch_);
+    StreamVByte::encode(postings.freqs.data() + start, len, &scratch_);
+  }
+  out_.write(scratch_.data(), scratch_.size());
+
+  // The positions: where each block's positions start then the blocks.
+  // Each document's positions are stored as gaps from the one before.
+  uint64_t positions_offset = 0;
+  if (positions_.has_value()) {
+    positions_offset = positions_->tell();
+    scratch_.resize(num_blocks * sizeof(uint32_t));
+    data = scratch_.size();
+    std::vector<uint32_t> position_gaps;
+    const uint32_t* next = positions->data();
+    for (size_t block = 0; block < num_blocks; block++) {
+      uint32_t offset = static_cast<uint32_t>(scratch_.size() - data);
+      memcpy(scratch_.data() + block * sizeof(offset), &offset,
+             sizeof(offset));
+      position_gaps.clear();
+      size_t start = block * kBlockSize;
+      size_t len = std::min(kBlockSize, n - start);
+      for (size_t i = start; i < start + len; i++) {
+        uint32_t last = 0;
+        for (uint32_t j = 0; j < postings.freqs[i]; j++) {
+          position_gaps.push_back(next[j] - last);
+          last = next[j];
+        }
+        next += postings.freqs[i];
+      }
+      StreamVByte::encode(position_gaps.data(), position_gaps.size(),
+                          &scratch_);
+    }
+    positions_->write(scratch_.data(), scratch_.size());
+  }
+
+  // The dictionary entry. The first term of each block is stored
+  // whole and also goes in the sparse index.
+  size_t prefix = 0;
+  if (num_terms_ % IndexSegment::kTermsPerBlock == 0) {
+    sparse_.push_back(IndexSegment::SparseEntry{
+        dict_.size(), static_cast<uint32_t>(sparse_keys_.size()),
+        static_cast<uint32_t>(term.length())});
+    sparse_keys_.append(term);
+    ByteIO::put_varint(0, &dict_);
+    ByteIO::put_varint(term.length(), &dict_);
+    ByteIO::put_varint(n, &dict_);
+    ByteIO::put_varint(postings_offset, &dict_);
+    if (positions_.has_value()) {
+      ByteIO::put_varint(positions_offset, &dict_);
+    }
+  } else {
+    size_t max = std::min(term.length(), last_term_.length());
+    while (prefix < max && term[prefix] == last_term_[prefix]) {
+      prefix++;
+    }
+    ByteIO::put_varint(prefix, &dict_);
+    ByteIO::put_varint(term.length() - prefix, &dict_);
+    ByteIO::put_varint(n, &dict_);
+    ByteIO::put_varint(postings_offset - last_offset_, &dict_);
+    if (positions_.has_value()) {
+      ByteIO::put_varint(positions_offset - last_positions_offset_, &dict_);
+    }
+  }
+  dict_.insert(dict_.end(), term.begin() + prefix, term.end());
+
+  last_term_.assign(term);
+  last_offset_ = postings_offset;
+  last_positions_offset_ = positions_offset;
+  num_terms_++;
+  num_postings_ += n;
+  return good();
+}
+
+bool SegmentWriter::finish() {
+  if (finished_) {
+    return false;
+  }
+  finished_ = true;
+
+  IndexSegment::Footer footer;
+  footer.postings_end = out_.tell();
+  uint8_t padding[kPadding] = {};
+  out_.write(padding, kPadding);
+
+  footer.positions_offset = out_.tell();
+  if (positions_.has_value()) {
+    if (!positions_->close_file()) {
+      return false;
+    }
+    MappedFile positions(positions_name_);
+    if (!positions.good() || !out_.write(positions.contents())) {
+      return false;
+    }
+  }
+  footer.positions_end = out_.tell();
+  if (positions_.has_value()) {
+    out_.write(padding, kPadding);
+  }
+
+  footer.dict_offset = out_.tell();
+  out_.write(dict_.data(), dict_.size());
+  footer.dict_end = out_.tell();
+
+  footer.sparse_offset = out_.tell();
+  footer.num_blocks = sparse_.size();
+  out_.write(sparse_.data(),
+             sparse_.size() * sizeof(IndexSegment::SparseEntry));
+  footer.sparse_keys_offset = out_.tell();
+  out_.write(sparse_keys_);
+
+  footer.docs_offset = out_.tell();
+  out_.write(docs_.data(), docs_.size() * sizeof(IndexSegment::DocEntry));
+  footer.doc_names_offset = out_.tell();
+  out_.write(doc_names_);
+
+  footer.num_terms = num_terms_;
+  footer.num_docs = docs_.size();
+  footer.num_postings = num_postings_;
+  footer.total_tokens = total_tokens_;
+  memcpy(footer.magic, IndexSegment::kMagic, sizeof(footer.magic));
+  out_.write(&footer, sizeof(footer));
+  return out_.close_file();
+}
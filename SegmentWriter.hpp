@@ -0,0 +1,118 @@
+#ifndef SEGMENTWRITER_HPP_
+#define SEGMENTWRITER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BufferedFileWriter.hpp"
+#include "IndexSegment.hpp"
+#include "InvertedIndex.hpp"
+#include "RateLimiter.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// A SegmentWriter writes an IndexSegment file one term at a time.
+//
+// The postings are written out as they are added, so only the term
+// dictionary and document table are held in memory until finish()
+// writes them and the footer. A segment with no footer, such as one
+// whose writer was destroyed before finish(), won't open.
+//
+// Positions go to a temporary file next to the segment as they are
+// added, and are copied in after the postings by finish().
+///////////////////////////////////////////////////////////////////////////////
+class SegmentWriter {
+ public:
+  // Writes an InvertedIndex to a segment file.
+  //
+  // Arguments:
+  // - index: the index to write. The documents keep their ids, and
+  //   its positions are written if it has them.
+  // - fname: the name of the segment file
+  //
+  // Returns:
+  // - true if the segment was written, false otherwise
+  static bool write(const InvertedIndex& index, const std::string& fname);
+
+  // Constructor for a SegmentWriter. Creates the file,
+  // truncating it if it exists. If it can't be created, good() is false.
+  //
+  // Arguments:
+  // - fname: the name of the segment file
+  // - limiter: if not nullptr, every write waits on it first
+  // - store_positions: whether every term is added with its positions
+  SegmentWriter(const std::string& fname,
+                RateLimiter* limiter = nullptr,
+                bool store_positions = false);
+
+  // Destructor for a SegmentWriter. Removes the temporary positions file.
+  ~SegmentWriter();
+
+  // Returns whether everything so far has been written
+  bool good() const;
+
+  // Adds the next document. Documents are numbered in the order
+  // they are added, from 0.
+  //
+  // Arguments:
+  // - name: the name of the document's file
+  // - length: the number of tokens in the document
+  void add_doc(std::string_view name, uint32_t length);
+
+  // Adds the postings of the next term. Terms must be added in
+  // strictly increasing order.
+  //
+  // Arguments:
+  // - term: the term
+  // - postings: its postings, in increasing order of doc id
+  // - positions: its positions, laid out as InvertedIndex::positions.
+  //   Ignored if the writer doesn't store positions.
+  //
+  // Returns:
+  // - true if the term was added
+  // - false if the postings are empty, the term is out of order,
+  //   the positions are missing or don't match the frequencies,
+  //   or writing failed
+  bool add_term(std::string_view term,
+                const PostingList& postings,
+                const std::vector<uint32_t>* positions = nullptr);
+
+  // Writes the dictionary, document table and footer
+  // and closes the file. Nothing can be added after.
+  //
+  // Returns:
+  // - true if the segment was written, false otherwise
+  bool finish();
+
+  // Ignore These
+  // This is disabling the copy constructor and the assignment operator.
+  SegmentWriter(const SegmentWriter& other) = delete;
+  SegmentWriter& operator=(const SegmentWriter& other) = delete;
+
+ private:
+  BufferedFileWriter out_;
+  bool finished_;
+  std::vector<uint8_t> scratch_;  // The postings of the term being added
+
+  // The positions, if they are stored, and the name of their file
+  std::optional<BufferedFileWriter> positions_;
+  std::string positions_name_;
+
+  std::string last_term_;
+  uint64_t last_offset_;        // Postings offset of the last term
+  uint64_t last_positions_offset_;
+  uint64_t num_terms_;
+  uint64_t num_postings_;
+  std::vector<uint8_t> dict_;   // The dictionary blocks
+  std::vector<IndexSegment::SparseEntry> sparse_;
+  std::string sparse_keys_;
+
+  std::vector<IndexSegment::DocEntry> docs_;
+  std::string doc_names_;
+  uint64_t total_tokens_;
+};
+
+#endif  // SEGMENTWRITER_HPP_
@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+
+#include "BufferedFileReader.hpp"
+#include "BufferedFileWriter.hpp"
+#include "SegmentMerger.hpp"
+#include "SegmentWriter.hpp"
+#include "SegmentedIndex.hpp"
+
+static constexpr const char* kManifest = "segments";
+static constexpr const char* kManifestTemp = "segments.tmp";
+static constexpr const char* kSegmentSuffix = ".seg";
+
+// Returns the number of a segment file name, 0 if it is not one
+static uint64_t segment_number(const std::string& name) {
+  std::string_view suffix(kSegmentSuffix);
+  if (name.length() <= suffix.length() ||
+      name.compare(name.length() - suffix.length(), suffix.length(),
+                   suffix) != 0) {
+    return 0;
+  }
+  return strtoull(name.c_str(), nullptr, 10);
+}
+
+SegmentedIndex::SegmentedIndex(const std::string& dir,
+                               size_t merge_factor,
+                               uint64_t merge_bytes_per_sec,
+                               const std::string& delims,
+                               bool fold_case,
+                               bool store_positions)
+    : dir_(dir),
+      merge_factor_(merge_factor),
+      delims_(delims),
+      fold_case_(fold_case),
+      store_positions_(store_positions),
+      buffer_(delims, fold_case, store_positions),
+      flushed_docs_(0),
+      next_segment_(1),
+      merge_pending_(false),
+      merging_(false),
+      stop_(false),
+      num_merges_(0),
+      limiter_(merge_bytes_per_sec) {
+  good_ = open_dir();
+  if (good_) {
+    for (const SegmentPtr& segment : segments_) {
+      flushed_docs_ += segment->num_docs();
+    }
+    // merge anything a previous run left unmerged
+    merge_pending_ = true;
+    merger_ = std::thread(&SegmentedIndex::merge_loop, this);
+  }
+}
+
+SegmentedIndex::~SegmentedIndex() {
+  if (!good_) {
+    return;
+  }
+  flush();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  merger_.join();
+}
+
+bool SegmentedIndex::good() const {
+  return good_;
+}
+
+std::optional<uint32_t> SegmentedIndex::add_file(const std::string& fname) {
+  if (!good_) {
+    return std::nullopt;
+  }
+  std::optional<uint32_t> doc = buffer_.add_file(fname);
+  if (!doc.has_value()) {
+    return std::nullopt;
+  }
+  uint32_t id = static_cast<uint32_t>(flushed_docs_ + doc.value());
+  if (buffer_.total_tokens() >= kFlushTokens) {
+    flush();
+  }
+  return id;
+}
+
+bool SegmentedIndex::flush() {
+  if (!good_) {
+    return false;
+  }
+  if (buffer_.num_docs() == 0) {
+    return true;
+  }
+
+  std::string name;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    name = new_segment_name();
+  }
+  std::string fname = path(name);
+  if (!SegmentWriter::write(buffer_, fname)) {
+    std::remove(fname.c_str());
+    return false;
+  }
+  SegmentPtr segment = std::make_shared<IndexSegment>(fname);
+  if (!segment->good()) {
+    std::remove(fname.c_str());
+    return false;
+  }
+
+  bool ok;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    segments_.push_back(segment);
+    names_.push_back(name);
+    ok = write_manifest();
+    merge_pending_ = true;
+  }
+  cv_.notify_all();
+
+  flushed_docs_ += buffer_.num_docs();
+  buffer_ = InvertedIndex(delims_, fold_case_, store_positions_);
+  return ok;
+}
+
+void SegmentedIndex::wait_for_merges() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return stop_ || (!merge_pending_ && !merging_); });
+}
+
+PostingList SegmentedIndex::postings(std::string_view term) const {
+  std::string scratch;
+  std::string_view folded = fold_case_ ? fold_token(term, &scratch) : term;
+
+  // The documents of each segment follow those of the one before
+  PostingList result;
+  uint32_t base = 0;
+  for (const SegmentPtr& segment : snapshot()) {
+    std::optional<SegmentPostings> postings = segment->postings(folded);
+    if (postings.has_value()) {
+      PostingList list = postings->decode();
+      for (size_t i = 0; i < list.size(); i++) {
+        result.docs.push_back(base + list.docs[i]);
+        result.freqs.push_back(list.freqs[i]);
+      }
+    }
+    base += static_cast<uint32_t>(segment->num_docs());
+  }
+  return result;
+}
+
+std::vector<Posting> SegmentedIndex::find_phrase(
+    const std::vector<std::string_view>& terms) const {
+  std::vector<std::string> scratch(terms.size());
+  std::vector<std::string_view> folded(terms);
+  if (fold_case_) {
+    for (size_t i = 0; i < terms.size(); i++) {
+      folded[i] = fold_token(terms[i], &scratch[i]);
+    }
+  }
+
+  std::vector<Posting> result;
+  uint32_t base = 0;
+  for (const SegmentPtr& segment : snapshot()) {
+    for (Posting posting : segment->find_phrase(folded)) {
+      result.push_back(Posting{base + posting.doc, posting.freq});
+    }
+    base += static_cast<uint32_t>(segment->num_docs());
+  }
+  return result;
+}
+
+std::string SegmentedIndex::doc_name(uint32_t doc) const {
+  for (const SegmentPtr& segment : snapshot()) {
+    if (doc < segment->num_docs()) {
+      return std::string(segment->doc_name(doc));
+    }
+    doc -= static_cast<uint32_t>(segment->num_docs());
+  }
+  return "";
+}
+
+size_t SegmentedIndex::num_docs() const {
+  size_t total = 0;
+  for (const SegmentPtr& segment : snapshot()) {
+    total += segment->num_docs();
+  }
+  return total;
+}
+
+size_t SegmentedIndex::num_segments() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return segments_.size();
+}
+
+size_t SegmentedIndex::num_merges() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_merges_;
+}
+
+std::vector<SegmentedIndex::SegmentPtr> SegmentedIndex::snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return segments_;
+}
+
+bool SegmentedIndex::open_dir() {
+  std::error_code ec;
+  std::filesystem::create_directories(dir_, ec);
+  if (ec) {
+    return false;
+  }
+
+  // The manifest lists the live segments, one per line
+  if (std::filesystem::exists(path(kManifest), ec)) {
+    BufferedFileReader reader(path(kManifest));
+    if (!reader.good()) {
+      return false;
+    }
+    reader.for_each_token("\n", [this](std::string_view name) {
+      if (!name.empty()) {
+        names_.emplace_back(name);
+      }
+    });
+  }
+  for (const std::string& name : names_) {
+    SegmentPtr segment = std::make_shared<IndexSegment>(path(name));
+    if (!segment->good()) {
+      return false;
+    }
+    segments_.push_back(segment);
+    next_segment_ = std::max(next_segment_, segment_number(name) + 1);
+  }
+
+  // Anything else is from a flush or merge that didn't finish
+  std::filesystem::directory_iterator it(dir_, ec);
+  if (ec) {
+    return false;
+  }
+  for (const auto& entry : it) {
+    std::string name = entry.path().filename().string();
+    bool live = std::find(names_.begin(), names_.end(), name) != names_.end();
+    if (name == kManifestTemp || (segment_number(name) != 0 && !live)) {
+      std::filesystem::remove(entry.path(), ec);
+    }
+  }
+  return true;
+}
+
+bool SegmentedIndex::write_manifest() {
+  std::string contents;
+  for (const std::string& name : names_) {
+    contents += name;
+    contents += '\n';
+  }
+
+  // Write a new manifest and move it over the old one, so
+  // there is always a whole manifest in the directory
+  std::string temp = path(kManifestTemp);
+  BufferedFileWriter out(temp);
+  out.write(contents);
+  return out.close_file() &&
+         rename(temp.c_str(), path(kManifest).c_str()) == 0;
+}
+
+std::string SegmentedIndex::new_segment_name() {
+  return std::to_string(next_segment_++) + kSegmentSuffix;
+}
+
+std::string SegmentedIndex::path(const std::string& name) const {
+  return (std::filesystem::path(dir_) / name).string();
+}
+
+void SegmentedIndex::merge_loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || merge_pending_; });
+    if (stop_) {
+      return;
+    }
+
+    std::vector<uint64_t> sizes;
+    for (const SegmentPtr& segment : segments_) {
+      sizes.push_back(segment->file_bytes());
+    }
+    std::optional<MergeSpec> spec =
+        SegmentMerger::pick_merge(sizes, merge_factor_);
+    if (!spec.has_value()) {
+      merge_pending_ = false;
+      cv_.notify_all();
+      continue;
+    }
+
+    // Merge without holding the lock, so queries and flushes go on.
+    // The inputs are kept alive by their shared_ptrs.
+    std::vector<SegmentPtr> inputs(
+        segments_.begin() + spec->first,
+        segments_.begin() + spec->first + spec->count);
+    std::string name = new_segment_name();
+    merging_ = true;
+    lock.unlock();
+
+    std::vector<const IndexSegment*> ptrs;
+    for (const SegmentPtr& input : inputs) {
+      ptrs.push_back(input.get());
+    }
+    std::string fname = path(name);
+    SegmentPtr merged;
+    if (SegmentMerger::merge(ptrs, fname, &limiter_)) {
+      merged = std::make_shared<IndexSegment>(fname);
+    }
+
+    lock.lock();
+    merging_ = false;
+    if (merged == nullptr || !merged->good()) {
+      // Give up until the next flush rather than retry forever
+      std::remove(fname.c_str());
+      merge_pending_ = false;
+      cv_.notify_all();
+      continue;
+    }
+
+    // flush() only appends, so the inputs are where they were
+    std::vector<std::string> old_names(
+        names_.begin() + spec->first,
+        names_.begin() + spec->first + spec->count);
+    segments_.erase(segments_.begin() + spec->first,
+                    segments_.begin() + spec->first + spec->count);
+    segments_.insert(segments_.begin() + spec->first, merged);
+    names_.erase(names_.begin() + spec->first,
+                 names_.begin() + spec->first + spec->count);
+    names_.insert(names_.begin() + spec->first, name);
+    num_merges_++;
+
+    // A query still using the old segments keeps them mapped
+    if (write_manifest()) {
+      for (const std::string& old_name : old_names) {
+        std::remove(path(old_name).c_str());
+      }
+    }
+  }
+}
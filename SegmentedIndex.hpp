@@ -0,0 +1,188 @@
+#ifndef SEGMENTEDINDEX_HPP_
+#define SEGMENTEDINDEX_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "IndexSegment.hpp"
+#include "InvertedIndex.hpp"
+#include "RateLimiter.hpp"
+#include "TextUtil.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// A SegmentedIndex is an inverted index kept in a directory as a list of
+// IndexSegments, so documents can be added without rebuilding it.
+//
+// New documents go into an InvertedIndex in memory, which is written out
+// as a new small segment when it grows large or on flush(). A background
+// thread then merges segments with SegmentMerger's tiered policy, so the
+// number of segments a query has to visit stays logarithmic. The writes
+// of a merge go through a RateLimiter so merging can't starve queries of
+// disk bandwidth.
+//
+// The live segments are listed in a manifest file in the directory,
+// which is replaced with rename() after every change, so the index can
+// be reopened if the process dies at any point. Segments are always merged
+// with their neighbours, so a document keeps its id for good: its
+// position among all documents ever added.
+//
+// Queries can run on any number of threads while documents are being
+// added and segments merged: each query works on the segments that
+// were live when it started. Documents that have been added but not
+// flushed are not seen by queries. add_file() and flush() should be
+// called from one thread at a time.
+///////////////////////////////////////////////////////////////////////////////
+class SegmentedIndex {
+ public:
+  // The size, in tokens, at which added documents are flushed
+  static constexpr uint64_t kFlushTokens = 1 << 20;
+
+  // Constructor for a SegmentedIndex. Opens the index in a directory,
+  // creating the directory if it does not exist. Files in it that are
+  // not in the manifest, left by a crash, are removed.
+  // If the directory or any of its segments can't be opened,
+  // good() is false.
+  //
+  // Arguments:
+  // - dir: the directory of the index
+  // - merge_factor: the number of segments merged at once
+  // - merge_bytes_per_sec: the most bytes per second merges may write,
+  //   0 for no limit
+  // - delims: the delimiters used to split files into tokens
+  // - fold_case: whether to convert ASCII letters to lower case
+  // - store_positions: whether to keep the positions of the terms of new
+  //   documents, so phrases can be found
+  SegmentedIndex(const std::string& dir,
+                 size_t merge_factor = 4,
+                 uint64_t merge_bytes_per_sec = 0,
+                 const std::string& delims = kDefaultDelims,
+                 bool fold_case = true,
+                 bool store_positions = false);
+
+  // Destructor for a SegmentedIndex. Flushes any added documents and
+  // waits for a merge in progress to finish.
+  ~SegmentedIndex();
+
+  // Returns whether the index is open
+  bool good() const;
+
+  // Adds a file to the index as a new document. It is seen by
+  // queries once flushed.
+  //
+  // Arguments:
+  // - fname: The name of the file
+  //
+  // Returns:
+  // - the id of the document
+  // - nullopt if the file could not be opened
+  std::optional<uint32_t> add_file(const std::string& fname);
+
+  // Writes the documents added since the last flush as a new segment
+  //
+  // Returns:
+  // - true if there was nothing to write or it was written
+  // - false if the segment could not be written
+  bool flush();
+
+  // Waits until the merger has no more merges to do
+  void wait_for_merges();
+
+  // Looks up the postings of a term, across all segments. The term
+  // is case folded in the same way as the documents were.
+  //
+  // Arguments:
+  // - term: the term to look for
+  //
+  // Returns:
+  // - the postings of the term, empty if it occurs in no document
+  PostingList postings(std::string_view term) const;
+
+  // Finds the flushed documents that contain a phrase, as
+  // InvertedIndex::find_phrase. The terms are case folded in the same
+  // way as the documents were. Segments without positions, and any
+  // merge that takes one in, have no phrases to find.
+  //
+  // Arguments:
+  // - terms: the terms of the phrase, in order
+  //
+  // Returns:
+  // - the documents with the phrase, in increasing order of doc id,
+  //   each with the number of times the phrase occurs in it
+  std::vector<Posting> find_phrase(
+      const std::vector<std::string_view>& terms) const;
+
+  // Returns the name of the file of a flushed document,
+  // empty if there is no such document
+  std::string doc_name(uint32_t doc) const;
+
+  // Returns the number of flushed documents
+  size_t num_docs() const;
+
+  // Returns the number of live segments
+  size_t num_segments() const;
+
+  // Returns the number of merges done since the index was opened
+  size_t num_merges() const;
+
+  // Ignore These
+  // This is disabling the copy constructor and the assignment operator.
+  SegmentedIndex(const SegmentedIndex& other) = delete;
+  SegmentedIndex& operator=(const SegmentedIndex& other) = delete;
+
+ private:
+  using SegmentPtr = std::shared_ptr<const IndexSegment>;
+
+  // Helper method to take a copy of the live segments
+  std::vector<SegmentPtr> snapshot() const;
+
+  // Helper method to load the manifest and remove stray files
+  bool open_dir();
+
+  // Helper method to write the manifest. Must hold mutex_.
+  bool write_manifest();
+
+  // Helper method that returns the file name of a new segment.
+  // Must hold mutex_.
+  std::string new_segment_name();
+
+  // Helper method that returns the path of a file in the directory
+  std::string path(const std::string& name) const;
+
+  // The body of the merge thread
+  void merge_loop();
+
+  std::string dir_;
+  size_t merge_factor_;
+  std::string delims_;
+  bool fold_case_;
+  bool store_positions_;
+  bool good_;
+
+  // Documents not yet flushed, numbered from flushed_docs_
+  InvertedIndex buffer_;
+  uint64_t flushed_docs_;
+
+  // Guards everything below, which is shared with the merge thread
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<SegmentPtr> segments_;  // Oldest first
+  std::vector<std::string> names_;    // The file name of each segment
+  uint64_t next_segment_;
+  bool merge_pending_;  // Whether segments changed since the last check
+  bool merging_;
+  bool stop_;
+  size_t num_merges_;
+
+  RateLimiter limiter_;  // Only used by the merge thread
+  std::thread merger_;
+};
+
+#endif  // SEGMENTEDINDEX_HPP_
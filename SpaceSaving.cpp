@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <utility>
+
+#include "SpaceSaving.hpp"
+
+SpaceSaving::SpaceSaving(size_t capacity)
+    : capacity_(std::max<size_t>(1, capacity)), total_(0) {
+  heap_.reserve(capacity_);
+  index_.reserve(capacity_);
+}
+
+void SpaceSaving::add(std::string_view term, uint64_t by) {
+  total_ += by;
+  auto it = index_.find(term);
+  if (it != index_.end()) {
+    heap_[it->second].count += by;
+    sift_down(it->second);
+    return;
+  }
+
+  if (heap_.size() < capacity_) {
+    heap_.push_back(HeavyHitter{std::string(term), by, 0});
+    index_.emplace(heap_.back().term, heap_.size() - 1);
+    // A count of `by` may be smaller than its parents'
+    size_t i = heap_.size() - 1;
+    while (i > 0 && heap_[(i - 1) / 2].count > heap_[i].count) {
+      size_t parent = (i - 1) / 2;
+      std::swap(heap_[i], heap_[parent]);
+      index_[heap_[i].term] = i;
+      index_[heap_[parent].term] = parent;
+      i = parent;
+    }
+    return;
+  }
+
+  // Take over the counter with the smallest count
+  HeavyHitter& min = heap_[0];
+  index_.erase(min.term);
+  min.term.assign(term);
+  min.error = min.count;
+  min.count += by;
+  index_.emplace(min.term, 0);
+  sift_down(0);
+}
+
+void SpaceSaving::merge(const SpaceSaving& other) {
+  // A term missing from a full summary may have occurred
+  // up to its smallest count times, so that is what it adds.
+  uint64_t min_this = min_count();
+  uint64_t min_other = other.min_count();
+
+  std::unordered_map<std::string, HeavyHitter, TermHash, TermEqual> merged;
+  for (const HeavyHitter& h : heap_) {
+    merged.emplace(h.term, h);
+  }
+  for (const HeavyHitter& h : other.heap_) {
+    auto it = merged.find(h.term);
+    if (it == merged.end()) {
+      merged.emplace(h.term, HeavyHitter{h.term, h.count + min_this,
+                                         h.error + min_this});
+    } else {
+      it->second.count += h.count;
+      it->second.error += h.error;
+    }
+  }
+  for (auto& [term, h] : merged) {
+    if (!other.index_.contains(term)) {
+      h.count += min_other;
+      h.error += min_other;
+    }
+  }
+
+  // Keep the `capacity_` highest counts
+  std::vector<HeavyHitter> all;
+  all.reserve(merged.size());
+  for (auto& [term, h] : merged) {
+    all.push_back(std::move(h));
+  }
+  if (all.size() > capacity_) {
+    std::nth_element(all.begin(), all.begin() + capacity_, all.end(),
+                     [](const HeavyHitter& a, const HeavyHitter& b) {
+                       return a.count > b.count;
+                     });
+    all.resize(capacity_);
+  }
+  heap_ = std::move(all);
+  total_ += other.total_;
+  make_heap();
+}
+
+std::vector<HeavyHitter> SpaceSaving::top(size_t n) const {
+  std::vector<HeavyHitter> res = heap_;
+  auto by_count = [](const HeavyHitter& a, const HeavyHitter& b) {
+    if (a.count != b.count) {
+      return a.count > b.count;
+    }
+    return a.term < b.term;
+  };
+  n = std::min(n, res.size());
+  std::partial_sort(res.begin(), res.begin() + n, res.end(), by_count);
+  res.resize(n);
+  return res;
+}
+
+uint64_t SpaceSaving::estimate(std::string_view term) const {
+  auto it = index_.find(term);
+  if (it != index_.end()) {
+    return heap_[it->second].count;
+  }
+  return min_count();
+}
+
+uint64_t SpaceSaving::total() const {
+  return total_;
+}
+
+size_t SpaceSaving::size() const {
+  return heap_.size();
+}
+
+size_t SpaceSaving::capacity() const {
+  return capacity_;
+}
+
+uint64_t SpaceSaving::min_count() const {
+  if (heap_.size() < capacity_) {
+    return 0;
+  }
+  return heap_[0].count;
+}
+
+void SpaceSaving::sift_down(size_t i) {
+  size_t n = heap_.size();
+  while (true) {
+    size_t smallest = i;
+    size_t left = 2 * i + 1;
+    size_t right = left + 1;
+    if (left < n && heap_[left].count < heap_[smallest].count) {
+      smallest = left;
+    }
+    if (right < n && heap_[right].count < heap_[smallest].count) {
+      smallest = right;
+    }
+    if (smallest == i) {
+      return;
+    }
+    std::swap(heap_[i], heap_[smallest]);
+    index_[heap_[i].term] = i;
+    index_[heap_[smallest].term] = smallest;
+    i = smallest;
+  }
+}
+
+void SpaceSaving::make_heap() {
+  index_.clear();
+  for (size_t i = 0; i < heap_.size(); i++) {
+    index_.emplace(heap_[i].term, i);
+  }
+  for (size_t i = heap_.size() / 2; i-- > 0;) {
+    sift_down(i);
+  }
+}
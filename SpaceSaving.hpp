@@ -0,0 +1,87 @@
+#ifndef SPACESAVING_HPP_
+#define SPACESAVING_HPP_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "TermHash.hpp"
+
+// A term kept by a SpaceSaving summary. The true count of the
+// term is between count - error and count.
+struct HeavyHitter {
+  std::string term;
+  uint64_t count;  // Estimated count, never an underestimate
+  uint64_t error;  // Most the count may be over by
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// A SpaceSaving summary finds the most frequent terms of a stream using
+// a fixed number of counters (the Space-Saving algorithm of Metwally,
+// Agrawal and El Abbadi).
+//
+// Each counter holds a term. A term with a counter has it incremented.
+// A new term takes over the counter with the smallest count, inheriting
+// that count as its error. Any term that occurs more than total / capacity
+// times is guaranteed to hold a counter. The counters are kept in a min
+// heap, so an update costs O(log capacity).
+///////////////////////////////////////////////////////////////////////////////
+class SpaceSaving {
+ public:
+  // Constructor for an empty SpaceSaving summary.
+  //
+  // Arguments:
+  // - capacity: the number of counters, at least 1
+  SpaceSaving(size_t capacity = 1024);
+
+  // Counts occurrences of a term.
+  //
+  // Arguments:
+  // - term: the term
+  // - by: the number of occurrences
+  void add(std::string_view term, uint64_t by = 1);
+
+  // Adds the counts of another summary to this one, as if this
+  // summary had also seen the other's stream. The guarantees on
+  // counts and errors still hold after merging.
+  //
+  // Arguments:
+  // - other: the summary to merge in
+  void merge(const SpaceSaving& other);
+
+  // Returns the `n` terms with the highest counts, highest first.
+  // Ties are broken alphabetically.
+  std::vector<HeavyHitter> top(size_t n) const;
+
+  // Returns the estimated count of a term. If the term holds no
+  // counter, this is the most it can have occurred.
+  uint64_t estimate(std::string_view term) const;
+
+  // Returns the total of all counts added
+  uint64_t total() const;
+
+  // Returns the number of terms with a counter
+  size_t size() const;
+
+  // Returns the number of counters
+  size_t capacity() const;
+
+ private:
+  // Helper method that returns the count a term without a counter
+  // may have: the smallest count once every counter is used.
+  uint64_t min_count() const;
+
+  // Helper methods to restore the heap after the count of
+  // heap_[i] went up, or after building it from scratch
+  void sift_down(size_t i);
+  void make_heap();
+
+  size_t capacity_;
+  uint64_t total_;
+  std::vector<HeavyHitter> heap_;  // Min heap on count
+  std::unordered_map<std::string, size_t, TermHash, TermEqual> index_;
+};
+
+#endif  // SPACESAVING_HPP_
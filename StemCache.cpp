@@ -0,0 +1,74 @@
+#include <cstring>
+
+#include "StemCache.hpp"
+#include "TermHash.hpp"
+
+StemCache::StemCache(size_t capacity)
+    : set_mask_(0), clock_(0), hits_(0), misses_(0) {
+  size_t sets = 1;
+  while (sets * kWays < capacity) {
+    sets *= 2;
+  }
+  entries_.resize(sets * kWays);
+  for (Entry& e : entries_) {
+    e.tag = 0;
+    e.last_used = 0;
+    e.word_len = 0;
+    e.stem_len = 0;
+  }
+  set_mask_ = sets - 1;
+}
+
+std::string_view StemCache::stem(std::string_view word) {
+  if (word.length() > kMaxCachedLen) {
+    misses_++;
+    return stemmer_.stem(word);
+  }
+
+  uint64_t h = fnv1a(word);
+  // the tag is never 0 so that 0 can mark an empty entry
+  uint32_t tag = static_cast<uint32_t>(h >> 32) | 1;
+  Entry* set = &entries_[(h & set_mask_) * kWays];
+  clock_++;
+
+  // Look for the word in its set. Differently cased forms of a word
+  // get separate entries.
+  Entry* victim = &set[0];
+  for (size_t i = 0; i < kWays; i++) {
+    Entry& e = set[i];
+    if (e.tag == tag && e.word_len == word.length() &&
+        memcmp(e.word, word.data(), word.length()) == 0) {
+      e.last_used = clock_;
+      hits_++;
+      return std::string_view(e.stem, e.stem_len);
+    }
+    if (e.tag == 0 ||
+        (victim->tag != 0 && e.last_used < victim->last_used)) {
+      victim = &e;
+    }
+  }
+
+  // Miss: stem the word and replace the least recently used entry.
+  // A stem is never longer than the word, so it always fits.
+  misses_++;
+  std::string_view s = stemmer_.stem(word);
+  victim->tag = tag;
+  victim->last_used = clock_;
+  victim->word_len = static_cast<uint8_t>(word.length());
+  victim->stem_len = static_cast<uint8_t>(s.length());
+  memcpy(victim->word, word.data(), word.length());
+  memcpy(victim->stem, s.data(), s.length());
+  return std::string_view(victim->stem, victim->stem_len);
+}
+
+size_t StemCache::capacity() const {
+  return entries_.size();
+}
+
+uint64_t StemCache::hits() const {
+  return hits_;
+}
+
+uint64_t StemCache::misses() const {
+  return misses_;
+}
@@ -0,0 +1,73 @@
+#ifndef STEMCACHE_HPP_
+#define STEMCACHE_HPP_
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "Stemmer.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// A StemCache is a stemming stage for the tokens read by a
+// BufferedFileReader that remembers the stems of recently seen words.
+//
+// Word frequencies in text follow Zipf's law, so most tokens are repeats
+// of a small number of words. The cache is a fixed size, two way set
+// associative table of (word -> stem) entries: a hit copies nothing and
+// skips the stemmer entirely, and a miss stems the word and replaces the
+// least recently used entry of its set. All memory is allocated up front
+// by the constructor.
+///////////////////////////////////////////////////////////////////////////////
+class StemCache {
+ public:
+  // Words longer than this are stemmed but never cached.
+  static constexpr size_t kMaxCachedLen = 26;
+
+  // Constructor for a StemCache.
+  //
+  // Arguments:
+  // - capacity: the number of words the cache can hold. Rounded up to
+  //   a power of two.
+  StemCache(size_t capacity = 4096);
+
+  // Returns the stem of a word. See Stemmer::stem for details.
+  //
+  // Arguments:
+  // - word: the word to be stemmed
+  //
+  // Returns:
+  // - a view of the stem. The view is invalidated by the next call to
+  //   stem().
+  std::string_view stem(std::string_view word);
+
+  // Number of words that can be held in the cache
+  size_t capacity() const;
+
+  // Number of calls to stem() that were answered by the cache
+  uint64_t hits() const;
+
+  // Number of calls to stem() that had to run the stemmer
+  uint64_t misses() const;
+
+ private:
+  // An entry is sized so that it fits in one 64 byte cache line.
+  struct Entry {
+    uint32_t tag;        // Upper bits of the word's hash, 0 if empty
+    uint32_t last_used;  // Value of clock_ when the entry was last used
+    uint8_t word_len;
+    uint8_t stem_len;
+    char word[kMaxCachedLen];
+    char stem[kMaxCachedLen];
+  };
+
+  static constexpr size_t kWays = 2;
+
+  std::vector<Entry> entries_;  // kWays consecutive entries per set
+  size_t set_mask_;             // Number of sets - 1
+  uint32_t clock_;              // Incremented on every lookup
+  uint64_t hits_;
+  uint64_t misses_;
+  Stemmer stemmer_;
+};
+
+#endif  // STEMCACHE_HPP_
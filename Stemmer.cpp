@@ -0,0 +1,391 @@
+#include <cstring>
+
+#include "Stemmer.hpp"
+
+Stemmer::Stemmer() : buffer_(), k_(0), j_(0) {}
+
+std::string_view Stemmer::stem(std::string_view word) {
+  if (word.length() > kMaxWordLen) {
+    return word;
+  }
+
+  // Copy the word into our buffer, folding case as we go
+  bool alpha = true;
+  for (size_t i = 0; i < word.length(); i++) {
+    char c = word[i];
+    if (c >= 'A' && c <= 'Z') {
+      c = static_cast<char>(c - 'A' + 'a');
+    } else if (c < 'a' || c > 'z') {
+      alpha = false;
+    }
+    buffer_[i] = c;
+  }
+
+  k_ = static_cast<int>(word.length()) - 1;
+
+  // Words of length one or two are left alone, as is anything that
+  // is not a plain word.
+  if (!alpha || k_ <= 1) {
+    return std::string_view(buffer_.data(), word.length());
+  }
+
+  step1ab();
+  if (k_ > 0) {
+    step1c();
+    step2();
+    step3();
+    step4();
+    step5();
+  }
+
+  return std::string_view(buffer_.data(), k_ + 1);
+}
+
+// Returns true if buffer_[i] is a consonant
+bool Stemmer::cons(int i) const {
+  switch (buffer_[i]) {
+    case 'a':
+    case 'e':
+    case 'i':
+    case 'o':
+    case 'u':
+      return false;
+    case 'y':
+      return (i == 0) ? true : !cons(i - 1);
+    default:
+      return true;
+  }
+}
+
+// Measures the number of consonant sequences between 0 and j_.
+// If c is a consonant sequence and v a vowel sequence, and <..>
+// indicates arbitrary presence,
+//   <c><v>       gives 0
+//   <c>vc<v>     gives 1
+//   <c>vcvc<v>   gives 2
+//   ...
+int Stemmer::m() const {
+  int n = 0;
+  int i = 0;
+  while (true) {
+    if (i > j_) {
+      return n;
+    }
+    if (!cons(i)) {
+      break;
+    }
+    i++;
+  }
+  i++;
+  while (true) {
+    while (true) {
+      if (i > j_) {
+        return n;
+      }
+      if (cons(i)) {
+        break;
+      }
+      i++;
+    }
+    i++;
+    n++;
+    while (true) {
+      if (i > j_) {
+        return n;
+      }
+      if (!cons(i)) {
+        break;
+      }
+      i++;
+    }
+    i++;
+  }
+}
+
+// Returns true if 0..j_ contains a vowel
+bool Stemmer::vowel_in_stem() const {
+  for (int i = 0; i <= j_; i++) {
+    if (!cons(i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if i-1,i contains a double consonant
+bool Stemmer::double_c(int i) const {
+  if (i < 1 || buffer_[i] != buffer_[i - 1]) {
+    return false;
+  }
+  return cons(i);
+}
+
+// Returns true if i-2,i-1,i has the form consonant - vowel - consonant
+// and also if the second c is not w, x or y. This is used when trying to
+// restore an e at the end of a short word. e.g.
+//   cav(e), lov(e), hop(e), crim(e), but
+//   snow, box, tray.
+bool Stemmer::cvc(int i) const {
+  if (i < 2 || !cons(i) || cons(i - 1) || !cons(i - 2)) {
+    return false;
+  }
+  char c = buffer_[i];
+  return c != 'w' && c != 'x' && c != 'y';
+}
+
+// Returns true if 0..k_ ends with the string s, and sets j_ to the
+// index just before the suffix.
+bool Stemmer::ends(std::string_view s) {
+  int length = static_cast<int>(s.length());
+  if (s.back() != buffer_[k_]) {
+    return false;
+  }
+  if (length > k_ + 1) {
+    return false;
+  }
+  if (memcmp(buffer_.data() + k_ - length + 1, s.data(), length) != 0) {
+    return false;
+  }
+  j_ = k_ - length;
+  return true;
+}
+
+// Sets (j_+1)..k_ to the string s, readjusting k_
+void Stemmer::set_to(std::string_view s) {
+  memcpy(buffer_.data() + j_ + 1, s.data(), s.length());
+  k_ = j_ + static_cast<int>(s.length());
+}
+
+void Stemmer::r(std::string_view s) {
+  if (m() > 0) {
+    set_to(s);
+  }
+}
+
+// Gets rid of plurals and -ed or -ing. e.g.
+//   caresses  ->  caress
+//   ponies    ->  poni
+//   cats      ->  cat
+//   agreed    ->  agree
+//   plastered ->  plaster
+//   motoring  ->  motor
+//   hopping   ->  hop
+//   filing    ->  file
+void Stemmer::step1ab() {
+  if (buffer_[k_] == 's') {
+    if (ends("sses")) {
+      k_ -= 2;
+    } else if (ends("ies")) {
+      set_to("i");
+    } else if (buffer_[k_ - 1] != 's') {
+      k_--;
+    }
+  }
+  if (ends("eed")) {
+    if (m() > 0) {
+      k_--;
+    }
+  } else if ((ends("ed") || ends("ing")) && vowel_in_stem()) {
+    k_ = j_;
+    if (ends("at")) {
+      set_to("ate");
+    } else if (ends("bl")) {
+      set_to("ble");
+    } else if (ends("iz")) {
+      set_to("ize");
+    } else if (double_c(k_)) {
+      k_--;
+      char c = buffer_[k_];
+      if (c == 'l' || c == 's' || c == 'z') {
+        k_++;
+      }
+    } else if (m() == 1 && cvc(k_)) {
+      set_to("e");
+    }
+  }
+}
+
+// Turns terminal y to i when there is another vowel in the stem.
+void Stemmer::step1c() {
+  if (ends("y") && vowel_in_stem()) {
+    buffer_[k_] = 'i';
+  }
+}
+
+// Maps double suffices to single ones. so -ization ( = -ize plus
+// -ation) maps to -ize etc. Note that the string before the suffix
+// must give m() > 0.
+void Stemmer::step2() {
+  switch (buffer_[k_ - 1]) {
+    case 'a':
+      if (ends("ational")) {
+        r("ate");
+      } else if (ends("tional")) {
+        r("tion");
+      }
+      break;
+    case 'c':
+      if (ends("enci")) {
+        r("ence");
+      } else if (ends("anci")) {
+        r("ance");
+      }
+      break;
+    case 'e':
+      if (ends("izer")) {
+        r("ize");
+      }
+      break;
+    case 'l':
+      if (ends("bli")) {
+        r("ble");
+      } else if (ends("alli")) {
+        r("al");
+      } else if (ends("entli")) {
+        r("ent");
+      } else if (ends("eli")) {
+        r("e");
+      } else if (ends("ousli")) {
+        r("ous");
+      }
+      break;
+    case 'o':
+      if (ends("ization")) {
+        r("ize");
+      } else if (ends("ation")) {
+        r("ate");
+      } else if (ends("ator")) {
+        r("ate");
+      }
+      break;
+    case 's':
+      if (ends("alism")) {
+        r("al");
+      } else if (ends("iveness")) {
+        r("ive");
+      } else if (ends("fulness")) {
+        r("ful");
+      } else if (ends("ousness")) {
+        r("ous");
+      }
+      break;
+    case 't':
+      if (ends("aliti")) {
+        r("al");
+      } else if (ends("iviti")) {
+        r("ive");
+      } else if (ends("biliti")) {
+        r("ble");
+      }
+      break;
+    case 'g':
+      if (ends("logi")) {
+        r("log");
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// Deals with -ic-, -full, -ness etc. similar strategy to step2.
+void Stemmer::step3() {
+  switch (buffer_[k_]) {
+    case 'e':
+      if (ends("icate")) {
+        r("ic");
+      } else if (ends("ative")) {
+        r("");
+      } else if (ends("alize")) {
+        r("al");
+      }
+      break;
+    case 'i':
+      if (ends("iciti")) {
+        r("ic");
+      }
+      break;
+    case 'l':
+      if (ends("ical")) {
+        r("ic");
+      } else if (ends("ful")) {
+        r("");
+      }
+      break;
+    case 's':
+      if (ends("ness")) {
+        r("");
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// Takes off -ant, -ence etc., in context <c>vcvc<v>.
+void Stemmer::step4() {
+  bool matched = false;
+  switch (buffer_[k_ - 1]) {
+    case 'a':
+      matched = ends("al");
+      break;
+    case 'c':
+      matched = ends("ance") || ends("ence");
+      break;
+    case 'e':
+      matched = ends("er");
+      break;
+    case 'i':
+      matched = ends("ic");
+      break;
+    case 'l':
+      matched = ends("able") || ends("ible");
+      break;
+    case 'n':
+      matched = ends("ant") || ends("ement") || ends("ment") || ends("ent");
+      break;
+    case 'o':
+      if (ends("ion") && j_ >= 0 &&
+          (buffer_[j_] == 's' || buffer_[j_] == 't')) {
+        matched = true;
+      } else {
+        matched = ends("ou");
+      }
+      break;
+    case 's':
+      matched = ends("ism");
+      break;
+    case 't':
+      matched = ends("ate") || ends("iti");
+      break;
+    case 'u':
+      matched = ends("ous");
+      break;
+    case 'v':
+      matched = ends("ive");
+      break;
+    case 'z':
+      matched = ends("ize");
+      break;
+    default:
+      break;
+  }
+
+  if (matched && m() > 1) {
+    k_ = j_;
+  }
+}
+
+// Removes a final -e if m() > 1, and changes -ll to -l if m() > 1.
+void Stemmer::step5() {
+  j_ = k_;
+  if (buffer_[k_] == 'e') {
+    int a = m();
+    if (a > 1 || (a == 1 && !cvc(k_ - 1))) {
+      k_--;
+    }
+  }
+  if (buffer_[k_] == 'l' && double_c(k_) && m() > 1) {
+    k_--;
+  }
+}
@@ -0,0 +1,65 @@
+#ifndef STEMMER_HPP_
+#define STEMMER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+///////////////////////////////////////////////////////////////////////////////
+// A Stemmer reduces English words to their stem using the Porter
+// stemming algorithm (e.g. "connections" -> "connect").
+//
+// Stemming is done in place in a fixed size buffer owned by the Stemmer,
+// so stemming a word never allocates memory. The view returned by stem()
+// refers to that buffer and is only valid until the next call to stem().
+///////////////////////////////////////////////////////////////////////////////
+class Stemmer {
+ public:
+  // Words longer than this are returned unchanged.
+  static constexpr size_t kMaxWordLen = 64;
+
+  Stemmer();
+
+  // Stems the specified word.
+  //
+  // ASCII upper case letters are folded to lower case first. Only words
+  // made up entirely of ASCII letters are stemmed, anything else (numbers,
+  // words with punctuation attached, etc.) is returned case folded but
+  // otherwise unchanged.
+  //
+  // Arguments:
+  // - word: the word to be stemmed
+  //
+  // Returns:
+  // - a view of the stem. The view is invalidated by the next call to
+  //   stem(). If the word is longer than kMaxWordLen, `word` itself
+  //   is returned.
+  std::string_view stem(std::string_view word);
+
+ private:
+  // Helpers that implement the steps of the algorithm.
+  // These follow the structure of Martin Porter's reference implementation:
+  // the word being stemmed is buffer_[0..k_] and j_ marks the end of the
+  // stem once a suffix has been matched by ends().
+  bool cons(int i) const;
+  int m() const;
+  bool vowel_in_stem() const;
+  bool double_c(int i) const;
+  bool cvc(int i) const;
+  bool ends(std::string_view s);
+  void set_to(std::string_view s);
+  void r(std::string_view s);
+
+  void step1ab();
+  void step1c();
+  void step2();
+  void step3();
+  void step4();
+  void step5();
+
+  std::array<char, kMaxWordLen> buffer_;  // The word being stemmed
+  int k_;                                 // Index of the last char of the word
+  int j_;                                 // Index of the last char of the stem
+};
+
+#endif  // STEMMER_HPP_
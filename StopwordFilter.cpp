@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <array>
+
+#include "SimpleFileReader.hpp"
+#include "StopwordFilter.hpp"
+#include "TermHash.hpp"
+
+// The table is built with the "hash, displace" scheme: keys are first
+// hashed into small buckets, then every bucket is assigned a seed such
+// that hashing the bucket's keys with that seed sends each of them to
+// a free slot. Looking a key up takes its bucket's seed and probes the
+// one slot it gives. Everything below is constexpr so that the same code
+// builds the English table at compile time and loaded lists at runtime.
+
+// The built in English stopwords. Must be lower case and unique.
+static constexpr std::array<std::string_view, 179> kEnglishStopwords = {
+    "i",        "me",         "my",       "myself",   "we",
+    "our",      "ours",       "ourselves", "you",     "you're",
+    "you've",   "you'll",     "you'd",    "your",     "yours",
+    "yourself", "yourselves", "he",       "him",      "his",
+    "himself",  "she",        "she's",    "her",      "hers",
+    "herself",  "it",         "it's",     "its",      "itself",
+    "they",     "them",       "their",    "theirs",   "themselves",
+    "what",     "which",      "who",      "whom",     "this",
+    "that",     "that'll",    "these",    "those",    "am",
+    "is",       "are",        "was",      "were",     "be",
+    "been",     "being",      "have",     "has",      "had",
+    "having",   "do",         "does",     "did",      "doing",
+    "a",        "an",         "the",      "and",      "but",
+    "if",       "or",         "because",  "as",       "until",
+    "while",    "of",         "at",       "by",       "for",
+    "with",     "about",      "against",  "between",  "into",
+    "through",  "during",     "before",   "after",    "above",
+    "below",    "to",         "from",     "up",       "down",
+    "in",       "out",        "on",       "off",      "over",
+    "under",    "again",      "further",  "then",     "once",
+    "here",     "there",      "when",     "where",    "why",
+    "how",      "all",        "any",      "both",     "each",
+    "few",      "more",       "most",     "other",    "some",
+    "such",     "no",         "nor",      "not",      "only",
+    "own",      "same",       "so",       "than",     "too",
+    "very",     "s",          "t",        "can",      "will",
+    "just",     "don",        "don't",    "should",   "should've",
+    "now",      "d",          "ll",       "m",        "o",
+    "re",       "ve",         "y",        "ain",      "aren",
+    "aren't",   "couldn",     "couldn't", "didn",     "didn't",
+    "doesn",    "doesn't",    "hadn",     "hadn't",   "hasn",
+    "hasn't",   "haven",      "haven't",  "isn",      "isn't",
+    "ma",       "mightn",     "mightn't", "mustn",    "mustn't",
+    "needn",    "needn't",    "shan",     "shan't",   "shouldn",
+    "shouldn't", "wasn",      "wasn't",   "weren",    "weren't",
+    "won",      "won't",      "wouldn",   "wouldn't",
+};
+
+// The upper bound on the seeds tried for one bucket before giving up
+static constexpr uint32_t kMaxSeed = 1U << 20;
+
+static constexpr size_t bucket_of(uint64_t h, size_t num_buckets) {
+  return mix_hash(h) % num_buckets;
+}
+
+static constexpr size_t slot_of(uint64_t h, uint32_t seed, size_t slot_mask) {
+  return mix_hash(h + seed * 0x9e3779b97f4a7c15ULL) & slot_mask;
+}
+
+// Sizes of a table holding n keys: at most half the slots are used,
+// and buckets hold two keys on average.
+static constexpr size_t num_slots_for(size_t n) {
+  size_t m = 1;
+  while (m < 2 * n) {
+    m *= 2;
+  }
+  return m;
+}
+
+static constexpr size_t num_buckets_for(size_t n) {
+  return n / 2 + 1;
+}
+
+static constexpr size_t scratch_size_for(size_t n) {
+  return 3 * n + num_buckets_for(n);
+}
+
+// Builds a perfect hash table.
+//
+// Arguments:
+// - keys: n unique, non empty keys
+// - slots: num_slots_for(n) empty views to place the keys in
+// - seeds: num_buckets_for(n) seeds to be filled in
+// - scratch: scratch_size_for(n) values of scratch space
+//
+// Returns:
+// - true on success
+// - false if some bucket could not be placed
+static constexpr bool build_table(const std::string_view* keys, size_t n,
+                                  std::string_view* slots, uint32_t* seeds,
+                                  uint64_t* scratch) {
+  size_t slot_mask = num_slots_for(n) - 1;
+  size_t num_buckets = num_buckets_for(n);
+  uint64_t* hashes = scratch;
+  uint64_t* order = scratch + n;
+  uint64_t* pos = scratch + 2 * n;
+  uint64_t* counts = scratch + 3 * n;
+
+  for (size_t b = 0; b < num_buckets; b++) {
+    counts[b] = 0;
+    seeds[b] = 0;
+  }
+  for (size_t i = 0; i < n; i++) {
+    hashes[i] = fnv1a(keys[i]);
+    order[i] = i;
+    counts[bucket_of(hashes[i], num_buckets)]++;
+  }
+
+  // Place the biggest buckets first, while the table is still empty.
+  // Ties are broken on bucket number to keep each bucket's keys together.
+  std::sort(order, order + n, [&](uint64_t a, uint64_t b) {
+    size_t ba = bucket_of(hashes[a], num_buckets);
+    size_t bb = bucket_of(hashes[b], num_buckets);
+    if (counts[ba] != counts[bb]) {
+      return counts[ba] > counts[bb];
+    }
+    return ba < bb;
+  });
+
+  size_t start = 0;
+  while (start < n) {
+    size_t bucket = bucket_of(hashes[order[start]], num_buckets);
+    size_t end = start + 1;
+    while (end < n && bucket_of(hashes[order[end]], num_buckets) == bucket) {
+      end++;
+    }
+
+    // Search for a seed that puts every key of the bucket in a free slot
+    bool placed = false;
+    for (uint32_t seed = 1; seed < kMaxSeed && !placed; seed++) {
+      bool ok = true;
+      for (size_t i = start; i < end && ok; i++) {
+        pos[i] = slot_of(hashes[order[i]], seed, slot_mask);
+        ok = slots[pos[i]].empty();
+        for (size_t j = start; j < i && ok; j++) {
+          ok = pos[j] != pos[i];
+        }
+      }
+
+      if (ok) {
+        seeds[bucket] = seed;
+        for (size_t i = start; i < end; i++) {
+          slots[pos[i]] = keys[order[i]];
+        }
+        placed = true;
+      }
+    }
+
+    if (!placed) {
+      return false;
+    }
+    start = end;
+  }
+  return true;
+}
+
+// A table built at compile time for a fixed list of N keys
+template <size_t N>
+struct StaticTable {
+  std::array<std::string_view, num_slots_for(N)> slots{};
+  std::array<uint32_t, num_buckets_for(N)> seeds{};
+  size_t max_len = 0;
+  bool ok = false;
+};
+
+template <size_t N>
+static constexpr StaticTable<N> make_static_table(
+    const std::array<std::string_view, N>& keys) {
+  StaticTable<N> table;
+  std::array<uint64_t, scratch_size_for(N)> scratch{};
+  table.ok = build_table(keys.data(), N, table.slots.data(),
+                         table.seeds.data(), scratch.data());
+  for (std::string_view key : keys) {
+    table.max_len = std::max(table.max_len, key.length());
+  }
+  return table;
+}
+
+static constexpr auto kEnglishTable = make_static_table(kEnglishStopwords);
+static_assert(kEnglishTable.ok, "no perfect hash for the English stopwords");
+static_assert(kEnglishTable.max_len <= StopwordFilter::kMaxWordLength,
+              "an English stopword is too long");
+
+StopwordFilter::StopwordFilter()
+    : slots_(kEnglishTable.slots.data()),
+      seeds_(kEnglishTable.seeds.data()),
+      slot_mask_(kEnglishTable.slots.size() - 1),
+      num_buckets_(kEnglishTable.seeds.size()),
+      max_len_(kEnglishTable.max_len),
+      size_(kEnglishStopwords.size()) {}
+
+static bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' ||
+         c == '\f';
+}
+
+static char to_lower(char c) {
+  if (c >= 'A' && c <= 'Z') {
+    return static_cast<char>(c - 'A' + 'a');
+  }
+  return c;
+}
+
+bool StopwordFilter::load_file(const std::string& fname) {
+  SimpleFileReader sf(fname);
+  if (!sf.good()) {
+    return false;
+  }
+
+  // Read the whole file, folding case as we go
+  std::vector<char> words;
+  std::optional<std::string> chunk;
+  while ((chunk = sf.get_chars(4096)).has_value()) {
+    for (char c : chunk.value()) {
+      words.push_back(to_lower(c));
+    }
+  }
+
+  // Split it into unique words. The views refer to `words`, whose
+  // buffer is moved into runtime_words_ and so outlives them.
+  std::vector<std::string_view> keys;
+  size_t i = 0;
+  while (i < words.size()) {
+    while (i < words.size() && is_space(words[i])) {
+      i++;
+    }
+    size_t start = i;
+    while (i < words.size() && !is_space(words[i])) {
+      i++;
+    }
+    if (i - start > kMaxWordLength) {
+      // is_stopword folds tokens into a buffer of this size
+      return false;
+    }
+    if (i > start) {
+      keys.emplace_back(words.data() + start, i - start);
+    }
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  size_t n = keys.size();
+  std::vector<std::string_view> slots(num_slots_for(n));
+  std::vector<uint32_t> seeds(num_buckets_for(n));
+  std::vector<uint64_t> scratch(scratch_size_for(n));
+  if (!build_table(keys.data(), n, slots.data(), seeds.data(),
+                   scratch.data())) {
+    // Only possible if two words have the same 64 bit hash
+    return false;
+  }
+
+  runtime_words_ = std::move(words);
+  runtime_slots_ = std::move(slots);
+  runtime_seeds_ = std::move(seeds);
+
+  slots_ = runtime_slots_.data();
+  seeds_ = runtime_seeds_.data();
+  slot_mask_ = runtime_slots_.size() - 1;
+  num_buckets_ = runtime_seeds_.size();
+  max_len_ = 0;
+  for (std::string_view key : keys) {
+    max_len_ = std::max(max_len_, key.length());
+  }
+  size_ = n;
+  return true;
+}
+
+bool StopwordFilter::is_stopword(std::string_view token) const {
+  if (token.empty() || token.length() > max_len_) {
+    return false;
+  }
+
+  // Fold case and hash in one pass. Tokens longer than any
+  // stopword were rejected above, and no stopword is longer
+  // than kMaxWordLength, so this fits on the stack.
+  char folded[kMaxWordLength];
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < token.length(); i++) {
+    folded[i] = to_lower(token[i]);
+    h ^= static_cast<unsigned char>(folded[i]);
+    h *= 1099511628211ULL;
+  }
+
+  uint32_t seed = seeds_[bucket_of(h, num_buckets_)];
+  std::string_view candidate = slots_[slot_of(h, seed, slot_mask_)];
+  return candidate == std::string_view(folded, token.length());
+}
+
+size_t StopwordFilter::size() const {
+  return size_;
+}
@@ -0,0 +1,81 @@
+#ifndef STOPWORDFILTER_HPP_
+#define STOPWORDFILTER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// A StopwordFilter decides whether a token is a stopword: a word like
+// "the" or "of" that is so common it is useless to index.
+//
+// The stopwords are stored in a perfect hash table, so a lookup hashes the
+// token once, probes exactly one slot and compares one string. It never
+// allocates memory. The table for the built in English list is computed
+// at compile time. A list loaded from a file at runtime is put in a table
+// of the same form.
+///////////////////////////////////////////////////////////////////////////////
+class StopwordFilter {
+ public:
+  // The length in bytes of the longest stopword a filter can hold
+  static constexpr size_t kMaxWordLength = 256;
+
+  // Constructor for a StopwordFilter. The filter starts out
+  // with the built in list of English stopwords.
+  StopwordFilter();
+
+  // Replaces the current stopwords with those listed in a file.
+  // Words in the file are separated by white space and are
+  // matched case insensitively. No word may be longer than
+  // kMaxWordLength bytes.
+  //
+  // Arguments:
+  // - fname: The name of the file to be read
+  //
+  // Returns:
+  // - true if the stopwords were loaded
+  // - false if the file could not be opened, a word is longer than
+  //   kMaxWordLength or no table could be built for its words. The
+  //   current stopwords are kept in this case.
+  bool load_file(const std::string& fname);
+
+  // Checks whether a token is a stopword. ASCII letters are
+  // compared case insensitively, so "The" is a stopword.
+  //
+  // Arguments:
+  // - token: the token to check
+  //
+  // Returns:
+  // - true if the token is a stopword
+  // - false otherwise. The empty token is never a stopword.
+  bool is_stopword(std::string_view token) const;
+
+  // Returns the number of stopwords in the filter
+  size_t size() const;
+
+  // Ignore These
+  // The filter may point into its own storage, so it can't be
+  // copied or moved.
+  StopwordFilter(const StopwordFilter& other) = delete;
+  StopwordFilter& operator=(const StopwordFilter& other) = delete;
+  StopwordFilter(StopwordFilter&& other) = delete;
+  StopwordFilter& operator=(StopwordFilter&& other) = delete;
+
+ private:
+  // The table in use. Either the compile time English table
+  // or the runtime_ storage below.
+  const std::string_view* slots_;
+  const uint32_t* seeds_;
+  size_t slot_mask_;    // Number of slots - 1, a power of 2 - 1
+  size_t num_buckets_;  // Number of entries in seeds_
+  size_t max_len_;      // Length of the longest stopword
+  size_t size_;         // Number of stopwords
+
+  // Storage for a list loaded with load_file
+  std::vector<char> runtime_words_;  // Views in runtime_slots_ refer here
+  std::vector<std::string_view> runtime_slots_;
+  std::vector<uint32_t> runtime_seeds_;
+};
+
+#endif  // STOPWORDFILTER_HPP_
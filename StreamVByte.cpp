@@ -0,0 +1,172 @@
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STREAMVBYTE_X86 1
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "StreamVByte.hpp"
+
+// The number of bytes needed to store a value, minus one
+static uint8_t length_code(uint32_t v) {
+  if (v < (1U << 8)) {
+    return 0;
+  }
+  if (v < (1U << 16)) {
+    return 1;
+  }
+  if (v < (1U << 24)) {
+    return 2;
+  }
+  return 3;
+}
+
+// For each control byte, the number of value bytes it covers
+// and the shuffle that spreads those bytes over four 32 bit lanes
+struct DecodeTables {
+  std::array<uint8_t, 256> lengths;
+  std::array<std::array<uint8_t, 16>, 256> shuffles;
+};
+
+static constexpr DecodeTables make_tables() {
+  DecodeTables t{};
+  for (int c = 0; c < 256; c++) {
+    uint8_t pos = 0;
+    for (int lane = 0; lane < 4; lane++) {
+      int len = ((c >> (2 * lane)) & 3) + 1;
+      for (int k = 0; k < 4; k++) {
+        // 0x80 makes the shuffle write a zero byte
+        t.shuffles[c][4 * lane + k] = k < len ? pos++ : 0x80;
+      }
+    }
+    t.lengths[c] = pos;
+  }
+  return t;
+}
+
+static constexpr DecodeTables kTables = make_tables();
+
+void StreamVByte::encode(const uint32_t* in,
+                         size_t n,
+                         std::vector<uint8_t>* out) {
+  size_t control_start = out->size();
+  out->resize(control_start + (n + 3) / 4, 0);
+  for (size_t i = 0; i < n; i++) {
+    uint32_t v = in[i];
+    uint8_t code = length_code(v);
+    (*out)[control_start + i / 4] |= code << (2 * (i % 4));
+    for (int k = 0; k <= code; k++) {
+      out->push_back(static_cast<uint8_t>(v >> (8 * k)));
+    }
+  }
+}
+
+const uint8_t* StreamVByte::decode_scalar(const uint8_t* in,
+                                          size_t n,
+                                          uint32_t* out) {
+  const uint8_t* control = in;
+  const uint8_t* data = in + (n + 3) / 4;
+  for (size_t i = 0; i < n; i++) {
+    int len = ((control[i / 4] >> (2 * (i % 4))) & 3) + 1;
+    uint32_t v = 0;
+    for (int k = 0; k < len; k++) {
+      v |= static_cast<uint32_t>(data[k]) << (8 * k);
+    }
+    out[i] = v;
+    data += len;
+  }
+  return data;
+}
+
+#ifdef STREAMVBYTE_X86
+// Decodes the full groups of four, returns where their data ends.
+// Compiled for SSSE3 on its own, so the rest of the build doesn't
+// need to assume the CPU has it.
+__attribute__((target("ssse3"))) static const uint8_t* decode_groups_ssse3(
+    const uint8_t* control,
+    const uint8_t* data,
+    size_t groups,
+    uint32_t* out) {
+  for (size_t g = 0; g < groups; g++) {
+    uint8_t c = control[g];
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i mask = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(kTables.shuffles[c].data()));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * g),
+                     _mm_shuffle_epi8(bytes, mask));
+    data += kTables.lengths[c];
+  }
+  return data;
+}
+#endif
+
+const uint8_t* StreamVByte::decode(const uint8_t* in, size_t n, uint32_t* out) {
+#ifdef STREAMVBYTE_X86
+  if (has_simd()) {
+    const uint8_t* control = in;
+    const uint8_t* data = in + (n + 3) / 4;
+    size_t groups = n / 4;
+    data = decode_groups_ssse3(control, data, groups, out);
+
+    // The last few values, one at a time
+    for (size_t i = groups * 4; i < n; i++) {
+      int len = ((control[i / 4] >> (2 * (i % 4))) & 3) + 1;
+      uint32_t v = 0;
+      for (int k = 0; k < len; k++) {
+        v |= static_cast<uint32_t>(data[k]) << (8 * k);
+      }
+      out[i] = v;
+      data += len;
+    }
+    return data;
+  }
+#endif
+  return decode_scalar(in, n, out);
+}
+
+void StreamVByte::prefix_sum(uint32_t* values, size_t n, uint32_t base) {
+  size_t i = 0;
+#ifdef __SSE2__
+  // Four at a time: shift and add within the lanes, then
+  // add the last value of the previous four to all of them
+  __m128i prev = _mm_set1_epi32(static_cast<int>(base));
+  for (; i + 4 <= n; i += 4) {
+    __m128i* p = reinterpret_cast<__m128i*>(values + i);
+    __m128i x = _mm_loadu_si128(p);
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi32(x, prev);
+    _mm_storeu_si128(p, x);
+    prev = _mm_shuffle_epi32(x, 0xFF);
+  }
+  if (i > 0) {
+    base = values[i - 1];
+  }
+#endif
+  for (; i < n; i++) {
+    base += values[i];
+    values[i] = base;
+  }
+}
+
+bool StreamVByte::has_simd() {
+#ifdef STREAMVBYTE_X86
+  static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+  return has_ssse3;
+#else
+  return false;
+#endif
+}
+
+size_t StreamVByte::encoded_size(const uint32_t* in, size_t n) {
+  size_t size = (n + 3) / 4;
+  for (size_t i = 0; i < n; i++) {
+    size += length_code(in[i]) + 1;
+  }
+  return size;
+}
@@ -0,0 +1,63 @@
+#ifndef STREAMVBYTE_HPP_
+#define STREAMVBYTE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// StreamVByte compresses arrays of 32 bit integers that are mostly small,
+// such as the gaps between sorted doc ids (Lemire, Kurz and Rupp).
+//
+// Each value is stored in 1 to 4 bytes. The lengths are stored apart from
+// the values, as 2 bit codes packed four to a control byte. Decoding four
+// values then takes one control byte, one 16 byte load and one byte
+// shuffle whose mask is looked up from the control byte. The shuffle
+// needs SSSE3, which is used if the CPU has it; otherwise a scalar
+// decoder is used. Both produce the same result.
+///////////////////////////////////////////////////////////////////////////////
+class StreamVByte {
+ public:
+  // Appends the encoding of `n` values to out: first the
+  // (n + 3) / 4 control bytes, then the value bytes.
+  //
+  // Arguments:
+  // - in: the values to encode
+  // - n: the number of values
+  // - out: the buffer to append to
+  static void encode(const uint32_t* in, size_t n, std::vector<uint8_t>* out);
+
+  // Decodes `n` values. Up to 15 bytes past the end of the encoded
+  // data may be read, so the buffer must be padded.
+  //
+  // Arguments:
+  // - in: the start of the encoding, as written by encode()
+  // - n: the number of values encoded
+  // - out: where to store the values
+  //
+  // Returns:
+  // - a pointer just past the encoding
+  static const uint8_t* decode(const uint8_t* in, size_t n, uint32_t* out);
+
+  // The same as decode(), but never uses SIMD instructions
+  static const uint8_t* decode_scalar(const uint8_t* in,
+                                      size_t n,
+                                      uint32_t* out);
+
+  // Turns gaps back into the values they were taken between:
+  // values[i] becomes base + values[0] + ... + values[i].
+  //
+  // Arguments:
+  // - values: the gaps, replaced by the values
+  // - n: the number of values
+  // - base: the value before values[0]
+  static void prefix_sum(uint32_t* values, size_t n, uint32_t base);
+
+  // Returns whether decode() uses SIMD instructions on this CPU
+  static bool has_simd();
+
+  // Returns the number of bytes the encoding of `n` values takes
+  static size_t encoded_size(const uint32_t* in, size_t n);
+};
+
+#endif  // STREAMVBYTE_HPP_
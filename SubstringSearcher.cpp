@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "SubstringSearcher.hpp"
+
+// Number of bytes read from a SimpleFileReader at a time
+static constexpr size_t kSimpleChunkSize = 64 * 1024;
+
+// Computes the maximal suffix of x under the normal (reverse = false)
+// or reversed alphabet order, as in Crochemore and Perrin's paper.
+// Returns the index before the suffix and sets *period to its period.
+static long max_suffix(const std::string& x, bool reverse, size_t* period) {
+  long m = static_cast<long>(x.length());
+  long ms = -1;
+  long j = 0;
+  long k = 1;
+  long p = 1;
+  while (j + k < m) {
+    unsigned char a = x[j + k];
+    unsigned char b = x[ms + k];
+    if (reverse ? a > b : a < b) {
+      j += k;
+      k = 1;
+      p = j - ms;
+    } else if (a == b) {
+      if (k != p) {
+        k++;
+      } else {
+        j += p;
+        k = 1;
+      }
+    } else {
+      ms = j;
+      j = ms + 1;
+      k = p = 1;
+    }
+  }
+  *period = static_cast<size_t>(p);
+  return ms;
+}
+
+SubstringSearcher::SubstringSearcher(std::string_view needle)
+    : needle_(needle), critical_(-1), period_(1), periodic_(false) {
+  if (needle_.length() <= kTwoWayThreshold) {
+    return;
+  }
+
+  // Critical factorization: the later of the two maximal suffixes
+  size_t p1;
+  size_t p2;
+  long ms1 = max_suffix(needle_, false, &p1);
+  long ms2 = max_suffix(needle_, true, &p2);
+  if (ms1 > ms2) {
+    critical_ = ms1;
+    period_ = p1;
+  } else {
+    critical_ = ms2;
+    period_ = p2;
+  }
+
+  periodic_ = memcmp(needle_.data(), needle_.data() + period_,
+                     critical_ + 1) == 0;
+  if (!periodic_) {
+    long m = static_cast<long>(needle_.length());
+    period_ = std::max(critical_ + 1, m - critical_ - 1) + 1;
+  }
+}
+
+std::vector<off_t> SubstringSearcher::find_all(std::string_view text) const {
+  std::vector<off_t> out;
+  search(text, 0, &out);
+  return out;
+}
+
+std::vector<off_t> SubstringSearcher::find_all(
+    BufferedFileReader& reader) const {
+  return search_chunks(reader.tell(), [&reader]() {
+    return reader.get_chunk();
+  });
+}
+
+std::vector<off_t> SubstringSearcher::find_all(SimpleFileReader& reader) const {
+  std::string chunk;
+  return search_chunks(reader.tell(),
+                       [&reader, &chunk]() -> std::optional<std::string_view> {
+    std::optional<std::string> read = reader.get_chars(kSimpleChunkSize);
+    if (!read.has_value()) {
+      return std::nullopt;
+    }
+    chunk = std::move(read.value());
+    return std::string_view(chunk);
+  });
+}
+
+const std::string& SubstringSearcher::needle() const {
+  return needle_;
+}
+
+template <typename NextChunk>
+std::vector<off_t> SubstringSearcher::search_chunks(
+    off_t start,
+    NextChunk&& next_chunk) const {
+  std::vector<off_t> out;
+  if (needle_.empty() || start < 0) {
+    return out;
+  }
+
+  // `window` is the last needle length - 1 bytes of what we have already
+  // searched, followed by the new chunk. Anything shorter than the needle
+  // can't hold a match by itself, so no match is reported twice.
+  size_t keep = needle_.length() - 1;
+  std::string window;
+  off_t window_offset = start;
+  while (true) {
+    std::optional<std::string_view> chunk = next_chunk();
+    if (!chunk.has_value()) {
+      return out;
+    }
+    window.append(chunk->data(), chunk->length());
+    search(window, window_offset, &out);
+
+    if (window.length() > keep) {
+      window_offset += window.length() - keep;
+      window.erase(0, window.length() - keep);
+    }
+  }
+}
+
+void SubstringSearcher::search(std::string_view text,
+                               off_t base,
+                               std::vector<off_t>* out) const {
+  size_t m = needle_.length();
+  if (m == 0 || text.length() < m) {
+    return;
+  }
+
+  if (m == 1) {
+    const char* start = text.data();
+    const char* end = start + text.length();
+    const char* p = start;
+    while ((p = static_cast<const char*>(memchr(p, needle_[0], end - p))) !=
+           nullptr) {
+      out->push_back(base + (p - start));
+      p++;
+    }
+  } else if (m <= kTwoWayThreshold) {
+    search_filter(text, base, out);
+  } else {
+    search_two_way(text, base, out);
+  }
+}
+
+void SubstringSearcher::search_filter(std::string_view text,
+                                      off_t base,
+                                      std::vector<off_t>* out) const {
+  const char* y = text.data();
+  const char* x = needle_.data();
+  size_t n = text.length();
+  size_t m = needle_.length();
+  size_t i = 0;
+
+#ifdef __SSE2__
+  // Compare the first and last byte of the needle against the
+  // 16 positions starting at i, then check the middle of the needle
+  // only where both matched.
+  __m128i first = _mm_set1_epi8(x[0]);
+  __m128i last = _mm_set1_epi8(x[m - 1]);
+  for (; i + m - 1 + 16 <= n; i += 16) {
+    __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i));
+    __m128i block_last =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i + m - 1));
+    __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                               _mm_cmpeq_epi8(last, block_last));
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(eq));
+    while (mask != 0) {
+      size_t pos = i + __builtin_ctz(mask);
+      if (memcmp(y + pos + 1, x + 1, m - 2) == 0) {
+        out->push_back(base + static_cast<off_t>(pos));
+      }
+      mask &= mask - 1;
+    }
+  }
+#endif
+
+  // The positions too close to the end for a full block
+  for (; i + m <= n; i++) {
+    if (y[i] == x[0] && y[i + m - 1] == x[m - 1] &&
+        memcmp(y + i + 1, x + 1, m - 2) == 0) {
+      out->push_back(base + static_cast<off_t>(i));
+    }
+  }
+}
+
+void SubstringSearcher::search_two_way(std::string_view text,
+                                       off_t base,
+                                       std::vector<off_t>* out) const {
+  const char* y = text.data();
+  const char* x = needle_.data();
+  long n = static_cast<long>(text.length());
+  long m = static_cast<long>(needle_.length());
+  long ell = critical_;
+  long per = static_cast<long>(period_);
+  long j = 0;
+
+  if (periodic_) {
+    // `memory` is how much of the left of the needle is already known
+    // to match after shifting by the period
+    long memory = -1;
+    while (j <= n - m) {
+      long i = std::max(ell, memory) + 1;
+      while (i < m && x[i] == y[i + j]) {
+        i++;
+      }
+      if (i >= m) {
+        i = ell;
+        while (i > memory && x[i] == y[i + j]) {
+          i--;
+        }
+        if (i <= memory) {
+          out->push_back(base + j);
+        }
+        j += per;
+        memory = m - per - 1;
+      } else {
+        j += i - ell;
+        memory = -1;
+      }
+    }
+  } else {
+    while (j <= n - m) {
+      long i = ell + 1;
+      while (i < m && x[i] == y[i + j]) {
+        i++;
+      }
+      if (i >= m) {
+        i = ell;
+        while (i >= 0 && x[i] == y[i + j]) {
+          i--;
+        }
+        if (i < 0) {
+          out->push_back(base + j);
+        }
+        j += per;
+      } else {
+        j += i - ell;
+      }
+    }
+  }
+}
+
+std::vector<off_t> find_all(std::string_view text, std::string_view needle) {
+  return SubstringSearcher(needle).find_all(text);
+}
+
+std::vector<off_t> find_all(BufferedFileReader& reader,
+                            std::string_view needle) {
+  return SubstringSearcher(needle).find_all(reader);
+}
+
+std::vector<off_t> find_all(SimpleFileReader& reader, std::string_view needle) {
+  return SubstringSearcher(needle).find_all(reader);
+}
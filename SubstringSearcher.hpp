@@ -0,0 +1,92 @@
+#ifndef SUBSTRINGSEARCHER_HPP_
+#define SUBSTRINGSEARCHER_HPP_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "BufferedFileReader.hpp"
+#include "SimpleFileReader.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// A SubstringSearcher finds every occurrence of a literal string (the
+// "needle") in a text or a file.
+//
+// Needles up to kTwoWayThreshold bytes long are searched for with an SSE2
+// filter that compares the first and last byte of the needle against 16
+// positions of the text at once, and only checks the rest of the needle
+// where both match. Longer needles use the Two-Way algorithm, which is
+// linear time in the worst case. Searching a file carries the last bytes
+// of each chunk over to the next, so matches that span a buffer refill
+// are found.
+///////////////////////////////////////////////////////////////////////////////
+class SubstringSearcher {
+ public:
+  // Needles longer than this are searched for with Two-Way
+  static constexpr size_t kTwoWayThreshold = 64;
+
+  // Constructor for a SubstringSearcher. Does the precomputation
+  // needed to search for the needle.
+  //
+  // Arguments:
+  // - needle: the string to search for. An empty needle never matches.
+  SubstringSearcher(std::string_view needle);
+
+  // Finds every occurrence of the needle in a text.
+  // Occurrences may overlap.
+  //
+  // Arguments:
+  // - text: the text to search
+  //
+  // Returns:
+  // - the offsets of the occurrences, in increasing order
+  std::vector<off_t> find_all(std::string_view text) const;
+
+  // Finds every occurrence of the needle in the rest of a file.
+  //
+  // Arguments:
+  // - reader: the file to search
+  //
+  // Returns:
+  // - the offsets in the file of the occurrences, in increasing order
+  std::vector<off_t> find_all(BufferedFileReader& reader) const;
+  std::vector<off_t> find_all(SimpleFileReader& reader) const;
+
+  // Returns the needle
+  const std::string& needle() const;
+
+ private:
+  // Helper methods that append the offset of every occurrence of the
+  // needle in text, plus `base`, to out.
+  void search(std::string_view text, off_t base, std::vector<off_t>* out) const;
+  void search_filter(std::string_view text,
+                     off_t base,
+                     std::vector<off_t>* out) const;
+  void search_two_way(std::string_view text,
+                      off_t base,
+                      std::vector<off_t>* out) const;
+
+  // Helper method that searches a file given a function that returns
+  // chunks of it, see the find_all functions.
+  template <typename NextChunk>
+  std::vector<off_t> search_chunks(off_t start, NextChunk&& next_chunk) const;
+
+  std::string needle_;
+
+  // For Two-Way: the critical factorization of the needle
+  // and its period.
+  long critical_;  // Index of the last char of the left half
+  size_t period_;
+  bool periodic_;  // Whether the left half repeats with period_
+};
+
+// Shorthands for searching with a one off SubstringSearcher
+std::vector<off_t> find_all(std::string_view text, std::string_view needle);
+std::vector<off_t> find_all(BufferedFileReader& reader,
+                            std::string_view needle);
+std::vector<off_t> find_all(SimpleFileReader& reader, std::string_view needle);
+
+#endif  // SUBSTRINGSEARCHER_HPP_
@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "BufferedFileWriter.hpp"
+#include "SuffixArray.hpp"
+
+// The index file is a header followed by the suffix array
+// and then the LCP array, each as text_size 32 bit values
+struct IndexHeader {
+  char magic[8];
+  uint64_t text_size;
+};
+
+static constexpr char kMagic[8] = {'S', 'U', 'F', 'A', 'R', 'R', '0', '1'};
+
+// Builds the suffix array of s with SA-IS (Nong, Zhang and Chan).
+// Every value of s is in [0, upper].
+//
+// Suffixes are classified as S (smaller than the next suffix) or L
+// (larger). Sorting the leftmost S suffixes (LMS) is enough to sort the
+// rest by "induction": two passes over the array place the L and then
+// the S suffixes in order. The LMS suffixes are sorted by naming the
+// substrings between them and solving the smaller problem recursively.
+static std::vector<int> sa_is(const std::vector<int>& s, int upper) {
+  int n = static_cast<int>(s.size());
+  if (n == 0) {
+    return {};
+  }
+  if (n == 1) {
+    return {0};
+  }
+  if (n == 2) {
+    if (s[0] < s[1]) {
+      return {0, 1};
+    }
+    return {1, 0};
+  }
+
+  std::vector<int> sa(n);
+  std::vector<bool> is_s(n);  // The last suffix is L
+  for (int i = n - 2; i >= 0; i--) {
+    is_s[i] = (s[i] == s[i + 1]) ? is_s[i + 1] : (s[i] < s[i + 1]);
+  }
+
+  // Bucket boundaries: within the bucket of a symbol, the L suffixes
+  // come before the S suffixes. sum_l[c] is the start of c's L
+  // suffixes and sum_s[c] the start of its S suffixes.
+  std::vector<int> sum_l(upper + 1);
+  std::vector<int> sum_s(upper + 1);
+  for (int i = 0; i < n; i++) {
+    if (!is_s[i]) {
+      sum_s[s[i]]++;
+    } else {
+      sum_l[s[i] + 1]++;
+    }
+  }
+  for (int i = 0; i <= upper; i++) {
+    sum_s[i] += sum_l[i];
+    if (i < upper) {
+      sum_l[i + 1] += sum_s[i];
+    }
+  }
+
+  std::vector<int> buf(upper + 1);
+  auto induce = [&](const std::vector<int>& lms) {
+    std::fill(sa.begin(), sa.end(), -1);
+    std::copy(sum_s.begin(), sum_s.end(), buf.begin());
+    for (int d : lms) {
+      if (d != n) {
+        sa[buf[s[d]]++] = d;
+      }
+    }
+
+    // L suffixes, left to right
+    std::copy(sum_l.begin(), sum_l.end(), buf.begin());
+    sa[buf[s[n - 1]]++] = n - 1;
+    for (int i = 0; i < n; i++) {
+      int v = sa[i];
+      if (v >= 1 && !is_s[v - 1]) {
+        sa[buf[s[v - 1]]++] = v - 1;
+      }
+    }
+
+    // S suffixes, right to left
+    std::copy(sum_l.begin(), sum_l.end(), buf.begin());
+    for (int i = n - 1; i >= 0; i--) {
+      int v = sa[i];
+      if (v >= 1 && is_s[v - 1]) {
+        sa[--buf[s[v - 1] + 1]] = v - 1;
+      }
+    }
+  };
+
+  std::vector<int> lms_map(n + 1, -1);
+  std::vector<int> lms;
+  for (int i = 1; i < n; i++) {
+    if (!is_s[i - 1] && is_s[i]) {
+      lms_map[i] = static_cast<int>(lms.size());
+      lms.push_back(i);
+    }
+  }
+  int m = static_cast<int>(lms.size());
+
+  // Sort the LMS substrings, then the LMS suffixes
+  induce(lms);
+  if (m > 0) {
+    std::vector<int> sorted_lms;
+    sorted_lms.reserve(m);
+    for (int v : sa) {
+      if (lms_map[v] != -1) {
+        sorted_lms.push_back(v);
+      }
+    }
+
+    // Name each LMS substring by its rank among the distinct ones
+    std::vector<int> rec_s(m);
+    int rec_upper = 0;
+    rec_s[lms_map[sorted_lms[0]]] = 0;
+    for (int i = 1; i < m; i++) {
+      int l = sorted_lms[i - 1];
+      int r = sorted_lms[i];
+      int end_l = (lms_map[l] + 1 < m) ? lms[lms_map[l] + 1] : n;
+      int end_r = (lms_map[r] + 1 < m) ? lms[lms_map[r] + 1] : n;
+      bool same = true;
+      if (end_l - l != end_r - r) {
+        same = false;
+      } else {
+        while (l < end_l && s[l] == s[r]) {
+          l++;
+          r++;
+        }
+        if (l == n || s[l] != s[r]) {
+          same = false;
+        }
+      }
+      if (!same) {
+        rec_upper++;
+      }
+      rec_s[lms_map[sorted_lms[i]]] = rec_upper;
+    }
+
+    std::vector<int> rec_sa = sa_is(rec_s, rec_upper);
+    for (int i = 0; i < m; i++) {
+      sorted_lms[i] = lms[rec_sa[i]];
+    }
+    induce(sorted_lms);
+  }
+  return sa;
+}
+
+// Builds the LCP array of text with Kasai's algorithm: going through
+// the suffixes in text order, the common prefix with the previous
+// suffix in sorted order shrinks by at most one each step.
+static std::vector<int> kasai(std::string_view text,
+                              const std::vector<int>& sa) {
+  int n = static_cast<int>(text.length());
+  std::vector<int> rank(n);
+  for (int i = 0; i < n; i++) {
+    rank[sa[i]] = i;
+  }
+
+  std::vector<int> lcp(n, 0);
+  int h = 0;
+  for (int i = 0; i < n; i++) {
+    if (rank[i] == 0) {
+      h = 0;
+      continue;
+    }
+    int j = sa[rank[i] - 1];
+    while (i + h < n && j + h < n && text[i + h] == text[j + h]) {
+      h++;
+    }
+    lcp[rank[i]] = h;
+    if (h > 0) {
+      h--;
+    }
+  }
+  return lcp;
+}
+
+bool SuffixArray::build(const std::string& text_fname,
+                        const std::string& index_fname) {
+  MappedFile text(text_fname);
+  if (!text.good() || text.size() >= static_cast<size_t>(INT_MAX)) {
+    return false;
+  }
+
+  std::string_view contents = text.contents();
+  std::vector<int> sa;
+  {
+    std::vector<int> s(contents.begin(), contents.end());
+    for (int& c : s) {
+      c = static_cast<unsigned char>(c);
+    }
+    sa = sa_is(s, UCHAR_MAX);
+  }
+  std::vector<int> lcp = kasai(contents, sa);
+
+  BufferedFileWriter out(index_fname);
+  if (!out.good()) {
+    return false;
+  }
+  IndexHeader header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.text_size = contents.length();
+
+  // The values are all non negative, so the int arrays
+  // are already in the on disk format
+  out.write(&header, sizeof(header));
+  out.write(sa.data(), sa.size() * sizeof(int));
+  out.write(lcp.data(), lcp.size() * sizeof(int));
+  return out.close_file();
+}
+
+SuffixArray::SuffixArray(const std::string& text_fname,
+                         const std::string& index_fname)
+    : text_(text_fname),
+      index_(index_fname),
+      sa_(nullptr),
+      lcp_(nullptr),
+      size_(0),
+      good_(false) {
+  if (!text_.good() || !index_.good() ||
+      index_.size() < sizeof(IndexHeader)) {
+    return;
+  }
+
+  IndexHeader header;
+  memcpy(&header, index_.contents().data(), sizeof(header));
+  size_t n = text_.size();
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.text_size != n ||
+      index_.size() != sizeof(IndexHeader) + 2 * n * sizeof(uint32_t)) {
+    return;
+  }
+
+  // The header is 16 bytes and the mapping is page aligned,
+  // so the arrays are suitably aligned
+  const char* arrays = index_.contents().data() + sizeof(IndexHeader);
+  sa_ = reinterpret_cast<const uint32_t*>(arrays);
+  lcp_ = sa_ + n;
+  size_ = n;
+  good_ = true;
+}
+
+uint64_t SuffixArray::count(std::string_view pattern) const {
+  auto [first, last] = equal_range(pattern);
+  return last - first;
+}
+
+std::vector<off_t> SuffixArray::locate(std::string_view pattern) const {
+  auto [first, last] = equal_range(pattern);
+  std::vector<off_t> res;
+  res.reserve(last - first);
+  for (size_t rank = first; rank < last; rank++) {
+    res.push_back(sa_[rank]);
+  }
+  std::sort(res.begin(), res.end());
+  return res;
+}
+
+std::string_view SuffixArray::longest_repeat() const {
+  if (!good_ || size_ == 0) {
+    return std::string_view();
+  }
+  size_t best = 0;
+  for (size_t rank = 1; rank < size_; rank++) {
+    if (lcp_[rank] > lcp_[best]) {
+      best = rank;
+    }
+  }
+  return text_.contents().substr(sa_[best], lcp_[best]);
+}
+
+off_t SuffixArray::suffix(size_t rank) const {
+  return sa_[rank];
+}
+
+size_t SuffixArray::lcp(size_t rank) const {
+  return lcp_[rank];
+}
+
+size_t SuffixArray::size() const {
+  return size_;
+}
+
+bool SuffixArray::good() const {
+  return good_;
+}
+
+std::pair<size_t, size_t> SuffixArray::equal_range(
+    std::string_view pattern) const {
+  if (!good_ || pattern.empty()) {
+    return {0, 0};
+  }
+
+  // Compare only the first pattern.length() bytes of each suffix,
+  // so every suffix starting with the pattern compares equal
+  std::string_view text = text_.contents();
+  auto prefix_of = [&](uint32_t suffix) {
+    return text.substr(suffix, pattern.length());
+  };
+  auto suffix_less = [&](uint32_t suffix, std::string_view p) {
+    return prefix_of(suffix) < p;
+  };
+  auto pattern_less = [&](std::string_view p, uint32_t suffix) {
+    return p < prefix_of(suffix);
+  };
+  const uint32_t* first =
+      std::lower_bound(sa_, sa_ + size_, pattern, suffix_less);
+  const uint32_t* last =
+      std::upper_bound(first, sa_ + size_, pattern, pattern_less);
+  return {static_cast<size_t>(first - sa_), static_cast<size_t>(last - sa_)};
+}
@@ -0,0 +1,107 @@
+#ifndef SUFFIXARRAY_HPP_
+#define SUFFIXARRAY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "MappedFile.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// A SuffixArray answers substring queries on one large document without
+// scanning it.
+//
+// The suffix array lists the offsets of every suffix of the document in
+// sorted order, so all occurrences of a pattern are one contiguous range
+// of it, found by binary search in O(m log n) for a pattern of length m.
+// Next to it is the LCP array: the length of the common prefix of each
+// suffix and the one before it in sorted order.
+//
+// Both arrays are built once, in linear time with SA-IS and Kasai's
+// algorithm, and written to an index file. Queries map the document and
+// the index file into memory, so opening an index costs nothing and only
+// the pages a query touches are ever read.
+///////////////////////////////////////////////////////////////////////////////
+class SuffixArray {
+ public:
+  // Builds the index file for a document.
+  //
+  // Arguments:
+  // - text_fname: The name of the document
+  // - index_fname: The name of the index file to write
+  //
+  // Returns:
+  // - true if the index was written
+  // - false if the document could not be read, is 2GB or larger,
+  //   or the index file could not be written
+  static bool build(const std::string& text_fname,
+                    const std::string& index_fname);
+
+  // Constructor for a SuffixArray. Maps a document and the index
+  // file built for it. If either can't be mapped, or the index
+  // does not match the document, good() is false.
+  //
+  // Arguments:
+  // - text_fname: The name of the document
+  // - index_fname: The name of its index file
+  SuffixArray(const std::string& text_fname, const std::string& index_fname);
+
+  // Counts the occurrences of a pattern in the document.
+  //
+  // Arguments:
+  // - pattern: the string to look for. The empty pattern never occurs.
+  //
+  // Returns:
+  // - the number of occurrences, overlapping ones included
+  uint64_t count(std::string_view pattern) const;
+
+  // Finds the occurrences of a pattern in the document.
+  //
+  // Arguments:
+  // - pattern: the string to look for. The empty pattern never occurs.
+  //
+  // Returns:
+  // - the offsets of the occurrences, in increasing order
+  std::vector<off_t> locate(std::string_view pattern) const;
+
+  // Finds the longest string that occurs at least twice in the
+  // document, using the LCP array.
+  //
+  // Returns:
+  // - a view of one occurrence of it in the document.
+  //   Empty if no byte repeats.
+  std::string_view longest_repeat() const;
+
+  // Returns the offset of the suffix with the specified rank
+  // in sorted order. Undefined behaviour if rank >= size().
+  off_t suffix(size_t rank) const;
+
+  // Returns the length of the common prefix of the suffix with the
+  // specified rank and the one before it. 0 for rank 0.
+  // Undefined behaviour if rank >= size().
+  size_t lcp(size_t rank) const;
+
+  // Returns the size of the document, which is the number of suffixes
+  size_t size() const;
+
+  // Returns whether the document and its index are mapped
+  bool good() const;
+
+ private:
+  // Helper method that returns the range [first, last) of ranks
+  // of the suffixes that start with pattern
+  std::pair<size_t, size_t> equal_range(std::string_view pattern) const;
+
+  MappedFile text_;
+  MappedFile index_;
+  const uint32_t* sa_;   // In index_, the suffix array
+  const uint32_t* lcp_;  // In index_, the LCP array
+  size_t size_;
+  bool good_;
+};
+
+#endif  // SUFFIXARRAY_HPP_
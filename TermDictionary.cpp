@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cstring>
+
+#include "TermDictionary.hpp"
+#include "TermHash.hpp"
+
+static constexpr size_t kInitialTableSize = 1024;
+
+// The low bits of a term's hash, which pick its slot in the table
+static uint32_t hash32(std::string_view term) {
+  return static_cast<uint32_t>(hash_term(term));
+}
+
+TermDictionary::TermDictionary() {
+  clear();
+}
+
+uint32_t TermDictionary::intern(std::string_view term) {
+  uint32_t h = hash32(term);
+  size_t slot = probe(term, h);
+  if (table_[slot] != kEmpty) {
+    return table_[slot];
+  }
+
+  // New term: append it to the arena
+  uint32_t id = static_cast<uint32_t>(hashes_.size());
+  arena_.insert(arena_.end(), term.begin(), term.end());
+  starts_.push_back(static_cast<uint32_t>(arena_.size()));
+  hashes_.push_back(h);
+  table_[slot] = id;
+
+  // keep the table at most half full
+  if (hashes_.size() * 2 > table_.size()) {
+    grow();
+  }
+  return id;
+}
+
+std::optional<uint32_t> TermDictionary::find(std::string_view term) const {
+  uint32_t id = table_[probe(term, hash32(term))];
+  if (id == kEmpty) {
+    return std::nullopt;
+  }
+  return id;
+}
+
+std::string_view TermDictionary::term(uint32_t id) const {
+  return std::string_view(arena_.data() + starts_[id],
+                          starts_[id + 1] - starts_[id]);
+}
+
+size_t TermDictionary::size() const {
+  return hashes_.size();
+}
+
+size_t TermDictionary::arena_bytes() const {
+  return arena_.size();
+}
+
+size_t TermDictionary::memory_bytes() const {
+  return arena_.capacity() +
+         (starts_.capacity() + hashes_.capacity() + table_.capacity()) *
+             sizeof(uint32_t);
+}
+
+// Returns the most a vector of `size` and `capacity` can take
+// once `n` more are added, or 0 if it does not move
+static size_t moved_capacity(size_t size, size_t capacity, size_t n) {
+  if (size + n <= capacity) {
+    return 0;
+  }
+  return std::max(size * 2, size + n);
+}
+
+size_t TermDictionary::growth_bytes(size_t term_length) const {
+  size_t bytes = moved_capacity(arena_.size(), arena_.capacity(), term_length);
+  bytes += moved_capacity(starts_.size(), starts_.capacity(), 1) *
+           sizeof(uint32_t);
+  bytes += moved_capacity(hashes_.size(), hashes_.capacity(), 1) *
+           sizeof(uint32_t);
+  if ((hashes_.size() + 1) * 2 > table_.size()) {
+    bytes += table_.size() * 2 * sizeof(uint32_t);
+  }
+  return bytes;
+}
+
+void TermDictionary::clear() {
+  arena_.clear();
+  starts_.assign(1, 0);
+  hashes_.clear();
+  table_.assign(kInitialTableSize, kEmpty);
+}
+
+size_t TermDictionary::probe(std::string_view term, uint32_t hash) const {
+  size_t mask = table_.size() - 1;
+  size_t slot = hash & mask;
+  while (true) {
+    uint32_t id = table_[slot];
+    if (id == kEmpty) {
+      return slot;
+    }
+    // compare the stored hash first so most mismatches
+    // never touch the arena
+    if (hashes_[id] == hash) {
+      size_t len = starts_[id + 1] - starts_[id];
+      if (len == term.length() &&
+          memcmp(arena_.data() + starts_[id], term.data(), len) == 0) {
+        return slot;
+      }
+    }
+    slot = (slot + 1) & mask;
+  }
+}
+
+void TermDictionary::grow() {
+  table_.assign(table_.size() * 2, kEmpty);
+  size_t mask = table_.size() - 1;
+
+  // Every term is distinct, so we only need to find an empty slot
+  for (uint32_t id = 0; id < hashes_.size(); id++) {
+    size_t slot = hashes_[id] & mask;
+    while (table_[slot] != kEmpty) {
+      slot = (slot + 1) & mask;
+    }
+    table_[slot] = id;
+  }
+}
@@ -0,0 +1,93 @@
+#ifndef TERMDICTIONARY_HPP_
+#define TERMDICTIONARY_HPP_
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// A TermDictionary interns terms: it assigns every distinct term a dense
+// id (0, 1, 2, ...) in the order the terms are first seen.
+//
+// The bytes of all terms are stored back to back in one contiguous arena,
+// and the id of a term is found through an open addressing hash table of
+// ids. Later stages can then work on 4 byte ids instead of strings.
+///////////////////////////////////////////////////////////////////////////////
+class TermDictionary {
+ public:
+  // Constructor for an empty TermDictionary.
+  TermDictionary();
+
+  // Returns the id of a term, adding it to the dictionary if
+  // it has not been seen before.
+  //
+  // Arguments:
+  // - term: the term to intern
+  //
+  // Returns:
+  // - the id of the term
+  uint32_t intern(std::string_view term);
+
+  // Looks up the id of a term without adding it.
+  //
+  // Arguments:
+  // - term: the term to look for
+  //
+  // Returns:
+  // - the id of the term
+  // - nullopt if the term is not in the dictionary
+  std::optional<uint32_t> find(std::string_view term) const;
+
+  // Returns the term with the specified id.
+  // Undefined behaviour if the id is not in the dictionary.
+  //
+  // Arguments:
+  // - id: the id of the term
+  //
+  // Returns:
+  // - a view of the term's bytes in the arena. The view is
+  //   invalidated by the next call to intern().
+  std::string_view term(uint32_t id) const;
+
+  // Returns the number of distinct terms in the dictionary
+  size_t size() const;
+
+  // Returns the number of bytes used by the arena
+  size_t arena_bytes() const;
+
+  // Returns the bytes of memory the dictionary holds
+  size_t memory_bytes() const;
+
+  // Returns the most memory that interning a new term can add at once.
+  // A full buffer moves to a bigger one, and the old one is still
+  // alive until the move is done, so this counts the new buffers whole.
+  //
+  // Arguments:
+  // - term_length: the length of the new term
+  //
+  // Returns:
+  // - an upper bound on the bytes added, counting the moves
+  size_t growth_bytes(size_t term_length) const;
+
+  // Removes all terms from the dictionary
+  void clear();
+
+ private:
+  static constexpr uint32_t kEmpty = UINT32_MAX;  // marks an unused slot
+
+  // Helper method that returns the slot holding `term`,
+  // or the empty slot where it would be inserted.
+  size_t probe(std::string_view term, uint32_t hash) const;
+
+  // Helper method that doubles the size of the table
+  void grow();
+
+  std::vector<char> arena_;       // The bytes of every term
+  std::vector<uint32_t> starts_;  // Offset of each term in the arena, plus
+                                  // one extra entry for the end of the last
+  std::vector<uint32_t> hashes_;  // The hash of each term
+  std::vector<uint32_t> table_;   // Ids, or kEmpty. Size is a power of 2
+};
+
+#endif  // TERMDICTIONARY_HPP_
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "MappedFile.hpp"
+#include "TermFreq.hpp"
+
+// The size of the pieces files are split into for counting
+static constexpr size_t kRangeBytes = 256 * 1024;
+
+// A range of one file, [begin, end) in bytes
+struct FileRange {
+  uint32_t file;
+  size_t begin;
+  size_t end;
+};
+
+size_t TermFreqResult::distinct_terms() const {
+  return counts.size();
+}
+
+double TermFreqResult::tokens_per_second() const {
+  if (seconds <= 0) {
+    return 0;
+  }
+  return total_tokens / seconds;
+}
+
+std::vector<std::pair<std::string, uint64_t>> TermFreqResult::top(
+    size_t n) const {
+  std::vector<std::pair<std::string, uint64_t>> terms(counts.begin(),
+                                                      counts.end());
+  auto more_frequent = [](const auto& a, const auto& b) {
+    if (a.second != b.second) {
+      return a.second > b.second;
+    }
+    return a.first < b.first;
+  };
+  n = std::min(n, terms.size());
+  std::partial_sort(terms.begin(), terms.begin() + n, terms.end(),
+                    more_frequent);
+  terms.resize(n);
+  return terms;
+}
+
+TermFreqCounter::TermFreqCounter(size_t num_threads,
+                                 const std::string& delims,
+                                 bool fold_case)
+    : num_threads_(num_threads), delims_(delims), fold_case_(fold_case) {
+  if (num_threads_ == 0) {
+    num_threads_ = std::max(1U, std::thread::hardware_concurrency());
+  }
+}
+
+std::optional<TermFreqResult> TermFreqCounter::count_directory(
+    const std::string& dir) const {
+  std::optional<std::vector<std::string>> files = list_directory(dir);
+  if (!files.has_value()) {
+    return std::nullopt;
+  }
+  return count_files(files.value());
+}
+
+TermFreqResult TermFreqCounter::count_files(
+    const std::vector<std::string>& files) const {
+  auto start = std::chrono::steady_clock::now();
+
+  // Split the files into ranges, so a large file is counted
+  // by every thread rather than by one
+  std::vector<MappedFile> mapped;
+  std::vector<FileRange> ranges;
+  for (const std::string& fname : files) {
+    MappedFile file(fname);
+    if (!file.good()) {
+      continue;
+    }
+    uint32_t f = static_cast<uint32_t>(mapped.size());
+    for (size_t begin = 0; begin < file.size(); begin += kRangeBytes) {
+      ranges.push_back(
+          FileRange{f, begin, std::min(file.size(), begin + kRangeBytes)});
+    }
+    mapped.push_back(std::move(file));
+  }
+
+  // Use no more threads than there are ranges
+  size_t num_threads =
+      std::max<size_t>(1, std::min(num_threads_, ranges.size()));
+  size_t num_parts = num_threads;
+
+  std::array<bool, 256> is_delim{};
+  for (char c : delims_) {
+    is_delim[static_cast<unsigned char>(c)] = true;
+  }
+
+  // partials[t][p] holds thread t's counts for terms in partition p
+  std::vector<std::vector<TermCounts>> partials(
+      num_threads, std::vector<TermCounts>(num_parts));
+  std::vector<uint64_t> tokens(num_threads, 0);
+  std::atomic<size_t> next_range(0);
+
+  auto count = [&](size_t t) {
+    std::vector<TermCounts>& parts = partials[t];
+    std::string folded;
+    TermHash hash;
+    // Counted here and stored once, since the entries
+    // of tokens share cache lines
+    uint64_t num_tokens = 0;
+
+    for (size_t r = next_range++; r < ranges.size(); r = next_range++) {
+      const FileRange& range = ranges[r];
+      std::string_view text = mapped[range.file].contents();
+      auto delim = [&is_delim, text](size_t i) {
+        return is_delim[static_cast<unsigned char>(text[i])];
+      };
+
+      // Skip the end of a token that started in the range before,
+      // and finish the last token even if it runs past the range
+      size_t p = range.begin;
+      if (p > 0 && !delim(p - 1)) {
+        while (p < text.length() && !delim(p)) {
+          p++;
+        }
+      }
+      while (true) {
+        while (p < range.end && delim(p)) {
+          p++;
+        }
+        if (p >= range.end) {
+          break;
+        }
+        size_t token_start = p;
+        while (p < text.length() && !delim(p)) {
+          p++;
+        }
+        std::string_view token = text.substr(token_start, p - token_start);
+        if (fold_case_) {
+          token = fold_token(token, &folded);
+        }
+        num_tokens++;
+
+        TermCounts& part = parts[hash(token) % num_parts];
+        auto it = part.find(token);
+        if (it != part.end()) {
+          it->second++;
+        } else {
+          part.emplace(token, 1);
+        }
+      }
+    }
+    tokens[t] = num_tokens;
+  };
+
+  // Merges partition p of every thread into partition p of thread 0
+  auto merge = [&](size_t p) {
+    TermCounts& dest = partials[0][p];
+    for (size_t t = 1; t < num_threads; t++) {
+      TermCounts& src = partials[t][p];
+      // Moves the nodes of terms that are new to dest,
+      // leaving the terms dest already has in src.
+      dest.merge(src);
+      for (const auto& [term, n] : src) {
+        dest.find(term)->second += n;
+      }
+      TermCounts().swap(src);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; t++) {
+    threads.emplace_back(count, t);
+  }
+  count(0);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  threads.clear();
+  for (size_t p = 1; p < num_parts; p++) {
+    threads.emplace_back(merge, p);
+  }
+  merge(0);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  // The partitions hold disjoint terms, splice them together
+  TermFreqResult result;
+  result.counts = std::move(partials[0][0]);
+  for (size_t p = 1; p < num_parts; p++) {
+    result.counts.merge(partials[0][p]);
+  }
+  result.total_tokens = 0;
+  for (size_t t = 0; t < num_threads; t++) {
+    result.total_tokens += tokens[t];
+  }
+  result.files = mapped.size();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  result.seconds = elapsed.count();
+  return result;
+}
+
+size_t TermFreqCounter::num_threads() const {
+  return num_threads_;
+}
@@ -0,0 +1,91 @@
+#ifndef TERMFREQ_HPP_
+#define TERMFREQ_HPP_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "TermHash.hpp"
+#include "TextUtil.hpp"
+
+using TermCounts = std::unordered_map<std::string, uint64_t, TermHash, TermEqual>;
+
+// The result of counting the terms in a set of files
+struct TermFreqResult {
+  TermCounts counts;      // Number of occurrences of each term
+  uint64_t total_tokens;  // Number of (non empty) tokens read
+  uint64_t files;         // Number of files read
+  double seconds;         // Wall clock time taken
+
+  // Returns the number of distinct terms
+  size_t distinct_terms() const;
+
+  // Returns the rate tokens were counted at
+  double tokens_per_second() const;
+
+  // Returns the `n` most frequent terms, most frequent first.
+  // Ties are broken alphabetically.
+  std::vector<std::pair<std::string, uint64_t>> top(size_t n) const;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// A TermFreqCounter counts how often each term occurs across many files
+// using several threads.
+//
+// Files are mapped and split into ranges of 256KB, which are handed out
+// to the threads one at a time, so a single large file is still counted
+// by every thread. A token that crosses the end of a range is counted by
+// the range it starts in. Each thread counts into its own
+// hash maps, one per partition of the terms, so no locking is needed
+// while counting. At the end thread i merges partition i of every
+// thread's maps, so the merge also runs in parallel.
+///////////////////////////////////////////////////////////////////////////////
+class TermFreqCounter {
+ public:
+  // Constructor for a TermFreqCounter.
+  //
+  // Arguments:
+  // - num_threads: the number of threads to count with. 0 means use
+  //   one per core.
+  // - delims: the delimiters used to split files into tokens
+  // - fold_case: whether to fold ASCII upper case letters to lower
+  //   case, so that "The" and "the" are the same term
+  TermFreqCounter(size_t num_threads = 0,
+                  const std::string& delims = kDefaultDelims,
+                  bool fold_case = true);
+
+  // Counts the terms in every regular file in a directory.
+  // Sub directories are not searched.
+  //
+  // Arguments:
+  // - dir: the name of the directory
+  //
+  // Returns:
+  // - the counts
+  // - nullopt if the directory could not be read
+  std::optional<TermFreqResult> count_directory(const std::string& dir) const;
+
+  // Counts the terms in the specified files. Files that can't
+  // be opened are skipped.
+  //
+  // Arguments:
+  // - files: the names of the files
+  //
+  // Returns:
+  // - the counts
+  TermFreqResult count_files(const std::vector<std::string>& files) const;
+
+  // Returns the number of threads used for counting
+  size_t num_threads() const;
+
+ private:
+  size_t num_threads_;
+  std::string delims_;
+  bool fold_case_;
+};
+
+#endif  // TERMFREQ_HPP_
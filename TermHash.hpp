@@ -0,0 +1,55 @@
+#ifndef TERMHASH_HPP_
+#define TERMHASH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+// The hash functions shared by everything that hashes terms. They are
+// constexpr so tables can be built at compile time with them.
+
+// FNV-1a hash of a term
+constexpr uint64_t fnv1a(std::string_view term) {
+  uint64_t h = 14695981039346656037ULL;
+  for (char c : term) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+// Finalizer from MurmurHash3, spreads the bits of x
+constexpr uint64_t mix_hash(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+// FNV-1a hash of a term with its bits spread by mix_hash, so every bit
+// looks random. Sketches that are merged must hash terms the same way,
+// so they all use this.
+constexpr uint64_t hash_term(std::string_view term) {
+  return mix_hash(fnv1a(term));
+}
+
+// Hash and equality that let maps keyed by std::string be searched
+// with a std::string_view, without building a string.
+struct TermHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view term) const {
+    return std::hash<std::string_view>()(term);
+  }
+};
+
+struct TermEqual {
+  using is_transparent = void;
+  bool operator()(std::string_view a, std::string_view b) const {
+    return a == b;
+  }
+};
+
+#endif  // TERMHASH_HPP_
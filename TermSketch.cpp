@@ -0,0 +1,56 @@
+#include "TermSketch.hpp"
+
+TermSketch::TermSketch(size_t top_k,
+                       size_t cm_width,
+                       size_t cm_depth,
+                       int hll_precision)
+    : top_terms_(top_k),
+      counts_(cm_width, cm_depth),
+      distinct_(hll_precision) {}
+
+void TermSketch::add(std::string_view term) {
+  top_terms_.add(term);
+  counts_.add(term);
+  distinct_.add(term);
+}
+
+uint64_t TermSketch::add_tokens(BufferedFileReader& reader,
+                                const std::string& delims) {
+  uint64_t count = 0;
+  reader.for_each_token(delims, [this, &count](std::string_view token) {
+    if (!token.empty()) {
+      add(token);
+      count++;
+    }
+  });
+  return count;
+}
+
+bool TermSketch::merge(const TermSketch& other) {
+  // Check everything first so a failed merge changes nothing
+  if (counts_.width() != other.counts_.width() ||
+      counts_.depth() != other.counts_.depth() ||
+      distinct_.precision() != other.distinct_.precision()) {
+    return false;
+  }
+  top_terms_.merge(other.top_terms_);
+  counts_.merge(other.counts_);
+  distinct_.merge(other.distinct_);
+  return true;
+}
+
+uint64_t TermSketch::total() const {
+  return counts_.total();
+}
+
+const SpaceSaving& TermSketch::top_terms() const {
+  return top_terms_;
+}
+
+const CountMinSketch& TermSketch::counts() const {
+  return counts_;
+}
+
+const HyperLogLog& TermSketch::distinct() const {
+  return distinct_;
+}
@@ -0,0 +1,71 @@
+#ifndef TERMSKETCH_HPP_
+#define TERMSKETCH_HPP_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "BufferedFileReader.hpp"
+#include "CountMinSketch.hpp"
+#include "HyperLogLog.hpp"
+#include "SpaceSaving.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// A TermSketch keeps streaming statistics about the terms of a corpus in
+// memory that doesn't grow with the corpus: the top terms (SpaceSaving),
+// the approximate count of any term (CountMinSketch) and the approximate
+// number of distinct terms (HyperLogLog).
+//
+// Sketches of different files, or built by different threads, can be
+// merged into the sketch of everything they saw.
+///////////////////////////////////////////////////////////////////////////////
+class TermSketch {
+ public:
+  // Constructor for an empty TermSketch.
+  //
+  // Arguments:
+  // - top_k: the number of counters for the top terms
+  // - cm_width, cm_depth: the dimensions of the count min sketch
+  // - hll_precision: log2 of the number of HyperLogLog registers
+  TermSketch(size_t top_k = 1024,
+             size_t cm_width = 4096,
+             size_t cm_depth = 4,
+             int hll_precision = 14);
+
+  // Adds one occurrence of a term to every sketch
+  void add(std::string_view term);
+
+  // Adds every (non empty) token in the rest of a file.
+  //
+  // Arguments:
+  // - reader: the file to read
+  // - delims: the characters that separate tokens
+  //
+  // Returns:
+  // - the number of tokens added
+  uint64_t add_tokens(BufferedFileReader& reader,
+                      const std::string& delims = " \t\n\r\v\f");
+
+  // Merges another TermSketch into this one.
+  //
+  // Returns:
+  // - true if the sketches were merged
+  // - false if their dimensions differ, in which case this
+  //   sketch is unchanged
+  bool merge(const TermSketch& other);
+
+  // Returns the number of terms added
+  uint64_t total() const;
+
+  // Returns the individual sketches
+  const SpaceSaving& top_terms() const;
+  const CountMinSketch& counts() const;
+  const HyperLogLog& distinct() const;
+
+ private:
+  SpaceSaving top_terms_;
+  CountMinSketch counts_;
+  HyperLogLog distinct_;
+};
+
+#endif  // TERMSKETCH_HPP_
@@ -0,0 +1,201 @@
+#include <cstring>
+
+#include "ByteIO.hpp"
+#include "TermTrie.hpp"
+
+TermTrie::TermTrie(const std::string& fname)
+    : file_(fname), base_(nullptr), good_(false) {
+  memset(&footer_, 0, sizeof(footer_));
+  size_t size = file_.size();
+  if (!file_.good() || size < sizeof(Header) + sizeof(Footer)) {
+    return;
+  }
+  base_ = reinterpret_cast<const uint8_t*>(file_.contents().data());
+
+  Header header = ByteIO::load<Header>(base_);
+  Footer footer = ByteIO::load<Footer>(base_ + size - sizeof(Footer));
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion ||
+      memcmp(footer.magic, kMagic, sizeof(kMagic)) != 0 ||
+      footer.root_offset < sizeof(Header) ||
+      footer.root_offset >= size - sizeof(Footer)) {
+    return;
+  }
+  footer_ = footer;
+  good_ = true;
+}
+
+bool TermTrie::good() const {
+  return good_;
+}
+
+std::optional<uint64_t> TermTrie::find(std::string_view term) const {
+  if (!good_) {
+    return std::nullopt;
+  }
+  size_t offset = footer_.root_offset;
+  size_t matched = 0;
+  while (true) {
+    Node node = read_node(offset);
+    if (matched == term.size()) {
+      if (!node.has_value) {
+        return std::nullopt;
+      }
+      return node.value;
+    }
+
+    // The labels of the children start with different
+    // bytes, in order, so at most one can match
+    const uint8_t* p = node.children;
+    bool found = false;
+    for (size_t i = 0; i < node.num_children && !found; i++) {
+      Edge edge = read_edge(p, offset);
+      p = edge.end;
+      auto first = static_cast<unsigned char>(edge.label[0]);
+      auto want = static_cast<unsigned char>(term[matched]);
+      if (first > want) {
+        return std::nullopt;
+      }
+      if (first == want) {
+        if (!term.substr(matched).starts_with(edge.label)) {
+          return std::nullopt;
+        }
+        matched += edge.label.size();
+        offset = edge.offset;
+        found = true;
+      }
+    }
+    if (!found) {
+      return std::nullopt;
+    }
+  }
+}
+
+TermTrie::Iterator TermTrie::seek(std::string_view term) const {
+  return Iterator(this, term);
+}
+
+size_t TermTrie::num_terms() const {
+  return footer_.num_terms;
+}
+
+size_t TermTrie::file_bytes() const {
+  return file_.size();
+}
+
+TermTrie::Node TermTrie::read_node(size_t offset) const {
+  Node node;
+  uint64_t header;
+  const uint8_t* p = ByteIO::get_varint(base_ + offset, &header);
+  node.has_value = (header & 1) != 0;
+  node.value = 0;
+  if (node.has_value) {
+    p = ByteIO::get_varint(p, &node.value);
+  }
+  node.num_children = header >> 1;
+  node.children = p;
+  return node;
+}
+
+TermTrie::Edge TermTrie::read_edge(const uint8_t* p, size_t offset) {
+  Edge edge;
+  uint64_t len;
+  uint64_t distance;
+  p = ByteIO::get_varint(p, &len);
+  edge.label = std::string_view(reinterpret_cast<const char*>(p), len);
+  p = ByteIO::get_varint(p + len, &distance);
+  edge.offset = offset - distance;
+  edge.end = p;
+  return edge;
+}
+
+TermTrie::Iterator::Iterator(const TermTrie* trie, std::string_view term)
+    : trie_(trie), value_(0), valid_(false) {
+  if (!trie_->good_) {
+    return;
+  }
+
+  // Follow term down from the root as far as it goes. Every child
+  // passed on the way only has terms less than it.
+  size_t matched = 0;
+  if (enter(trie_->footer_.root_offset) && term.empty()) {
+    return;
+  }
+  while (matched < term.size()) {
+    Frame& frame = path_.back();
+    std::string_view rest = term.substr(matched);
+    bool descended = false;
+    while (frame.remaining > 0) {
+      Edge edge = read_edge(frame.next_child, frame.offset);
+      if (rest.starts_with(edge.label)) {
+        frame.next_child = edge.end;
+        frame.remaining--;
+        term_.append(edge.label);
+        matched += edge.label.size();
+        descended = true;
+        if (enter(edge.offset) && matched == term.size()) {
+          return;
+        }
+        break;
+      }
+      if (edge.label > rest) {
+        // this child and everything after it is past term
+        break;
+      }
+      frame.next_child = edge.end;
+      frame.remaining--;
+    }
+    if (!descended) {
+      break;
+    }
+  }
+  advance();
+}
+
+bool TermTrie::Iterator::valid() const {
+  return valid_;
+}
+
+void TermTrie::Iterator::next() {
+  if (valid_) {
+    advance();
+  }
+}
+
+std::string_view TermTrie::Iterator::term() const {
+  return term_;
+}
+
+uint64_t TermTrie::Iterator::value() const {
+  return value_;
+}
+
+bool TermTrie::Iterator::enter(size_t offset) {
+  Node node = trie_->read_node(offset);
+  path_.push_back(Frame{node.children, node.num_children, offset,
+                        term_.size()});
+  valid_ = node.has_value;
+  value_ = node.value;
+  return node.has_value;
+}
+
+void TermTrie::Iterator::advance() {
+  // A node's own term comes before those of its children,
+  // and the children are in order of label
+  while (!path_.empty()) {
+    Frame& frame = path_.back();
+    if (frame.remaining == 0) {
+      path_.pop_back();
+      continue;
+    }
+    Edge edge = read_edge(frame.next_child, frame.offset);
+    frame.next_child = edge.end;
+    frame.remaining--;
+    term_.resize(frame.depth);
+    term_.append(edge.label);
+    if (enter(edge.offset)) {
+      return;
+    }
+  }
+  valid_ = false;
+}
@@ -0,0 +1,192 @@
+#ifndef TERMTRIE_HPP_
+#define TERMTRIE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// A TermTrie is a term dictionary that maps each term to a 64 bit value,
+// such as the offset of its postings, read straight out of a mapped file.
+//
+// The terms are stored as a trie with path compression: an edge holds
+// the whole string a run of nodes with one child and no value would
+// spell, so there is one node per term or branch. Shared prefixes are
+// stored once, and nothing is loaded when the trie is opened. Besides
+// exact lookup, the terms can be walked in sorted order from any point,
+// which gives prefix and range queries.
+//
+// Nodes are written by a TermTrieBuilder children first, so the file is
+// written front to back in one pass over the sorted terms. Each node is:
+// - a varint: the number of children times 2, plus 1 if it has a value
+// - the value, as a varint, if it has one
+// - for each child, in order of label: the length of the label of the
+//   edge to it as a varint, the label, and how far back the child
+//   starts from this node as a varint
+// The root is the last node, and a footer holds its offset.
+///////////////////////////////////////////////////////////////////////////////
+class TermTrie {
+ public:
+  // Constructor for a TermTrie. Maps the file.
+  // If the file can't be mapped or is not a trie, good() is false.
+  //
+  // Arguments:
+  // - fname: The name of the trie file
+  TermTrie(const std::string& fname);
+
+  // Returns whether the trie was opened
+  bool good() const;
+
+  // Looks up a term.
+  //
+  // Arguments:
+  // - term: the term to look for
+  //
+  // Returns:
+  // - the value of the term
+  // - nullopt if the term is not in the trie
+  std::optional<uint64_t> find(std::string_view term) const;
+
+  // Walks the terms of a trie in sorted order
+  class Iterator;
+
+  // Returns an iterator at the first term that is not less than `term`,
+  // valid while the trie is open
+  Iterator seek(std::string_view term) const;
+
+  // Calls f(std::string_view term, uint64_t value) for every term that
+  // starts with prefix, in sorted order
+  template <typename F>
+  void for_each_prefix(std::string_view prefix, F&& f) const;
+
+  // Calls f(std::string_view term, uint64_t value) for every term
+  // in [first, last), in sorted order
+  template <typename F>
+  void for_each_range(std::string_view first,
+                      std::string_view last,
+                      F&& f) const;
+
+  // Returns the number of terms
+  size_t num_terms() const;
+
+  // Returns the size of the trie file in bytes
+  size_t file_bytes() const;
+
+ private:
+  friend class TermTrieBuilder;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t reserved[2];
+  };
+
+  struct Footer {
+    uint64_t root_offset;
+    uint64_t num_terms;
+    char magic[8];
+  };
+
+  // A node, decoded up to its children
+  struct Node {
+    bool has_value;
+    uint64_t value;
+    size_t num_children;
+    const uint8_t* children;  // The first child entry
+  };
+
+  // A child entry of a node
+  struct Edge {
+    std::string_view label;
+    size_t offset;       // Of the child
+    const uint8_t* end;  // The next entry
+  };
+
+  static constexpr char kMagic[8] = {'T', 'E', 'R', 'M', 'T', 'R', 'I', 'E'};
+  static constexpr uint32_t kVersion = 1;
+
+  // Helper method that decodes the node at offset
+  Node read_node(size_t offset) const;
+
+  // Helper method that decodes the child entry at p
+  // of the node at offset
+  static Edge read_edge(const uint8_t* p, size_t offset);
+
+  MappedFile file_;
+  const uint8_t* base_;
+  Footer footer_;
+  bool good_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// A TermTrie::Iterator walks the terms of a TermTrie in sorted order. It
+// keeps the path from the root to the current node, each node with the
+// next of its children to visit.
+///////////////////////////////////////////////////////////////////////////////
+class TermTrie::Iterator {
+ public:
+  // Returns whether the iterator is at a term
+  bool valid() const;
+
+  // Moves to the next term
+  void next();
+
+  // Returns the current term, valid until next()
+  std::string_view term() const;
+
+  // Returns the value of the current term
+  uint64_t value() const;
+
+ private:
+  friend class TermTrie;
+
+  // A node on the path to the current term
+  struct Frame {
+    const uint8_t* next_child;  // The entry of the next child to visit
+    size_t remaining;           // The number of children left to visit
+    size_t offset;              // Of the node
+    size_t depth;               // The length of the node's term
+  };
+
+  // Constructor for an iterator positioned at the first term >= term
+  Iterator(const TermTrie* trie, std::string_view term);
+
+  // Helper method that pushes the node at offset onto the path.
+  // Returns whether it has a value, which it makes current if so.
+  bool enter(size_t offset);
+
+  // Helper method that moves to the next node with a value,
+  // in sorted order, below and after the current one
+  void advance();
+
+  const TermTrie* trie_;
+  std::vector<Frame> path_;
+  std::string term_;
+  uint64_t value_;
+  bool valid_;
+};
+
+template <typename F>
+void TermTrie::for_each_prefix(std::string_view prefix, F&& f) const {
+  for (Iterator it = seek(prefix);
+       it.valid() && it.term().starts_with(prefix); it.next()) {
+    f(it.term(), it.value());
+  }
+}
+
+template <typename F>
+void TermTrie::for_each_range(std::string_view first,
+                              std::string_view last,
+                              F&& f) const {
+  for (Iterator it = seek(first); it.valid() && it.term() < last; it.next()) {
+    f(it.term(), it.value());
+  }
+}
+
+#endif  // TERMTRIE_HPP_
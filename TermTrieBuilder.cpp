@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cstring>
+
+#include "TermTrieBuilder.hpp"
+
+TermTrieBuilder::TermTrieBuilder(const std::string& fname)
+    : out_(fname), finished_(false), num_terms_(0) {
+  TermTrie::Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, TermTrie::kMagic, sizeof(header.magic));
+  header.version = TermTrie::kVersion;
+  out_.write(&header, sizeof(header));
+  path_.push_back(PendingNode{false, 0, {}});
+}
+
+bool TermTrieBuilder::good() const {
+  return out_.good();
+}
+
+bool TermTrieBuilder::add(std::string_view term, uint64_t value) {
+  if (finished_ || !out_.good() || (num_terms_ > 0 && term <= last_term_)) {
+    return false;
+  }
+
+  // The nodes past where term leaves the path are done
+  size_t common = 0;
+  size_t max = std::min(term.size(), last_term_.size());
+  while (common < max && term[common] == last_term_[common]) {
+    common++;
+  }
+  while (path_.size() > common + 1) {
+    pop_node();
+  }
+
+  // and term's own nodes take their place, one per byte
+  last_term_.assign(term);
+  while (path_.size() < term.size() + 1) {
+    path_.push_back(PendingNode{false, 0, {}});
+  }
+  path_.back().has_value = true;
+  path_.back().value = value;
+  num_terms_++;
+  return out_.good();
+}
+
+bool TermTrieBuilder::finish() {
+  if (finished_) {
+    return false;
+  }
+  finished_ = true;
+  while (path_.size() > 1) {
+    pop_node();
+  }
+
+  // The root is always written, so the footer can point at it
+  TermTrie::Footer footer;
+  footer.root_offset = write_node(path_[0]);
+  footer.num_terms = num_terms_;
+  memcpy(footer.magic, TermTrie::kMagic, sizeof(footer.magic));
+  out_.write(&footer, sizeof(footer));
+  return out_.close_file();
+}
+
+void TermTrieBuilder::pop_node() {
+  PendingNode& node = path_.back();
+  char byte = last_term_[path_.size() - 2];
+  Edge edge;
+  if (!node.has_value && node.children.size() == 1) {
+    edge.label = byte + node.children[0].label;
+    edge.offset = node.children[0].offset;
+  } else {
+    edge.label.assign(1, byte);
+    edge.offset = write_node(node);
+  }
+  path_.pop_back();
+  path_.back().children.push_back(std::move(edge));
+}
+
+uint64_t TermTrieBuilder::write_node(const PendingNode& node) {
+  // The children were written before, so the distance back is known
+  uint64_t offset = out_.tell();
+  out_.write_varint(node.children.size() * 2 + (node.has_value ? 1 : 0));
+  if (node.has_value) {
+    out_.write_varint(node.value);
+  }
+  for (const Edge& edge : node.children) {
+    out_.write_varint(edge.label.size());
+    out_.write(edge.label);
+    out_.write_varint(offset - edge.offset);
+  }
+  return offset;
+}
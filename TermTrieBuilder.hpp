@@ -0,0 +1,86 @@
+#ifndef TERMTRIEBUILDER_HPP_
+#define TERMTRIEBUILDER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BufferedFileWriter.hpp"
+#include "TermTrie.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// A TermTrieBuilder writes a TermTrie file from terms added in sorted
+// order.
+//
+// Only the path to the last term added is held in memory. When the next
+// term leaves that path, the nodes below where it leaves can have no more
+// children, so they are written out. A node with one child and no value
+// is not written at all: its label is put in front of its child's.
+///////////////////////////////////////////////////////////////////////////////
+class TermTrieBuilder {
+ public:
+  // Constructor for a TermTrieBuilder. Creates the file,
+  // truncating it if it exists. If it can't be created, good() is false.
+  //
+  // Arguments:
+  // - fname: the name of the trie file
+  TermTrieBuilder(const std::string& fname);
+
+  // Returns whether everything so far has been written
+  bool good() const;
+
+  // Adds the next term. Terms must be added in strictly increasing order.
+  //
+  // Arguments:
+  // - term: the term
+  // - value: its value
+  //
+  // Returns:
+  // - true if the term was added
+  // - false if the term is out of order or writing failed
+  bool add(std::string_view term, uint64_t value);
+
+  // Writes the rest of the nodes and the footer and
+  // closes the file. Nothing can be added after.
+  //
+  // Returns:
+  // - true if the trie was written, false otherwise
+  bool finish();
+
+  // Ignore These
+  // This is disabling the copy constructor and the assignment operator.
+  TermTrieBuilder(const TermTrieBuilder& other) = delete;
+  TermTrieBuilder& operator=(const TermTrieBuilder& other) = delete;
+
+ private:
+  // An edge to a node that has been written
+  struct Edge {
+    std::string label;
+    uint64_t offset;
+  };
+
+  // A node on the path to the last term, which may still get children.
+  // The node at depth d is reached from its parent by last_term_[d - 1].
+  struct PendingNode {
+    bool has_value;
+    uint64_t value;
+    std::vector<Edge> children;
+  };
+
+  // Helper method that writes out the deepest pending node, or merges it
+  // into its only child, and adds the edge to it to its parent
+  void pop_node();
+
+  // Helper method that writes a node and returns its offset
+  uint64_t write_node(const PendingNode& node);
+
+  BufferedFileWriter out_;
+  bool finished_;
+  std::vector<PendingNode> path_;  // From the root
+  std::string last_term_;
+  uint64_t num_terms_;
+};
+
+#endif  // TERMTRIEBUILDER_HPP_
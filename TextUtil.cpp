@@ -0,0 +1,31 @@
+#include <algorithm>
+#include <filesystem>
+
+#include "TextUtil.hpp"
+
+std::optional<std::vector<std::string>> list_directory(const std::string& dir) {
+  std::error_code ec;
+  std::filesystem::directory_iterator it(dir, ec);
+  if (ec) {
+    return std::nullopt;
+  }
+
+  std::vector<std::string> files;
+  for (const auto& entry : it) {
+    if (entry.is_regular_file(ec)) {
+      files.push_back(entry.path().string());
+    }
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+std::string_view fold_token(std::string_view token, std::string* scratch) {
+  scratch->assign(token);
+  for (char& c : *scratch) {
+    if (c >= 'A' && c <= 'Z') {
+      c = static_cast<char>(c - 'A' + 'a');
+    }
+  }
+  return *scratch;
+}
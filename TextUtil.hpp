@@ -0,0 +1,38 @@
+#ifndef TEXTUTIL_HPP_
+#define TEXTUTIL_HPP_
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Helpers shared by everything that reads a directory of text files
+// and splits it into terms.
+
+// Delimiters used when none are specified: white space and
+// common punctuation.
+inline constexpr const char* kDefaultDelims =
+    " \t\n\r\v\f.,;:!?\"()[]{}<>*_/\\|#=+~`";
+
+// Lists the regular files in a directory, in order of file name.
+// Sub directories are not searched.
+//
+// Arguments:
+// - dir: the name of the directory
+//
+// Returns:
+// - the names of the files
+// - nullopt if the directory could not be read
+std::optional<std::vector<std::string>> list_directory(const std::string& dir);
+
+// Folds the ASCII upper case letters of a token to lower case.
+//
+// Arguments:
+// - token: the token to fold
+// - scratch: where the folded token is stored
+//
+// Returns:
+// - a view of the folded token in scratch
+std::string_view fold_token(std::string_view token, std::string* scratch);
+
+#endif  // TEXTUTIL_HPP_
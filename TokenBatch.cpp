@@ -0,0 +1,31 @@
+#include "TokenBatch.hpp"
+
+size_t TokenBatch::size() const {
+  return offsets_.size();
+}
+
+bool TokenBatch::empty() const {
+  return offsets_.empty();
+}
+
+std::string_view TokenBatch::operator[](size_t i) const {
+  return std::string_view(bytes_.data() + offsets_[i], lengths_[i]);
+}
+
+const char* TokenBatch::bytes() const {
+  return bytes_.data();
+}
+
+const uint32_t* TokenBatch::offsets() const {
+  return offsets_.data();
+}
+
+const uint32_t* TokenBatch::lengths() const {
+  return lengths_.data();
+}
+
+void TokenBatch::clear() {
+  bytes_.clear();
+  offsets_.clear();
+  lengths_.clear();
+}
@@ -0,0 +1,50 @@
+#ifndef TOKENBATCH_HPP_
+#define TOKENBATCH_HPP_
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// A TokenBatch holds a batch of tokens read by
+// BufferedFileReader::get_tokens.
+//
+// The batch is a structure of arrays: the bytes read from the file are
+// kept in one contiguous block, and token i is the lengths()[i] bytes
+// starting at bytes()[offsets()[i]]. The block may also hold the
+// delimiters between tokens. A batch can be reused for many calls to
+// get_tokens, its memory is kept between them.
+///////////////////////////////////////////////////////////////////////////////
+class TokenBatch {
+ public:
+  TokenBatch() = default;
+
+  // Returns the number of tokens in the batch
+  size_t size() const;
+
+  // Returns whether the batch holds no tokens
+  bool empty() const;
+
+  // Returns the i'th token in the batch.
+  // Undefined behaviour if i >= size().
+  std::string_view operator[](size_t i) const;
+
+  // Access to the underlying arrays, for stages that
+  // process a whole batch at once.
+  const char* bytes() const;
+  const uint32_t* offsets() const;
+  const uint32_t* lengths() const;
+
+  // Removes all tokens from the batch
+  void clear();
+
+  // This is necessary so that the reader can fill the batch
+  friend class BufferedFileReader;
+
+ private:
+  std::vector<char> bytes_;        // The block of bytes read
+  std::vector<uint32_t> offsets_;  // Start of each token in bytes_
+  std::vector<uint32_t> lengths_;  // Length of each token
+};
+
+#endif  // TOKENBATCH_HPP_
@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <iterator>
+
+#include "BufferedFileReader.hpp"
+#include "SubstringSearcher.hpp"
+#include "TextUtil.hpp"
+#include "TrigramIndex.hpp"
+
+// Packs the trigram ending with byte c onto the previous two bytes
+static uint32_t push_byte(uint32_t trigram, char c) {
+  return ((trigram << 8) | static_cast<unsigned char>(c)) & 0xFFFFFF;
+}
+
+static uint64_t posting(uint32_t file, uint32_t block) {
+  return (static_cast<uint64_t>(file) << 32) | block;
+}
+
+TrigramIndex::TrigramIndex(size_t block_size)
+    : block_size_(std::max<size_t>(1, block_size)), num_postings_(0) {}
+
+std::optional<uint32_t> TrigramIndex::add_file(const std::string& fname) {
+  BufferedFileReader bf(fname);
+  if (!bf.good()) {
+    return std::nullopt;
+  }
+  uint32_t id = static_cast<uint32_t>(files_.size());
+
+  // Collect the distinct trigrams of one block at a time. A trigram
+  // belongs to the block it starts in, even if it ends in the next.
+  std::vector<uint32_t> block_trigrams;
+  uint32_t block = 0;
+  auto flush = [&]() {
+    std::sort(block_trigrams.begin(), block_trigrams.end());
+    block_trigrams.erase(
+        std::unique(block_trigrams.begin(), block_trigrams.end()),
+        block_trigrams.end());
+    for (uint32_t trigram : block_trigrams) {
+      postings_[trigram].push_back(posting(id, block));
+    }
+    num_postings_ += block_trigrams.size();
+    block_trigrams.clear();
+  };
+
+  uint32_t trigram = 0;
+  off_t pos = 0;
+  std::optional<std::string_view> chunk;
+  while ((chunk = bf.get_chunk()).has_value()) {
+    for (char c : chunk.value()) {
+      trigram = push_byte(trigram, c);
+      if (pos >= 2) {
+        uint32_t start_block = static_cast<uint32_t>((pos - 2) / block_size_);
+        if (start_block != block) {
+          flush();
+          block = start_block;
+        }
+        block_trigrams.push_back(trigram);
+      }
+      pos++;
+    }
+  }
+  flush();
+
+  files_.push_back(fname);
+  file_sizes_.push_back(pos);
+  return id;
+}
+
+bool TrigramIndex::add_directory(const std::string& dir) {
+  std::optional<std::vector<std::string>> files = list_directory(dir);
+  if (!files.has_value()) {
+    return false;
+  }
+  for (const std::string& fname : files.value()) {
+    add_file(fname);
+  }
+  return true;
+}
+
+std::vector<uint32_t> TrigramIndex::candidate_files(
+    const std::vector<std::string_view>& literals) const {
+  std::vector<std::vector<uint32_t>> trigrams;
+  for (std::string_view literal : literals) {
+    trigrams.push_back(trigrams_of(literal));
+  }
+
+  std::vector<uint32_t> res;
+  for (uint32_t file = 0; file < files_.size(); file++) {
+    bool candidate = true;
+    for (size_t i = 0; i < literals.size() && candidate; i++) {
+      std::optional<std::vector<uint32_t>> blocks =
+          candidate_blocks(trigrams[i], literals[i].length(), file);
+      candidate = !blocks.has_value() || !blocks->empty();
+    }
+    if (candidate) {
+      res.push_back(file);
+    }
+  }
+  return res;
+}
+
+std::vector<uint32_t> TrigramIndex::candidate_files(
+    std::string_view literal) const {
+  return candidate_files(std::vector<std::string_view>{literal});
+}
+
+std::vector<TrigramMatch> TrigramIndex::find_all(
+    std::string_view needle) const {
+  std::vector<TrigramMatch> res;
+  if (needle.empty()) {
+    return res;
+  }
+  SubstringSearcher searcher(needle);
+  std::vector<uint32_t> trigrams = trigrams_of(needle);
+
+  std::string window;
+  for (uint32_t file = 0; file < files_.size(); file++) {
+    off_t size = file_sizes_[file];
+    std::optional<std::vector<uint32_t>> blocks =
+        candidate_blocks(trigrams, needle.length(), file);
+    if (!blocks.has_value()) {
+      // Too short to use the index, every block is a candidate
+      blocks.emplace();
+      for (off_t b = 0; b * static_cast<off_t>(block_size_) < size; b++) {
+        blocks->push_back(static_cast<uint32_t>(b));
+      }
+    }
+    if (blocks->empty()) {
+      continue;
+    }
+
+    BufferedFileReader bf(files_[file]);
+    size_t i = 0;
+    while (i < blocks->size()) {
+      // Read each run of consecutive blocks in one go, plus enough
+      // of the next block for a match starting in the run to end.
+      size_t j = i + 1;
+      while (j < blocks->size() && (*blocks)[j] == (*blocks)[j - 1] + 1) {
+        j++;
+      }
+      off_t start = static_cast<off_t>((*blocks)[i]) * block_size_;
+      off_t end = static_cast<off_t>((*blocks)[j - 1] + 1) * block_size_ +
+                  needle.length() - 1;
+      end = std::min(end, size);
+      i = j;
+
+      if (!bf.seek(start)) {
+        break;
+      }
+      window.clear();
+      std::optional<std::string_view> chunk;
+      while (window.length() < static_cast<size_t>(end - start) &&
+             (chunk = bf.get_chunk()).has_value()) {
+        window.append(chunk->data(), chunk->length());
+      }
+      window.resize(std::min(window.length(),
+                             static_cast<size_t>(end - start)));
+
+      for (off_t offset : searcher.find_all(window)) {
+        res.push_back(TrigramMatch{file, start + offset});
+      }
+    }
+  }
+  return res;
+}
+
+const std::string& TrigramIndex::file_name(uint32_t id) const {
+  return files_[id];
+}
+
+size_t TrigramIndex::num_files() const {
+  return files_.size();
+}
+
+size_t TrigramIndex::num_trigrams() const {
+  return postings_.size();
+}
+
+size_t TrigramIndex::num_postings() const {
+  return num_postings_;
+}
+
+size_t TrigramIndex::block_size() const {
+  return block_size_;
+}
+
+std::vector<uint32_t> TrigramIndex::trigrams_of(std::string_view s) {
+  std::vector<uint32_t> res;
+  uint32_t trigram = 0;
+  for (size_t i = 0; i < s.length(); i++) {
+    trigram = push_byte(trigram, s[i]);
+    if (i >= 2) {
+      res.push_back(trigram);
+    }
+  }
+  std::sort(res.begin(), res.end());
+  res.erase(std::unique(res.begin(), res.end()), res.end());
+  return res;
+}
+
+std::optional<std::vector<uint32_t>> TrigramIndex::candidate_blocks(
+    const std::vector<uint32_t>& trigrams,
+    size_t length,
+    uint32_t file) const {
+  if (trigrams.empty()) {
+    return std::nullopt;
+  }
+
+  // An occurrence starting in block b ends at most `span` blocks later,
+  // and each of its trigrams starts in one of those blocks. So block b
+  // is a candidate if every trigram is in one of blocks b .. b + span.
+  uint32_t span = static_cast<uint32_t>((block_size_ - 1 + length - 1) /
+                                        block_size_);
+  std::vector<uint32_t> res;
+  std::vector<uint32_t> starts;
+  std::vector<uint32_t> merged;
+  for (size_t i = 0; i < trigrams.size(); i++) {
+    auto it = postings_.find(trigrams[i]);
+    if (it == postings_.end()) {
+      return std::vector<uint32_t>();
+    }
+    const std::vector<uint64_t>& list = it->second;
+    auto first = std::lower_bound(list.begin(), list.end(), posting(file, 0));
+    auto last = std::lower_bound(first, list.end(), posting(file + 1, 0));
+
+    starts.clear();
+    for (auto p = first; p != last; p++) {
+      uint32_t block = static_cast<uint32_t>(*p);
+      for (uint32_t d = 0; d <= span && d <= block; d++) {
+        starts.push_back(block - d);
+      }
+    }
+    std::sort(starts.begin(), starts.end());
+    starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+    if (i == 0) {
+      res.swap(starts);
+    } else {
+      merged.clear();
+      std::set_intersection(res.begin(), res.end(), starts.begin(),
+                            starts.end(), std::back_inserter(merged));
+      res.swap(merged);
+    }
+    if (res.empty()) {
+      break;
+    }
+  }
+  return res;
+}
@@ -0,0 +1,128 @@
+#ifndef TRIGRAMINDEX_HPP_
+#define TRIGRAMINDEX_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/types.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// A match found by a TrigramIndex: the id of the file it is in
+// and its offset in that file.
+///////////////////////////////////////////////////////////////////////////////
+struct TrigramMatch {
+  uint32_t file;
+  off_t offset;
+
+  bool operator==(const TrigramMatch& other) const = default;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// A TrigramIndex records, for every trigram (3 consecutive bytes) in a set
+// of files, which blocks of which files it occurs in.
+//
+// A string can only occur where all of its trigrams do, so a query first
+// intersects the postings of its trigrams to find candidate blocks, and
+// then reads just those blocks with a BufferedFileReader to check for
+// real matches. Files without every trigram are never read at all.
+///////////////////////////////////////////////////////////////////////////////
+class TrigramIndex {
+ public:
+  static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+  // Constructor for an empty TrigramIndex.
+  //
+  // Arguments:
+  // - block_size: the granularity, in bytes, of the postings. Smaller
+  //   blocks mean less to read per candidate but larger postings.
+  TrigramIndex(size_t block_size = kDefaultBlockSize);
+
+  // Adds a file to the index. Its id is the number of files
+  // added before it.
+  //
+  // Arguments:
+  // - fname: The name of the file
+  //
+  // Returns:
+  // - the id of the file
+  // - nullopt if the file could not be opened
+  std::optional<uint32_t> add_file(const std::string& fname);
+
+  // Adds every regular file in a directory to the index, in
+  // order of file name. Sub directories are not searched.
+  //
+  // Arguments:
+  // - dir: the name of the directory
+  //
+  // Returns:
+  // - true if the directory was read
+  // - false otherwise
+  bool add_directory(const std::string& dir);
+
+  // Returns the files which may contain every one of a set of
+  // literals. Literals shorter than a trigram don't narrow
+  // the search.
+  //
+  // Arguments:
+  // - literals: the strings that must all occur
+  //
+  // Returns:
+  // - the ids of the candidate files, in increasing order
+  std::vector<uint32_t> candidate_files(
+      const std::vector<std::string_view>& literals) const;
+  std::vector<uint32_t> candidate_files(std::string_view literal) const;
+
+  // Finds every occurrence of a string in the indexed files,
+  // reading only the blocks that may contain it.
+  //
+  // Arguments:
+  // - needle: the string to search for. An empty needle never matches.
+  //
+  // Returns:
+  // - the matches, ordered by file and then offset
+  std::vector<TrigramMatch> find_all(std::string_view needle) const;
+
+  // Returns the name of the file with the specified id
+  const std::string& file_name(uint32_t id) const;
+
+  // Returns the number of files in the index
+  size_t num_files() const;
+
+  // Returns the number of distinct trigrams in the index
+  size_t num_trigrams() const;
+
+  // Returns the number of (trigram, file, block) entries in the index
+  size_t num_postings() const;
+
+  // Returns the block size of the index
+  size_t block_size() const;
+
+ private:
+  // Helper methods for the queries. The trigrams of a string, packed
+  // into the low 24 bits, with duplicates removed.
+  static std::vector<uint32_t> trigrams_of(std::string_view s);
+
+  // The blocks of `file` in which an occurrence of a string with
+  // these trigrams and `length` may start, in increasing order.
+  // nullopt if any block may (no trigrams to go on).
+  std::optional<std::vector<uint32_t>> candidate_blocks(
+      const std::vector<uint32_t>& trigrams,
+      size_t length,
+      uint32_t file) const;
+
+  size_t block_size_;
+  std::vector<std::string> files_;
+  std::vector<off_t> file_sizes_;
+
+  // Trigram to its postings: (file id << 32 | block number),
+  // in increasing order
+  std::unordered_map<uint32_t, std::vector<uint64_t>> postings_;
+  size_t num_postings_;
+};
+
+#endif  // TRIGRAMINDEX_HPP_
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingPool.hpp"
+
+// The queue of one thread, on its own cache line so
+// locking one queue doesn't slow down its neighbours
+struct alignas(64) TaskQueue {
+  std::mutex mutex;
+  std::deque<size_t> tasks;
+};
+
+WorkStealingPool::WorkStealingPool(size_t num_threads)
+    : num_threads_(num_threads), num_steals_(0) {
+  if (num_threads_ == 0) {
+    num_threads_ = std::max(1U, std::thread::hardware_concurrency());
+  }
+}
+
+void WorkStealingPool::run(size_t num_tasks,
+                           const std::function<void(size_t, size_t)>& f) {
+  // Use no more threads than there are tasks
+  size_t num_threads = std::max<size_t>(1, std::min(num_threads_, num_tasks));
+  std::unique_ptr<TaskQueue[]> queues(new TaskQueue[num_threads]);
+  for (size_t t = 0; t < num_threads; t++) {
+    size_t begin = num_tasks * t / num_threads;
+    size_t end = num_tasks * (t + 1) / num_threads;
+    for (size_t task = begin; task < end; task++) {
+      queues[t].tasks.push_back(task);
+    }
+  }
+  std::atomic<size_t> steals(0);
+
+  auto work = [&](size_t self) {
+    TaskQueue& own = queues[self];
+    while (true) {
+      std::optional<size_t> task;
+      {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+          task = own.tasks.front();
+          own.tasks.pop_front();
+        }
+      }
+      if (task.has_value()) {
+        f(task.value(), self);
+        continue;
+      }
+
+      // Out of work: take half of the back of the first queue found
+      // with any. Tasks are never added, so if every queue is empty
+      // there is nothing left to do.
+      std::vector<size_t> stolen;
+      for (size_t i = 1; i < num_threads && stolen.empty(); i++) {
+        TaskQueue& victim = queues[(self + i) % num_threads];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        size_t n = (victim.tasks.size() + 1) / 2;
+        stolen.assign(victim.tasks.end() - n, victim.tasks.end());
+        victim.tasks.erase(victim.tasks.end() - n, victim.tasks.end());
+      }
+      if (stolen.empty()) {
+        return;
+      }
+      steals++;
+      std::lock_guard<std::mutex> lock(own.mutex);
+      own.tasks.insert(own.tasks.end(), stolen.begin(), stolen.end());
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; t++) {
+    threads.emplace_back(work, t);
+  }
+  work(0);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  num_steals_ = steals;
+}
+
+size_t WorkStealingPool::num_threads() const {
+  return num_threads_;
+}
+
+size_t WorkStealingPool::num_steals() const {
+  return num_steals_;
+}
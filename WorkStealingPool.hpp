@@ -0,0 +1,47 @@
+#ifndef WORKSTEALINGPOOL_HPP_
+#define WORKSTEALINGPOOL_HPP_
+
+#include <cstddef>
+#include <functional>
+
+///////////////////////////////////////////////////////////////////////////////
+// A WorkStealingPool runs a batch of independent tasks on several threads.
+//
+// The tasks are dealt out up front, each thread getting a contiguous
+// block of them in its own queue, so neighbouring tasks (such as the
+// ranges of one file) tend to run on the same thread. A thread works
+// through its own queue from the front, and once that is empty it steals
+// half of the tasks left at the back of another thread's queue. Threads
+// only contend when stealing, and no thread sits idle while another has
+// a backlog, however uneven the tasks are.
+///////////////////////////////////////////////////////////////////////////////
+class WorkStealingPool {
+ public:
+  // Constructor for a WorkStealingPool.
+  //
+  // Arguments:
+  // - num_threads: the number of threads to run tasks on. 0 means use
+  //   one per core.
+  WorkStealingPool(size_t num_threads = 0);
+
+  // Runs every task and returns once they have all finished.
+  //
+  // Arguments:
+  // - num_tasks: the number of tasks, numbered from 0
+  // - f: called as f(size_t task, size_t worker) for each task, where
+  //   worker < num_threads() is the thread running it. Calls with the
+  //   same worker never run at the same time.
+  void run(size_t num_tasks, const std::function<void(size_t, size_t)>& f);
+
+  // Returns the number of threads
+  size_t num_threads() const;
+
+  // Returns the number of times a thread stole tasks in the last run()
+  size_t num_steals() const;
+
+ private:
+  size_t num_threads_;
+  size_t num_steals_;
+};
+
+#endif  // WORKSTEALINGPOOL_HPP_
@@ -0,0 +1,48 @@
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include "./TermFreq.hpp"
+
+// Counts the terms in every file of a directory and reports
+// the totals, the throughput and the most frequent terms.
+//
+// Usage: ./termfreq <directory> [num_threads] [num_top_terms]
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 4) {
+    std::cerr << "Usage: " << argv[0]
+              << " <directory> [num_threads] [num_top_terms]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  size_t num_threads = 0;
+  size_t num_top = 10;
+  if (argc > 2) {
+    num_threads = std::strtoul(argv[2], nullptr, 10);
+  }
+  if (argc > 3) {
+    num_top = std::strtoul(argv[3], nullptr, 10);
+  }
+
+  TermFreqCounter counter(num_threads);
+  std::optional<TermFreqResult> result = counter.count_directory(argv[1]);
+  if (!result.has_value()) {
+    std::cerr << "Couldn't read directory " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Files:            " << result->files << std::endl;
+  std::cout << "Threads:          " << counter.num_threads() << std::endl;
+  std::cout << "Total tokens:     " << result->total_tokens << std::endl;
+  std::cout << "Distinct terms:   " << result->distinct_terms() << std::endl;
+  std::cout << "Seconds:          " << result->seconds << std::endl;
+  std::cout << "Tokens / second:  "
+            << static_cast<uint64_t>(result->tokens_per_second()) << std::endl;
+
+  std::cout << std::endl << "Top " << num_top << " terms:" << std::endl;
+  for (const auto& [term, count] : result->top(num_top)) {
+    std::cout << "  " << count << "\t" << term << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
@@ -11,9 +11,12 @@
 
 #include "./BufferChecker.hpp"
 #include "./BufferedFileReader.hpp"
+#include "./TermDictionary.hpp"
+#include "./TokenBatch.hpp"
 #include "catch.hpp"
 #include <errno.h>
 #include <fstream>
+#include <memory_resource>
 #include <string>
 #include <sys/select.h>
 #include <unistd.h>
@@ -429,3 +432,264 @@ TEST_CASE("Move op=", "[Test_BufferedFileReader]") {
 
   REQUIRE(static_cast<off_t>(kGreatContents.length()) == offset);
 }
+
+// A memory resource that counts the allocations passed on to the heap
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t allocations = 0;
+  size_t outstanding = 0;
+
+ private:
+  void *do_allocate(size_t bytes, size_t align) override {
+    allocations++;
+    outstanding++;
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+  }
+  void do_deallocate(void *p, size_t bytes, size_t align) override {
+    outstanding--;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+TEST_CASE("pmr get_token", "[Test_BufferedFileReader]") {
+  string delims = ",\n ";
+  string kLongContents{};
+  ifstream long_ifs(kLongFileName);
+  kLongContents.assign((std::istreambuf_iterator<char>(long_ifs)),
+                       (std::istreambuf_iterator<char>()));
+
+  CountingResource heap;
+  BufferedFileReader bf(kLongFileName);
+  BufferChecker bc(bf);
+  size_t num_tokens = 0;
+
+  // read the file in "documents" of 1000 tokens, releasing the
+  // memory of each document in one go
+  off_t offset = 0;
+  while (bf.good()) {
+    std::pmr::monotonic_buffer_resource arena(&heap);
+    for (int i = 0; i < 1000 && bf.good(); i++) {
+      optional<std::pmr::string> opt = bf.get_token(&arena, delims);
+      REQUIRE(opt.has_value());
+      REQUIRE(opt.value().get_allocator().resource() == &arena);
+      string token(opt.value());
+      REQUIRE_FALSE(bc.check_token_errors(token, offset));
+      REQUIRE(verify_token(token, kLongContents, delims, &offset));
+      REQUIRE(offset == static_cast<off_t>(bf.tell()));
+      num_tokens++;
+    }
+  }
+
+  REQUIRE(static_cast<off_t>(kLongContents.length()) == offset);
+  REQUIRE_FALSE(bf.get_token(std::pmr::new_delete_resource()).has_value());
+  REQUIRE(heap.outstanding == 0);
+  // the arena grabs memory from the heap in large blocks
+  REQUIRE(heap.allocations * 100 < num_tokens);
+}
+
+TEST_CASE("get_tokens", "[Test_BufferedFileReader]") {
+  string delims = ",\n ";
+  string kLongContents{};
+  ifstream long_ifs(kLongFileName);
+  kLongContents.assign((std::istreambuf_iterator<char>(long_ifs)),
+                       (std::istreambuf_iterator<char>()));
+
+  // try batch sizes smaller and larger than a buffer's worth of tokens
+  for (size_t max : {1, 7, 1000}) {
+    BufferedFileReader bf(kLongFileName);
+    BufferChecker bc(bf);
+    TokenBatch batch;
+    off_t offset = 0;
+
+    while (bf.good()) {
+      size_t n = bf.get_tokens(batch, max, delims);
+      REQUIRE(n == batch.size());
+      REQUIRE(n > 0);
+      REQUIRE((n == max || !bf.good()));
+      for (size_t i = 0; i < n; i++) {
+        string token(batch[i]);
+        REQUIRE(batch.lengths()[i] == token.length());
+        REQUIRE(verify_token(token, kLongContents, delims, &offset));
+      }
+      REQUIRE(offset == static_cast<off_t>(bf.tell()));
+      REQUIRE_FALSE(bc.check_token_errors(string(batch[n - 1]),
+                                          offset - batch.lengths()[n - 1] - 1));
+    }
+
+    REQUIRE(static_cast<off_t>(kLongContents.length()) == offset);
+    REQUIRE(bf.get_tokens(batch, max, delims) == 0);
+    REQUIRE(batch.empty());
+  }
+
+  // mixing single and batched reads
+  BufferedFileReader bf(kHelloFileName);
+  TokenBatch batch;
+  REQUIRE(bf.get_token().value() == "Hello");
+  REQUIRE(bf.get_tokens(batch, 10) == 1);
+  REQUIRE(batch[0] == "World!");
+  bf.close_file();
+  REQUIRE(bf.get_tokens(batch, 10) == 0);
+}
+
+TEST_CASE("for_each_token", "[Test_BufferedFileReader]") {
+  string delims = ",\n ";
+  string kLongContents{};
+  ifstream long_ifs(kLongFileName);
+  kLongContents.assign((std::istreambuf_iterator<char>(long_ifs)),
+                       (std::istreambuf_iterator<char>()));
+
+  BufferedFileReader bf(kLongFileName);
+  BufferChecker bc(bf);
+  off_t offset = 0;
+  size_t seen = 0;
+  size_t n = bf.for_each_token(delims, [&](std::string_view token) {
+    string copy(token);
+    REQUIRE_FALSE(bc.check_token_errors(copy, offset));
+    REQUIRE(verify_token(copy, kLongContents, delims, &offset));
+    REQUIRE(offset == static_cast<off_t>(bf.tell()));
+    seen++;
+  });
+  REQUIRE(n == seen);
+  REQUIRE(static_cast<off_t>(kLongContents.length()) == offset);
+  REQUIRE_FALSE(bf.good());
+  REQUIRE(bf.for_each_token(delims, [](std::string_view) {}) == 0);
+
+  // the tokens are the same as from get_token
+  bf.rewind();
+  BufferedFileReader expected(kLongFileName);
+  bf.for_each_token(delims, [&](std::string_view token) {
+    REQUIRE(expected.get_token(delims).value() == token);
+  });
+  REQUIRE_FALSE(expected.good());
+
+  // stopping early leaves the rest of the file to be read
+  bf.rewind();
+  n = bf.for_each_token(delims, [](std::string_view token) {
+    return token != "Genoa";
+  });
+  REQUIRE(n > 1);
+  REQUIRE(bf.good());
+  REQUIRE(bf.get_token(delims).value() == "and");
+}
+
+TEST_CASE("get_token_with_pos", "[Test_BufferedFileReader]") {
+  string delims = ",\n ";
+  string kLongContents{};
+  ifstream long_ifs(kLongFileName);
+  kLongContents.assign((std::istreambuf_iterator<char>(long_ifs)),
+                       (std::istreambuf_iterator<char>()));
+
+  BufferedFileReader bf(kLongFileName);
+  BufferChecker bc(bf);
+  off_t offset = 0;
+  uint64_t ordinal = 0;
+  while (bf.good()) {
+    optional<PositionedToken> opt = bf.get_token_with_pos(delims);
+    REQUIRE(opt.has_value());
+    REQUIRE(opt->offset == offset);
+    REQUIRE(opt->ordinal == ordinal);
+    REQUIRE_FALSE(bc.check_token_errors(opt->text, opt->offset));
+    REQUIRE(verify_token(opt->text, kLongContents, delims, &offset));
+    REQUIRE(offset == static_cast<off_t>(bf.tell()));
+    ordinal++;
+  }
+  REQUIRE(static_cast<off_t>(kLongContents.length()) == offset);
+  REQUIRE_FALSE(bf.get_token_with_pos(delims).has_value());
+
+  // every way of reading tokens counts towards the ordinal
+  bf.rewind();
+  REQUIRE(bf.get_token_with_pos(delims)->ordinal == 0);
+  bf.get_token(delims);
+  TokenBatch batch;
+  REQUIRE(bf.get_tokens(batch, 10, delims) == 10);
+  size_t n = 0;
+  bf.for_each_token(delims, [&n](std::string_view) { return ++n < 5; });
+  TermDictionary dict;
+  bf.get_token_id(dict, delims);
+  optional<PositionedToken> opt = bf.get_token_with_pos(delims);
+  REQUIRE(opt->ordinal == 18);
+
+  // reading characters moves the offset but is not a token
+  bf.get_char();
+  REQUIRE(bf.get_token_with_pos(delims)->ordinal == 19);
+
+  // the ordinal starts over in a new file
+  bf.open_file(kHelloFileName);
+  opt = bf.get_token_with_pos();
+  REQUIRE(opt->text == "Hello");
+  REQUIRE(opt->offset == 0);
+  REQUIRE(opt->ordinal == 0);
+  opt = bf.get_token_with_pos();
+  REQUIRE(opt->text == "World!");
+  REQUIRE(opt->offset == 6);
+  REQUIRE(opt->ordinal == 1);
+}
+
+TEST_CASE("get_chunk", "[Test_BufferedFileReader]") {
+  string kLongContents{};
+  ifstream long_ifs(kLongFileName);
+  kLongContents.assign((std::istreambuf_iterator<char>(long_ifs)),
+                       (std::istreambuf_iterator<char>()));
+
+  BufferedFileReader bf(kLongFileName);
+  BufferChecker bc(bf);
+
+  // start part way through a buffer
+  string contents;
+  contents += bf.get_char();
+  contents += bf.get_token().value() + " ";
+
+  while (true) {
+    off_t offset = bf.tell();
+    optional<std::string_view> chunk = bf.get_chunk();
+    if (!chunk.has_value()) {
+      break;
+    }
+    REQUIRE(static_cast<size_t>(offset) == contents.length());
+    REQUIRE(chunk->length() > 0);
+    REQUIRE(chunk->length() <= bc.buffer().size());
+    contents += *chunk;
+    REQUIRE(bf.tell() == static_cast<int>(contents.length()));
+  }
+
+  REQUIRE(contents == kLongContents);
+  REQUIRE_FALSE(bf.good());
+  REQUIRE_FALSE(bf.get_chunk().has_value());
+}
+
+TEST_CASE("seek", "[Test_BufferedFileReader]") {
+  string kLongContents{};
+  ifstream long_ifs(kLongFileName);
+  kLongContents.assign((std::istreambuf_iterator<char>(long_ifs)),
+                       (std::istreambuf_iterator<char>()));
+
+  BufferedFileReader bf(kLongFileName);
+  REQUIRE_FALSE(bf.seek(-1));
+
+  // backwards, forwards, and into the middle of a buffer
+  off_t offsets[] = {100000, 12, 1023, 1024, 2000000, 0};
+  for (off_t offset : offsets) {
+    REQUIRE(bf.seek(offset));
+    REQUIRE(bf.tell() == offset);
+    REQUIRE(bf.get_char() == kLongContents[offset]);
+    REQUIRE(bf.tell() == offset + 1);
+    string read;
+    while (read.length() < 5000 && bf.good()) {
+      read += bf.get_chunk().value_or("");
+    }
+    REQUIRE(read.substr(0, 5000) == kLongContents.substr(offset + 1, 5000));
+  }
+
+  // past the end is like being at the end
+  REQUIRE(bf.seek(kLongContents.length() + 10));
+  REQUIRE_FALSE(bf.get_chunk().has_value());
+  REQUIRE_FALSE(bf.good());
+  REQUIRE(bf.seek(0));
+  REQUIRE(bf.good());
+
+  bf.close_file();
+  REQUIRE_FALSE(bf.seek(0));
+}
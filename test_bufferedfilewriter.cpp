@@ -0,0 +1,57 @@
+#include "./BufferedFileWriter.hpp"
+#include "./MappedFile.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <filesystem>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+TEST_CASE("Write", "[Test_BufferedFileWriter]") {
+  TempDir dir("test_bufferedfilewriter");
+  filesystem::create_directories(dir.path);
+  string fname = dir.path + "/out.bin";
+  string expected;
+  {
+    BufferedFileWriter out(fname);
+    REQUIRE(out.good());
+    // small writes, one that tops up the buffer, and one larger
+    // than the buffer that goes straight through
+    for (int i = 0; i < 1000; i++) {
+      string s = to_string(i) + ",";
+      REQUIRE(out.write(s));
+      expected += s;
+    }
+    string big(200 * 1024, 'x');
+    REQUIRE(out.write(big.data(), big.size()));
+    expected += big;
+    REQUIRE(out.write_varint(300));
+    expected += "\xAC\x02";
+    REQUIRE(out.write_varint(5));
+    expected += "\x05";
+    REQUIRE(out.tell() == expected.size());
+
+    BufferedFileWriter moved(std::move(out));
+    REQUIRE_FALSE(out.good());
+    REQUIRE(moved.good());
+    REQUIRE(moved.write("end"));
+    expected += "end";
+    // destroying it writes out the rest
+  }
+  MappedFile file(fname);
+  REQUIRE(file.contents() == expected);
+
+  BufferedFileWriter closed(fname);
+  REQUIRE(closed.write("abc"));
+  REQUIRE(closed.close_file());
+  REQUIRE_FALSE(closed.good());
+  REQUIRE_FALSE(closed.write("def"));
+  REQUIRE_FALSE(closed.close_file());
+  REQUIRE(MappedFile(fname).contents() == "abc");
+
+  BufferedFileWriter bad("./no_such_dir/out.bin");
+  REQUIRE_FALSE(bad.good());
+  REQUIRE_FALSE(bad.write("abc"));
+  REQUIRE_FALSE(bad.close_file());
+}
@@ -0,0 +1,101 @@
+#include "./CompressedPostings.hpp"
+#include "./InvertedIndex.hpp"
+#include "./StreamVByte.hpp"
+#include "catch.hpp"
+#include <random>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kTestFilesDir = "./test_files";
+
+TEST_CASE("Round Trip", "[Test_StreamVByte]") {
+  mt19937 gen(5950);
+  for (size_t n : {0, 1, 3, 4, 5, 16, 127, 1000}) {
+    vector<uint32_t> values(n);
+    for (size_t i = 0; i < n; i++) {
+      // every length of value
+      int bits = 8 * (1 + gen() % 4);
+      values[i] = static_cast<uint32_t>(gen() & ((1ULL << bits) - 1));
+    }
+
+    vector<uint8_t> bytes;
+    StreamVByte::encode(values.data(), n, &bytes);
+    REQUIRE(bytes.size() == StreamVByte::encoded_size(values.data(), n));
+    size_t size = bytes.size();
+    bytes.resize(size + 16);
+
+    vector<uint32_t> decoded(n);
+    const uint8_t *end = StreamVByte::decode(bytes.data(), n, decoded.data());
+    REQUIRE(decoded == values);
+    REQUIRE(end == bytes.data() + size);
+
+    vector<uint32_t> scalar(n);
+    end = StreamVByte::decode_scalar(bytes.data(), n, scalar.data());
+    REQUIRE(scalar == values);
+    REQUIRE(end == bytes.data() + size);
+  }
+
+  // small values take one byte each, plus the control bytes
+  vector<uint32_t> small(100, 7);
+  REQUIRE(StreamVByte::encoded_size(small.data(), small.size()) == 125);
+}
+
+TEST_CASE("Blocks", "[Test_CompressedPostings]") {
+  CompressedPostings empty;
+  REQUIRE(empty.size() == 0);
+  REQUIRE(empty.num_blocks() == 0);
+  REQUIRE(empty.decode().size() == 0);
+  REQUIRE(empty.find_block(0) == 0);
+
+  mt19937 gen(5950);
+  for (size_t n : {1, 127, 128, 129, 1000}) {
+    PostingList list;
+    uint32_t doc = 0;
+    for (size_t i = 0; i < n; i++) {
+      // mostly small gaps, some huge ones
+      doc += (gen() % 10 == 0) ? 1 + gen() % 1000000 : 1 + gen() % 10;
+      list.docs.push_back(doc);
+      list.freqs.push_back(1 + gen() % 300);
+    }
+
+    CompressedPostings cp(list);
+    REQUIRE(cp.size() == n);
+    REQUIRE(cp.num_blocks() ==
+            (n + CompressedPostings::kBlockSize - 1) /
+                CompressedPostings::kBlockSize);
+    PostingList decoded = cp.decode();
+    REQUIRE(decoded.docs == list.docs);
+    REQUIRE(decoded.freqs == list.freqs);
+    REQUIRE(cp.memory_bytes() < n * 8 + 64);
+
+    // skipping to a block and decoding only it
+    uint32_t target = list.docs[n / 2];
+    size_t block = cp.find_block(target);
+    REQUIRE(block == (n / 2) / CompressedPostings::kBlockSize);
+    REQUIRE(cp.block_last_doc(block) >= target);
+    uint32_t docs[CompressedPostings::kBlockSize];
+    uint32_t freqs[CompressedPostings::kBlockSize];
+    size_t count = cp.decode_block(block, docs, freqs);
+    REQUIRE(find(docs, docs + count, target) != docs + count);
+    REQUIRE(cp.find_block(list.docs.back() + 1) == cp.num_blocks());
+  }
+}
+
+TEST_CASE("Index", "[Test_CompressedPostings]") {
+  InvertedIndex index;
+  index.add_directory(kTestFilesDir);
+  size_t raw = 0;
+  size_t compressed = 0;
+  for (uint32_t id = 0; id < index.num_terms(); id++) {
+    const PostingList &list = index.postings(id);
+    CompressedPostings cp(list);
+    PostingList decoded = cp.decode();
+    REQUIRE(decoded.docs == list.docs);
+    REQUIRE(decoded.freqs == list.freqs);
+    raw += list.size() * 2 * sizeof(uint32_t);
+    compressed += cp.memory_bytes();
+  }
+  REQUIRE(raw > 0);
+  REQUIRE(compressed > 0);
+}
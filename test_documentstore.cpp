@@ -0,0 +1,112 @@
+#include "./DocumentStore.hpp"
+#include "./DocumentStoreWriter.hpp"
+#include "./InvertedIndex.hpp"
+#include "./MappedFile.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kTestFilesDir = "./test_files";
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+TEST_CASE("Basic", "[Test_DocumentStore]") {
+  InvertedIndex index;
+  REQUIRE(index.add_directory(kTestFilesDir));
+  TempFile file("test_documentstore_basic.store");
+  REQUIRE(DocumentStoreWriter::write(index, file.path));
+
+  DocumentStore store(file.path);
+  REQUIRE(store.good());
+  REQUIRE(store.num_docs() == index.num_docs());
+  uint64_t raw = 0;
+  for (uint32_t doc = 0; doc < index.num_docs(); doc++) {
+    MappedFile original(index.doc_name(doc));
+    optional<string> text = store.fetch(doc);
+    REQUIRE(text.has_value());
+    REQUIRE(text.value() == original.contents());
+    REQUIRE(store.doc_bytes(doc) == original.size());
+    raw += original.size();
+  }
+  REQUIRE(store.raw_bytes() == raw);
+  REQUIRE(store.file_bytes() * 2 < raw);
+  REQUIRE_FALSE(store.fetch(index.num_docs()).has_value());
+
+  // not a store
+  DocumentStore not_store(kLongFileName);
+  REQUIRE_FALSE(not_store.good());
+  REQUIRE_FALSE(not_store.fetch(0).has_value());
+  DocumentStore missing("./test_files/not_a_file.store");
+  REQUIRE_FALSE(missing.good());
+}
+
+TEST_CASE("Blocks", "[Test_DocumentStore]") {
+  // Many small documents, some empty, with the last one empty
+  mt19937 gen(5950);
+  vector<string> docs;
+  for (int i = 0; i < 2000; i++) {
+    string text;
+    size_t words = gen() % 5 == 0 ? 0 : gen() % 50;
+    for (size_t j = 0; j < words; j++) {
+      text += "word" + to_string(gen() % 100) + " ";
+    }
+    docs.push_back(text);
+  }
+  docs.push_back("");
+
+  TempFile file("test_documentstore_blocks.store");
+  {
+    DocumentStoreWriter writer(file.path, 4096);
+    for (uint32_t i = 0; i < docs.size(); i++) {
+      REQUIRE(writer.add(docs[i]) == i);
+    }
+    REQUIRE(writer.finish());
+    REQUIRE_FALSE(writer.finish());
+    REQUIRE_FALSE(writer.add("too late").has_value());
+  }
+
+  DocumentStore store(file.path);
+  REQUIRE(store.good());
+  REQUIRE(store.num_docs() == docs.size());
+  REQUIRE(store.num_blocks() > 10);
+  for (uint32_t i = 0; i < docs.size(); i++) {
+    REQUIRE(store.fetch(i) == docs[i]);
+  }
+  REQUIRE(store.memory_bytes() < docs.size() * 16 + store.num_blocks() * 32);
+
+  // An empty store
+  TempFile empty_file("test_documentstore_empty.store");
+  {
+    DocumentStoreWriter writer(empty_file.path);
+    REQUIRE(writer.finish());
+  }
+  DocumentStore empty(empty_file.path);
+  REQUIRE(empty.good());
+  REQUIRE(empty.num_docs() == 0);
+  REQUIRE(empty.num_blocks() == 0);
+
+  // A store cut short, or with a damaged block, is caught
+  filesystem::resize_file(file.path, filesystem::file_size(file.path) - 1);
+  REQUIRE_FALSE(DocumentStore(file.path).good());
+
+  TempFile damaged_file("test_documentstore_damaged.store");
+  {
+    DocumentStoreWriter writer(damaged_file.path);
+    writer.add(string(1000, 'x'));
+    writer.finish();
+  }
+  {
+    fstream damaged(damaged_file.path,
+                    ios::in | ios::out | ios::binary);
+    damaged.seekp(32);  // the first byte of the first block
+    damaged.put(static_cast<char>(0xFF));
+  }
+  DocumentStore damaged(damaged_file.path);
+  REQUIRE(damaged.good());
+  REQUIRE_FALSE(damaged.fetch(0).has_value());
+}
@@ -0,0 +1,76 @@
+#include "./ExternalIndexBuilder.hpp"
+#include "./IndexSegment.hpp"
+#include "./InvertedIndex.hpp"
+#include "./SegmentWriter.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kTestFilesDir = "./test_files";
+static constexpr const char *kByeFileName = "./test_files/Bye.txt";
+static constexpr const char *kHelloFileName = "./test_files/Hello.txt";
+
+TEST_CASE("Basic", "[Test_ExternalIndexBuilder]") {
+  TempDir dir("test_externalindexbuilder_basic");
+  filesystem::create_directories(dir.path);
+  InvertedIndex index;
+  index.add_file(kHelloFileName);
+  index.add_file(kByeFileName);
+  REQUIRE(SegmentWriter::write(index, dir.path + "/expected.seg"));
+
+  // everything fits in memory: one run
+  ExternalIndexBuilder builder(dir.path, 1 << 20);
+  REQUIRE(builder.add_file(kHelloFileName) == 0);
+  REQUIRE_FALSE(builder.add_file("./test_files/not_a_file.txt"));
+  REQUIRE(builder.add_file(kByeFileName) == 1);
+  REQUIRE(builder.num_runs() == 0);
+  REQUIRE(builder.memory_bytes() > 0);
+  REQUIRE(builder.build(dir.path + "/actual.seg"));
+  REQUIRE(builder.num_runs() == 1);
+  REQUIRE_FALSE(builder.add_file(kHelloFileName));
+
+  require_same(IndexSegment(dir.path + "/actual.seg"),
+               IndexSegment(dir.path + "/expected.seg"));
+
+  // only the two segments are left behind
+  size_t files = 0;
+  for (const auto &entry : filesystem::directory_iterator(dir.path)) {
+    (void)entry;
+    files++;
+  }
+  REQUIRE(files == 2);
+}
+
+TEST_CASE("Over Budget", "[Test_ExternalIndexBuilder]") {
+  TempDir dir("test_externalindexbuilder_budget");
+  filesystem::create_directories(dir.path);
+  InvertedIndex index;
+  REQUIRE(index.add_directory(kTestFilesDir));
+  REQUIRE(SegmentWriter::write(index, dir.path + "/expected.seg"));
+
+  // the postings of test_files/ take a couple of MB in an InvertedIndex,
+  // so the smallest budget needs many runs, some of which end
+  // partway through a document
+  ExternalIndexBuilder builder(dir.path, 0);
+  REQUIRE(builder.add_directory(kTestFilesDir));
+  REQUIRE(builder.num_runs() > 10);
+  REQUIRE(builder.peak_memory_bytes() <= ExternalIndexBuilder::kMinBudget);
+  REQUIRE(builder.build(dir.path + "/actual.seg"));
+
+  require_same(IndexSegment(dir.path + "/actual.seg"),
+               IndexSegment(dir.path + "/expected.seg"));
+}
+
+TEST_CASE("Bad Temp Dir", "[Test_ExternalIndexBuilder]") {
+  TempDir dir("test_externalindexbuilder_bad");
+  filesystem::create_directories(dir.path);
+  ExternalIndexBuilder builder("./no_such_dir", 0);
+  REQUIRE(builder.good());
+  REQUIRE(builder.add_file(kByeFileName) == 0);
+  REQUIRE_FALSE(builder.build(dir.path + "/actual.seg"));
+  REQUIRE_FALSE(builder.good());
+}
@@ -0,0 +1,66 @@
+#include "./BufferedFileReader.hpp"
+#include "./FlatTermTable.hpp"
+#include "catch.hpp"
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+TEST_CASE("Basic", "[Test_FlatTermTable]") {
+  FlatTermTable table;
+  REQUIRE(table.size() == 0);
+  REQUIRE_FALSE(table.find("the").has_value());
+
+  REQUIRE(table.increment("the") == 1);
+  REQUIRE(table.increment("the") == 2);
+  REQUIRE(table.increment("of", 10) == 10);
+  REQUIRE(table.increment("") == 1);
+  REQUIRE(table.size() == 3);
+  REQUIRE(table.find("the").value() == 2);
+  REQUIRE(table.find("of").value() == 10);
+  REQUIRE(table.find("").value() == 1);
+  REQUIRE_FALSE(table.find("th").has_value());
+  REQUIRE_FALSE(table.find("them").has_value());
+
+  table.clear();
+  REQUIRE(table.size() == 0);
+  REQUIRE_FALSE(table.find("the").has_value());
+}
+
+TEST_CASE("Growth", "[Test_FlatTermTable]") {
+  FlatTermTable table;
+  for (int round = 1; round <= 2; round++) {
+    for (uint64_t i = 0; i < 100000; i++) {
+      REQUIRE(table.increment(to_string(i), i) == i * round);
+    }
+  }
+  REQUIRE(table.size() == 100000);
+
+  uint64_t terms = 0;
+  uint64_t total = 0;
+  table.for_each([&](std::string_view term, uint64_t count) {
+    REQUIRE(count == 2 * stoull(string(term)));
+    terms++;
+    total += count;
+  });
+  REQUIRE(terms == 100000);
+  REQUIRE(total == 99999ULL * 100000);
+}
+
+TEST_CASE("Tokens", "[Test_FlatTermTable]") {
+  string delims = " \t\n\r\v\f";
+  BufferedFileReader bf(kLongFileName);
+  FlatTermTable table;
+  unordered_map<string, uint64_t> expected;
+  bf.for_each_token(delims, [&](std::string_view token) {
+    table.increment(token);
+    expected[string(token)]++;
+  });
+
+  REQUIRE(table.size() == expected.size());
+  for (const auto &[term, count] : expected) {
+    REQUIRE(table.find(term).value() == count);
+  }
+}
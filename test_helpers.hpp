@@ -0,0 +1,74 @@
+#ifndef TEST_HELPERS_HPP_
+#define TEST_HELPERS_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "./IndexSegment.hpp"
+#include "./InvertedIndex.hpp"
+#include "catch.hpp"
+
+// Fixtures and checks shared by the test files
+
+// A scratch file for a test, removed when it goes out of scope
+struct TempFile {
+  TempFile(const std::string& name)
+      : path((std::filesystem::temp_directory_path() / name).string()) {}
+  ~TempFile() { std::filesystem::remove(path); }
+  std::string path;
+};
+
+// A scratch directory for a test, removed when it is created and when
+// it goes out of scope. It is not created, so a test can check that
+// what it tests creates it.
+struct TempDir {
+  TempDir(const std::string& name)
+      : path((std::filesystem::temp_directory_path() / name).string()) {
+    std::filesystem::remove_all(path);
+  }
+  ~TempDir() { std::filesystem::remove_all(path); }
+  std::string path;
+};
+
+// The files of test_files/, in the order add_directory() adds them
+inline std::vector<std::string> test_files() {
+  std::vector<std::string> files;
+  for (const auto& entry :
+       std::filesystem::directory_iterator("./test_files")) {
+    files.push_back(entry.path().string());
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+// Checks that two segments hold the same documents, terms and postings
+inline void require_same(const IndexSegment& a, const IndexSegment& b) {
+  REQUIRE(a.good());
+  REQUIRE(b.good());
+  REQUIRE(a.num_docs() == b.num_docs());
+  REQUIRE(a.num_terms() == b.num_terms());
+  REQUIRE(a.num_postings() == b.num_postings());
+  REQUIRE(a.total_tokens() == b.total_tokens());
+  for (uint32_t doc = 0; doc < a.num_docs(); doc++) {
+    REQUIRE(a.doc_name(doc) == b.doc_name(doc));
+    REQUIRE(a.doc_length(doc) == b.doc_length(doc));
+  }
+  IndexSegment::TermIterator it = b.terms();
+  a.for_each_term(
+      [&it](std::string_view term, const SegmentPostings& postings) {
+        REQUIRE(it.valid());
+        REQUIRE(term == it.term());
+        PostingList expected = it.postings().decode();
+        PostingList actual = postings.decode();
+        REQUIRE(actual.docs == expected.docs);
+        REQUIRE(actual.freqs == expected.freqs);
+        it.next();
+      });
+  REQUIRE_FALSE(it.valid());
+}
+
+#endif  // TEST_HELPERS_HPP_
@@ -0,0 +1,198 @@
+#include "./IndexSegment.hpp"
+#include "./InvertedIndex.hpp"
+#include "./SegmentWriter.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kTestFilesDir = "./test_files";
+static constexpr const char *kByeFileName = "./test_files/Bye.txt";
+static constexpr const char *kHelloFileName = "./test_files/Hello.txt";
+
+TEST_CASE("Basic", "[Test_IndexSegment]") {
+  InvertedIndex index;
+  REQUIRE(index.add_file(kHelloFileName) == 0);
+  REQUIRE(index.add_file(kByeFileName) == 1);
+
+  TempFile file("test_indexsegment_basic.seg");
+  REQUIRE(SegmentWriter::write(index, file.path));
+
+  IndexSegment segment(file.path);
+  REQUIRE(segment.good());
+  REQUIRE(segment.num_docs() == 2);
+  REQUIRE(segment.num_terms() == 8);
+  REQUIRE(segment.num_postings() == 9);
+  REQUIRE(segment.total_tokens() == 12);
+  REQUIRE(segment.doc_name(0) == kHelloFileName);
+  REQUIRE(segment.doc_name(1) == kByeFileName);
+  REQUIRE(segment.doc_length(0) == 2);
+  REQUIRE(segment.doc_length(1) == 10);
+
+  // terms are stored as the index folded them
+  optional<SegmentPostings> world = segment.postings("world");
+  REQUIRE(world.has_value());
+  REQUIRE(world->size() == 2);
+  PostingList list = world->decode();
+  REQUIRE(list[0] == Posting{0, 1});
+  REQUIRE(list[1] == Posting{1, 1});
+
+  optional<SegmentPostings> goodbye = segment.postings("goodbye");
+  REQUIRE(goodbye.has_value());
+  REQUIRE(goodbye->decode()[0] == Posting{1, 4});
+
+  REQUIRE_FALSE(segment.postings("World").has_value());
+  REQUIRE_FALSE(segment.postings("").has_value());
+  REQUIRE_FALSE(segment.postings("a").has_value());
+  REQUIRE_FALSE(segment.postings("zzz").has_value());
+
+  vector<string> terms;
+  segment.for_each_term([&terms](string_view term, const SegmentPostings &) {
+    terms.emplace_back(term);
+  });
+  REQUIRE(terms == vector<string>{"am", "goodbye", "hello", "i", "leaving",
+                                  "today", "world", "you"});
+}
+
+TEST_CASE("Test Files", "[Test_IndexSegment]") {
+  InvertedIndex index;
+  REQUIRE(index.add_directory(kTestFilesDir));
+  TempFile file("test_indexsegment_files.seg");
+  REQUIRE(SegmentWriter::write(index, file.path));
+
+  IndexSegment segment(file.path);
+  REQUIRE(segment.good());
+  REQUIRE(segment.num_docs() == index.num_docs());
+  REQUIRE(segment.num_terms() == index.num_terms());
+  REQUIRE(segment.num_postings() == index.num_postings());
+  REQUIRE(segment.total_tokens() == index.total_tokens());
+  for (uint32_t doc = 0; doc < index.num_docs(); doc++) {
+    REQUIRE(segment.doc_name(doc) == index.doc_name(doc));
+    REQUIRE(segment.doc_length(doc) == index.doc_length(doc));
+  }
+
+  // every term can be looked up and has the same postings
+  const TermDictionary &dict = index.dictionary();
+  for (uint32_t id = 0; id < index.num_terms(); id++) {
+    optional<SegmentPostings> postings = segment.postings(dict.term(id));
+    REQUIRE(postings.has_value());
+    PostingList list = postings->decode();
+    REQUIRE(list.docs == index.postings(id).docs);
+    REQUIRE(list.freqs == index.postings(id).freqs);
+  }
+
+  // and every term is visited once, in order
+  size_t count = 0;
+  string prev;
+  segment.for_each_term(
+      [&](string_view term, const SegmentPostings &postings) {
+        REQUIRE((count == 0 || prev < term));
+        REQUIRE(postings.size() == index.postings(term)->size());
+        prev = term;
+        count++;
+      });
+  REQUIRE(count == index.num_terms());
+}
+
+TEST_CASE("Long Postings", "[Test_IndexSegment]") {
+  TempFile file("test_indexsegment_long.seg");
+  PostingList list;
+  for (uint32_t i = 0; i < 1000; i++) {
+    list.docs.push_back(i * 3 + 1);
+    list.freqs.push_back(1 + i % 5);
+  }
+  {
+    SegmentWriter writer(file.path);
+    REQUIRE(writer.good());
+    for (uint32_t doc = 0; doc <= 3000; doc++) {
+      writer.add_doc("doc" + to_string(doc), 1);
+    }
+    // more than one dictionary block
+    for (int i = 0; i < 200; i++) {
+      string term = "term" + to_string(1000 + i);
+      REQUIRE(writer.add_term(term, list));
+    }
+    REQUIRE(writer.finish());
+  }
+
+  IndexSegment segment(file.path);
+  REQUIRE(segment.good());
+  REQUIRE(segment.num_terms() == 200);
+  REQUIRE(segment.num_docs() == 3001);
+  REQUIRE(segment.doc_name(3000) == "doc3000");
+
+  for (int i = 0; i < 200; i++) {
+    optional<SegmentPostings> postings =
+        segment.postings("term" + to_string(1000 + i));
+    REQUIRE(postings.has_value());
+    REQUIRE(postings->num_blocks() == 8);
+    PostingList decoded = postings->decode();
+    REQUIRE(decoded.docs == list.docs);
+    REQUIRE(decoded.freqs == list.freqs);
+  }
+  REQUIRE_FALSE(segment.postings("term0999").has_value());
+  REQUIRE_FALSE(segment.postings("term1200").has_value());
+  REQUIRE_FALSE(segment.postings("term10005").has_value());
+
+  // skip to the block holding a doc without decoding the ones before
+  SegmentPostings postings = segment.postings("term1100").value();
+  size_t block = postings.find_block(1500);
+  REQUIRE(block == 3);
+  uint32_t docs[SegmentPostings::kBlockSize];
+  uint32_t freqs[SegmentPostings::kBlockSize];
+  REQUIRE(postings.decode_block(block, docs, freqs) == 128);
+  REQUIRE(docs[0] == 384 * 3 + 1);
+  REQUIRE(postings.block_last_doc(block) == 511 * 3 + 1);
+  REQUIRE(postings.decode_block(7, docs, freqs) == 1000 - 7 * 128);
+  REQUIRE(postings.find_block(5000) == postings.num_blocks());
+}
+
+TEST_CASE("Bad Input", "[Test_IndexSegment]") {
+  TempFile file("test_indexsegment_bad.seg");
+  PostingList list;
+  list.docs = {0, 2};
+  list.freqs = {1, 1};
+  {
+    SegmentWriter writer(file.path);
+    REQUIRE(writer.add_term("b", list));
+    REQUIRE_FALSE(writer.add_term("a", list));
+    REQUIRE_FALSE(writer.add_term("b", list));
+    REQUIRE_FALSE(writer.add_term("c", PostingList{}));
+    REQUIRE(writer.add_term("c", list));
+
+    // not finished, so there is no footer yet
+    IndexSegment unfinished(file.path);
+    REQUIRE_FALSE(unfinished.good());
+    REQUIRE(writer.finish());
+  }
+  IndexSegment segment(file.path);
+  REQUIRE(segment.good());
+  REQUIRE(segment.num_terms() == 2);
+
+  IndexSegment missing("./test_files/not_a_file.seg");
+  REQUIRE_FALSE(missing.good());
+  REQUIRE_FALSE(missing.postings("b").has_value());
+
+  IndexSegment text(kByeFileName);
+  REQUIRE_FALSE(text.good());
+
+  // a damaged footer is rejected rather than read through
+  {
+    fstream fs(file.path, ios::in | ios::out | ios::binary);
+    // the footer's dict_offset, 12 words from the end of the file
+    fs.seekp(-12 * 8, ios::end);
+    uint64_t huge = 1ULL << 40;
+    fs.write(reinterpret_cast<const char *>(&huge), sizeof(huge));
+  }
+  IndexSegment damaged(file.path);
+  REQUIRE_FALSE(damaged.good());
+
+  SegmentWriter bad_path("./no_such_dir/x.seg");
+  REQUIRE_FALSE(bad_path.good());
+  REQUIRE_FALSE(bad_path.add_term("a", list));
+  REQUIRE_FALSE(bad_path.finish());
+}
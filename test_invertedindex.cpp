@@ -0,0 +1,84 @@
+#include "./InvertedIndex.hpp"
+#include "./TermFreq.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kTestFilesDir = "./test_files";
+static constexpr const char *kByeFileName = "./test_files/Bye.txt";
+static constexpr const char *kHelloFileName = "./test_files/Hello.txt";
+
+TEST_CASE("Basic", "[Test_InvertedIndex]") {
+  InvertedIndex index;
+  REQUIRE(index.add_file(kHelloFileName) == 0);
+  REQUIRE(index.add_file(kByeFileName) == 1);
+  REQUIRE_FALSE(index.add_file("./test_files/not_a_file.txt").has_value());
+
+  REQUIRE(index.num_docs() == 2);
+  REQUIRE(index.doc_name(1) == kByeFileName);
+  REQUIRE(index.doc_length(0) == 2);
+  REQUIRE(index.doc_length(1) == 10);
+  REQUIRE(index.total_tokens() == 12);
+  // hello world goodbye i am leaving you today
+  REQUIRE(index.num_terms() == 8);
+  REQUIRE(index.num_postings() == 9);
+
+  const PostingList *world = index.postings("World");
+  REQUIRE(world != nullptr);
+  REQUIRE(world->size() == 2);
+  REQUIRE((*world)[0] == Posting{0, 1});
+  REQUIRE((*world)[1] == Posting{1, 1});
+
+  const PostingList *goodbye = index.postings("goodbye");
+  REQUIRE(goodbye != nullptr);
+  REQUIRE(goodbye->docs == vector<uint32_t>{1});
+  REQUIRE(goodbye->freqs == vector<uint32_t>{4});
+  REQUIRE(index.postings("greetings") == nullptr);
+
+  REQUIRE(index.docs_with_all({"world"}) == vector<uint32_t>{0, 1});
+  REQUIRE(index.docs_with_all({"world", "goodbye"}) == vector<uint32_t>{1});
+  REQUIRE(index.docs_with_all({"hello", "goodbye"}).empty());
+  REQUIRE(index.docs_with_all({"world", "greetings"}).empty());
+  REQUIRE(index.docs_with_all({}).empty());
+
+  // without case folding
+  InvertedIndex exact(" \t\n\r\v\f,!", false);
+  exact.add_file(kByeFileName);
+  REQUIRE(exact.postings("goodbye") == nullptr);
+  REQUIRE(exact.postings("Goodbye")->freqs == vector<uint32_t>{4});
+}
+
+TEST_CASE("Directory", "[Test_InvertedIndex]") {
+  InvertedIndex index;
+  REQUIRE(index.add_directory(kTestFilesDir));
+  REQUIRE_FALSE(index.add_directory("./test_files/not_a_dir"));
+  REQUIRE(index.num_docs() == test_files().size());
+
+  // Agrees with counting the same files
+  TermFreqCounter counter(1);
+  TermFreqResult counts = counter.count_directory(kTestFilesDir).value();
+  REQUIRE(index.num_terms() == counts.distinct_terms());
+  REQUIRE(index.total_tokens() == counts.total_tokens);
+
+  uint64_t postings = 0;
+  for (uint32_t id = 0; id < index.num_terms(); id++) {
+    const PostingList &list = index.postings(id);
+    string_view term = index.dictionary().term(id);
+    uint64_t total = 0;
+    for (size_t i = 0; i < list.size(); i++) {
+      REQUIRE(list.freqs[i] > 0);
+      if (i > 0) {
+        REQUIRE(list.docs[i - 1] < list.docs[i]);
+      }
+      total += list.freqs[i];
+    }
+    REQUIRE(total == counts.counts.find(term)->second);
+    postings += list.size();
+  }
+  REQUIRE(postings == index.num_postings());
+  REQUIRE(index.memory_bytes() >
+          index.num_postings() * 8 + index.dictionary().memory_bytes());
+}
@@ -0,0 +1,86 @@
+#include "./LZCodec.hpp"
+#include "./MappedFile.hpp"
+#include "catch.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+// Compresses and decompresses text, checking it comes back the same.
+// Returns the size of the compression.
+static size_t round_trip(const string &text) {
+  vector<uint8_t> compressed;
+  LZCodec::compress(reinterpret_cast<const uint8_t *>(text.data()),
+                    text.size(), &compressed);
+  string decompressed(text.size(), '\0');
+  REQUIRE(LZCodec::decompress(compressed.data(), compressed.size(),
+                              reinterpret_cast<uint8_t *>(decompressed.data()),
+                              decompressed.size()));
+  REQUIRE(decompressed == text);
+  return compressed.size();
+}
+
+TEST_CASE("Round Trip", "[Test_LZCodec]") {
+  REQUIRE(round_trip("") == 1);
+  round_trip("a");
+  round_trip("abcdefgh");
+  round_trip("Goodbye, Goodbye, Goodbye");
+
+  // runs compress to almost nothing, with matches that
+  // overlap what they copy
+  REQUIRE(round_trip(string(100000, 'a')) < 500);
+  string pattern;
+  for (int i = 0; i < 10000; i++) {
+    pattern += "ab";
+  }
+  REQUIRE(round_trip(pattern) < 200);
+
+  // random bytes don't compress, but only grow a little
+  mt19937 gen(5950);
+  for (size_t n : {3, 15, 16, 300, 70000}) {
+    string noise(n, '\0');
+    for (char &c : noise) {
+      c = static_cast<char>(gen());
+    }
+    REQUIRE(round_trip(noise) <= n + n / 255 + 16);
+  }
+
+  // text compresses well, including repeats further apart than
+  // a match can reach
+  MappedFile file(kLongFileName);
+  string text(file.contents());
+  REQUIRE(round_trip(text) * 2 < text.size());
+}
+
+TEST_CASE("Damaged", "[Test_LZCodec]") {
+  string text = "Goodbye, Goodbye, Goodbye, Goodbye world";
+  vector<uint8_t> compressed;
+  LZCodec::compress(reinterpret_cast<const uint8_t *>(text.data()),
+                    text.size(), &compressed);
+  vector<uint8_t> out(text.size() + 100);
+
+  // the wrong length, or cut short
+  REQUIRE_FALSE(LZCodec::decompress(compressed.data(), compressed.size(),
+                                    out.data(), text.size() - 1));
+  REQUIRE_FALSE(LZCodec::decompress(compressed.data(), compressed.size(),
+                                    out.data(), text.size() + 1));
+  for (size_t n = 0; n < compressed.size(); n++) {
+    REQUIRE_FALSE(LZCodec::decompress(compressed.data(), n, out.data(),
+                                      text.size()));
+  }
+
+  // garbage is caught without writing past the output
+  mt19937 gen(5950);
+  for (int i = 0; i < 1000; i++) {
+    vector<uint8_t> garbage(1 + gen() % 64);
+    for (uint8_t &b : garbage) {
+      b = static_cast<uint8_t>(gen());
+    }
+    vector<uint8_t> small(16);
+    LZCodec::decompress(garbage.data(), garbage.size(), small.data(),
+                        small.size());
+  }
+}
@@ -0,0 +1,51 @@
+#include "./MappedFile.hpp"
+#include "catch.hpp"
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+static constexpr const char *kHelloFileName = "./test_files/Hello.txt";
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+TEST_CASE("Basic", "[Test_MappedFile]") {
+  MappedFile mf(kHelloFileName);
+  REQUIRE(mf.good());
+  REQUIRE(mf.size() == 12);
+  REQUIRE(mf.contents() == "Hello World!");
+
+  MappedFile missing("./test_files/not_a_file.txt");
+  REQUIRE_FALSE(missing.good());
+  REQUIRE(missing.contents().empty());
+}
+
+TEST_CASE("Contents", "[Test_MappedFile]") {
+  string kLongContents{};
+  ifstream long_ifs(kLongFileName);
+  kLongContents.assign((std::istreambuf_iterator<char>(long_ifs)),
+                       (std::istreambuf_iterator<char>()));
+
+  MappedFile mf(kLongFileName);
+  REQUIRE(mf.good());
+  REQUIRE(mf.contents() == kLongContents);
+}
+
+TEST_CASE("Move", "[Test_MappedFile]") {
+  MappedFile *mf = new MappedFile(kHelloFileName);
+  string_view contents = mf->contents();
+
+  MappedFile moved(std::move(*mf));
+  REQUIRE_FALSE(mf->good());
+  REQUIRE(mf->contents().empty());
+  delete mf;
+
+  // the mapping must survive the moved from object's destructor
+  REQUIRE(moved.good());
+  REQUIRE(moved.contents() == "Hello World!");
+  REQUIRE(moved.contents().data() == contents.data());
+
+  MappedFile assigned(kLongFileName);
+  assigned = std::move(moved);
+  REQUIRE(assigned.contents() == "Hello World!");
+  REQUIRE_FALSE(moved.good());
+}
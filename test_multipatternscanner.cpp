@@ -0,0 +1,116 @@
+#include "./BufferedFileReader.hpp"
+#include "./MappedFile.hpp"
+#include "./MultiPatternScanner.hpp"
+#include "catch.hpp"
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+// Finds the matches one pattern at a time with std::string::find
+static vector<PatternMatch> naive_find_all(const string &text,
+                                           const vector<string> &patterns) {
+  vector<PatternMatch> result;
+  for (uint32_t p = 0; p < patterns.size(); p++) {
+    if (patterns[p].empty()) {
+      continue;
+    }
+    for (size_t pos = text.find(patterns[p]); pos != string::npos;
+         pos = text.find(patterns[p], pos + 1)) {
+      result.push_back(PatternMatch{p, static_cast<off_t>(pos)});
+    }
+  }
+  return result;
+}
+
+static void sort_matches(vector<PatternMatch> *matches) {
+  sort(matches->begin(), matches->end(),
+       [](const PatternMatch &a, const PatternMatch &b) {
+         if (a.offset != b.offset) {
+           return a.offset < b.offset;
+         }
+         return a.pattern < b.pattern;
+       });
+}
+
+TEST_CASE("Basic", "[Test_MultiPatternScanner]") {
+  MultiPatternScanner scanner({"he", "she", "his", "hers", ""});
+  REQUIRE(scanner.num_patterns() == 5);
+
+  vector<PatternMatch> matches = scanner.find_all("ushers");
+  REQUIRE(matches.size() == 3);
+  // matches that end together are in pattern order
+  REQUIRE(matches[0] == PatternMatch{0, 2});  // he
+  REQUIRE(matches[1] == PatternMatch{1, 1});  // she
+  REQUIRE(matches[2] == PatternMatch{3, 2});  // hers
+
+  REQUIRE(scanner.find_all("").empty());
+  REQUIRE(scanner.find_all("xyz").empty());
+
+  // overlapping and repeated matches
+  MultiPatternScanner aa({"aa", "a"});
+  matches = aa.find_all("aaa");
+  REQUIRE(matches.size() == 5);
+
+  // state carries across chunks
+  uint32_t state = MultiPatternScanner::kStartState;
+  vector<PatternMatch> split;
+  auto sink = [&split](uint32_t p, off_t off) {
+    split.push_back(PatternMatch{p, off});
+  };
+  scanner.scan("us", 0, &state, sink);
+  scanner.scan("h", 2, &state, sink);
+  scanner.scan("ers", 3, &state, sink);
+  REQUIRE(split == scanner.find_all("ushers"));
+}
+
+TEST_CASE("Binary", "[Test_MultiPatternScanner]") {
+  // patterns using every byte value
+  vector<string> patterns;
+  for (int b = 0; b < 256; b++) {
+    patterns.push_back(string(1, static_cast<char>(b)) + "x");
+  }
+  MultiPatternScanner scanner(patterns);
+  string text;
+  for (int b = 255; b >= 0; b--) {
+    text += static_cast<char>(b);
+    text += 'x';
+  }
+  vector<PatternMatch> matches = scanner.find_all(text);
+  REQUIRE(matches.size() == 257);  // "xx" matches twice
+}
+
+TEST_CASE("File", "[Test_MultiPatternScanner]") {
+  string kLongContents{};
+  ifstream long_ifs(kLongFileName);
+  kLongContents.assign((std::istreambuf_iterator<char>(long_ifs)),
+                       (std::istreambuf_iterator<char>()));
+
+  vector<string> patterns = {"Prince Andrew", "Natasha", "Moscow", "Napoleon",
+                             "war", "peace", "the", "he", "e", "Pierre",
+                             "\n\n", "said Prince", "Bolkonski"};
+  // plus a lot of words taken from the text
+  for (size_t pos = 1000; pos < kLongContents.length(); pos += 997) {
+    patterns.push_back(kLongContents.substr(pos, 3 + pos % 9));
+  }
+
+  MultiPatternScanner scanner(patterns);
+  vector<PatternMatch> expected = naive_find_all(kLongContents, patterns);
+  sort_matches(&expected);
+
+  BufferedFileReader bf(kLongFileName);
+  vector<PatternMatch> streamed = scanner.find_all(bf);
+  sort_matches(&streamed);
+  REQUIRE(streamed.size() == expected.size());
+  REQUIRE(streamed == expected);
+
+  MappedFile mf(kLongFileName);
+  REQUIRE(mf.good());
+  vector<PatternMatch> mapped = scanner.find_all(mf.contents());
+  sort_matches(&mapped);
+  REQUIRE(mapped == expected);
+}
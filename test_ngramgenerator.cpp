@@ -0,0 +1,87 @@
+#include "./BufferedFileReader.hpp"
+#include "./NGramGenerator.hpp"
+#include "./TermDictionary.hpp"
+#include "catch.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+TEST_CASE("Basic", "[Test_NGramGenerator]") {
+  NGramGenerator bigrams(2);
+  REQUIRE(bigrams.n() == 2);
+  REQUIRE_FALSE(bigrams.push(1).has_value());
+  REQUIRE(bigrams.push(2).value() == ((1ULL << 32) | 2));
+  REQUIRE(bigrams.term(0) == 1);
+  REQUIRE(bigrams.term(1) == 2);
+  REQUIRE(bigrams.push(3).value() == ((2ULL << 32) | 3));
+  REQUIRE(bigrams.term(0) == 2);
+  REQUIRE(bigrams.term(1) == 3);
+
+  // nothing spans a reset
+  bigrams.reset();
+  REQUIRE_FALSE(bigrams.push(4).has_value());
+  REQUIRE(bigrams.push(5).value() == ((4ULL << 32) | 5));
+
+  NGramGenerator unigrams(1);
+  REQUIRE(unigrams.push(7).value() == 7);
+  REQUIRE(unigrams.push(8).value() == 8);
+}
+
+TEST_CASE("Trigrams", "[Test_NGramGenerator]") {
+  NGramGenerator trigrams(3);
+  uint32_t terms[] = {1, 2, 3, 1, 2, 3, 3, 2, 1};
+  vector<uint64_t> ids;
+  for (uint32_t t : terms) {
+    optional<uint64_t> id = trigrams.push(t);
+    if (id.has_value()) {
+      ids.push_back(id.value());
+    }
+  }
+  REQUIRE(ids.size() == 7);
+
+  // same words, same id. order matters
+  REQUIRE(ids[0] == ids[3]);
+  REQUIRE(ids[0] != ids[1]);
+  REQUIRE(ids[0] != ids[6]);
+  REQUIRE(ids[0] == NGramGenerator::ngram_id(terms, 3));
+  REQUIRE(ids[6] == NGramGenerator::ngram_id(terms + 6, 3));
+  REQUIRE(trigrams.term(0) == 3);
+  REQUIRE(trigrams.term(2) == 1);
+}
+
+TEST_CASE("for_each_ngram", "[Test_NGramGenerator]") {
+  string delims = " \t\n\r\v\f";
+  BufferedFileReader bf(kLongFileName);
+  TermDictionary dict;
+
+  // collect the words to check against
+  vector<uint32_t> words;
+  while (bf.good()) {
+    optional<string> token = bf.get_token(delims);
+    if (!token.value().empty()) {
+      words.push_back(dict.intern(token.value()));
+    }
+  }
+
+  bf.rewind();
+  NGramGenerator trigrams(3);
+  unordered_map<uint64_t, size_t> counts;
+  uint64_t expected_position = 0;
+  size_t n = trigrams.for_each_ngram(bf, dict, delims,
+                                     [&](uint64_t id, uint64_t position) {
+    REQUIRE(position == expected_position);
+    REQUIRE(id == NGramGenerator::ngram_id(&words[position], 3));
+    counts[id]++;
+    expected_position++;
+  });
+  REQUIRE(n == words.size() - 2);
+
+  // a phrase that appears many times
+  uint32_t phrase[] = {dict.find("said").value(), dict.find("Prince").value(),
+                       dict.find("Andrew.").value()};
+  REQUIRE(counts[NGramGenerator::ngram_id(phrase, 3)] > 10);
+}
@@ -0,0 +1,67 @@
+#include "./IndexSegment.hpp"
+#include "./InvertedIndex.hpp"
+#include "./ParallelIndexBuilder.hpp"
+#include "./SegmentWriter.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kTestFilesDir = "./test_files";
+static constexpr const char *kByeFileName = "./test_files/Bye.txt";
+static constexpr const char *kHelloFileName = "./test_files/Hello.txt";
+
+TEST_CASE("Basic", "[Test_ParallelIndexBuilder]") {
+  InvertedIndex index;
+  index.add_file(kHelloFileName);
+  index.add_file(kByeFileName);
+  TempFile expected("test_parallelindexbuilder_expected.seg");
+  REQUIRE(SegmentWriter::write(index, expected.path));
+
+  // ranges of a few bytes, so tokens are cut in all possible ways
+  for (size_t range_bytes : {1, 2, 3, 5, 7, 1000}) {
+    ParallelIndexBuilder builder(3, kDefaultDelims, true, range_bytes);
+    REQUIRE(builder.add_file(kHelloFileName) == 0);
+    REQUIRE_FALSE(builder.add_file("./test_files/not_a_file.txt"));
+    REQUIRE(builder.add_file(kByeFileName) == 1);
+
+    TempFile actual("test_parallelindexbuilder_basic.seg");
+    REQUIRE(builder.build(actual.path));
+    REQUIRE(builder.num_ranges() ==
+            (12 + range_bytes - 1) / range_bytes +
+                (filesystem::file_size(kByeFileName) + range_bytes - 1) /
+                    range_bytes);
+    require_same(IndexSegment(actual.path), IndexSegment(expected.path));
+  }
+}
+
+TEST_CASE("Test Files", "[Test_ParallelIndexBuilder]") {
+  InvertedIndex index;
+  REQUIRE(index.add_directory(kTestFilesDir));
+  TempFile expected("test_parallelindexbuilder_expected.seg");
+  REQUIRE(SegmentWriter::write(index, expected.path));
+
+  for (size_t threads : {1, 4, 16}) {
+    ParallelIndexBuilder builder(threads, kDefaultDelims, true, 64 * 1024);
+    REQUIRE(builder.num_threads() == threads);
+    REQUIRE(builder.add_directory(kTestFilesDir));
+    REQUIRE_FALSE(builder.add_directory("./no_such_dir"));
+
+    TempFile actual("test_parallelindexbuilder_files.seg");
+    REQUIRE(builder.build(actual.path));
+    // war_and_peace.txt alone is cut into dozens of ranges
+    REQUIRE(builder.num_ranges() > 50);
+    require_same(IndexSegment(actual.path), IndexSegment(expected.path));
+  }
+
+  // nothing added: an empty segment
+  ParallelIndexBuilder empty(2);
+  TempFile actual("test_parallelindexbuilder_empty.seg");
+  REQUIRE(empty.build(actual.path));
+  IndexSegment segment(actual.path);
+  REQUIRE(segment.good());
+  REQUIRE(segment.num_docs() == 0);
+}
@@ -9,18 +9,39 @@
  * author.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <errno.h>
 #include <iostream>
 #include <sys/select.h>
+#include <thread>
 #include <time.h> // POSIX
 #include <unistd.h>
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "./BufferedFileReader.hpp"
+#include "./CompressedPostings.hpp"
+#include "./DocumentStore.hpp"
+#include "./DocumentStoreWriter.hpp"
+#include "./ExternalIndexBuilder.hpp"
+#include "./FlatTermTable.hpp"
+#include "./IndexSegment.hpp"
+#include "./InvertedIndex.hpp"
+#include "./ParallelIndexBuilder.hpp"
+#include "./SegmentWriter.hpp"
 #include "./SimpleFileReader.hpp"
+#include "./StreamVByte.hpp"
+#include "./TermFreq.hpp"
+#include "./TermTrie.hpp"
+#include "./TermTrieBuilder.hpp"
 #include "./catch.hpp"
 
 static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+static constexpr const char *kTestFilesDir = "./test_files";
 
 static uint64_t get_ms() {
   struct timespec spec;
@@ -67,3 +88,329 @@ TEST_CASE("Basic", "[Test_Performance]") {
 
   REQUIRE(buffered_time * 3 < simple_time);
 }
+
+TEST_CASE("FlatTermTable", "[Test_Performance]") {
+  // Count the tokens of "War and Peace" with each kind of table,
+  // the tokens are read up front so only the tables are timed.
+  BufferedFileReader bf(kLongFileName);
+  std::vector<std::string> tokens;
+  bf.for_each_token(" \t\n\r\v\f", [&tokens](std::string_view token) {
+    tokens.emplace_back(token);
+  });
+
+  uint64_t start_time = get_ms();
+  std::unordered_map<std::string, uint64_t> map;
+  for (int i = 0; i < 5; i++) {
+    for (const std::string& token : tokens) {
+      map[token]++;
+    }
+  }
+  uint64_t map_time = get_ms() - start_time;
+
+  start_time = get_ms();
+  FlatTermTable table;
+  for (int i = 0; i < 5; i++) {
+    for (const std::string& token : tokens) {
+      table.increment(token);
+    }
+  }
+  uint64_t table_time = get_ms() - start_time;
+
+  std::cout << "Time (ms) to count \"War and Peace\" 5 times with "
+            << "std::unordered_map: " << map_time << std::endl;
+  std::cout << "Time (ms) to count \"War and Peace\" 5 times with "
+            << "FlatTermTable: " << table_time << " ("
+            << table.memory_bytes() / 1024 << " KiB)" << std::endl;
+
+  REQUIRE(table.size() == map.size());
+}
+
+TEST_CASE("TermFreq", "[Test_Performance]") {
+  // Counting throughput on one thread and on every core
+  size_t cores = std::max(1U, std::thread::hardware_concurrency());
+  for (size_t threads : {size_t(1), cores}) {
+    TermFreqCounter counter(threads);
+    std::optional<TermFreqResult> result =
+        counter.count_directory(kTestFilesDir);
+    REQUIRE(result.has_value());
+    std::cout << "TermFreq of test_files/ on " << threads << " threads: "
+              << static_cast<uint64_t>(result->tokens_per_second())
+              << " tokens/s" << std::endl;
+  }
+}
+
+TEST_CASE("InvertedIndex", "[Test_Performance]") {
+  uint64_t start_time = get_ms();
+  InvertedIndex index;
+  REQUIRE(index.add_directory(kTestFilesDir));
+  uint64_t build_time = get_ms() - start_time;
+
+  std::cout << "Time (ms) to build an InvertedIndex of test_files/: "
+            << build_time << " (" << index.total_tokens() << " tokens, "
+            << index.num_terms() << " terms, " << index.num_postings()
+            << " postings, " << index.memory_bytes() / 1024 << " KiB)"
+            << std::endl;
+
+  REQUIRE(index.num_docs() > 0);
+}
+
+TEST_CASE("CompressedPostings", "[Test_Performance]") {
+  InvertedIndex index;
+  REQUIRE(index.add_directory(kTestFilesDir));
+
+  // Against two 32 bit values per posting. test_files/ has only a
+  // few documents, so the block index is a large part of the total.
+  std::vector<CompressedPostings> lists;
+  uint64_t raw_bytes = 0;
+  uint64_t encoded_bytes = 0;
+  uint64_t memory_bytes = 0;
+  for (uint32_t id = 0; id < index.num_terms(); id++) {
+    lists.emplace_back(index.postings(id));
+    raw_bytes += index.postings(id).size() * 2 * sizeof(uint32_t);
+    encoded_bytes += lists.back().encoded_bytes();
+    memory_bytes += lists.back().memory_bytes();
+  }
+  std::cout << "Compressed postings of test_files/: " << raw_bytes
+            << " bytes raw, " << encoded_bytes << " bytes encoded ("
+            << static_cast<double>(raw_bytes) / encoded_bytes << "x), "
+            << memory_bytes << " bytes with the block index" << std::endl;
+  REQUIRE(encoded_bytes < raw_bytes);
+
+  // Decode throughput needs long lists: one posting list with a
+  // million postings, as a common term in a large corpus would have
+  PostingList list;
+  uint32_t doc = 0;
+  for (uint32_t i = 0; i < 1000000; i++) {
+    doc += 1 + (i * 2654435761U) % 64;
+    list.docs.push_back(doc);
+    list.freqs.push_back(1 + i % 7);
+  }
+  CompressedPostings cp(list);
+
+  constexpr int kRounds = 20;
+  uint32_t docs[CompressedPostings::kBlockSize];
+  uint32_t freqs[CompressedPostings::kBlockSize];
+  uint64_t checksum = 0;
+  uint64_t start_time = get_ms();
+  for (int round = 0; round < kRounds; round++) {
+    for (size_t b = 0; b < cp.num_blocks(); b++) {
+      size_t n = cp.decode_block(b, docs, freqs);
+      checksum += docs[n - 1] + freqs[0];
+    }
+  }
+  uint64_t decode_time = std::max<uint64_t>(1, get_ms() - start_time);
+
+  std::cout << "Decoded " << kRounds << "M postings in " << decode_time
+            << " ms (" << kRounds * 1000 / decode_time << " M postings/s"
+            << (StreamVByte::has_simd() ? ", SSSE3" : ", scalar") << "), "
+            << list.size() * 8 / cp.memory_bytes() << "x smaller than raw"
+            << std::endl;
+
+  REQUIRE(checksum > 0);
+  REQUIRE(cp.memory_bytes() * 2 < list.size() * 8);
+}
+
+TEST_CASE("IndexSegment", "[Test_Performance]") {
+  // Startup: rebuilding the index from the files against
+  // opening a segment written from it
+  uint64_t start_time = get_ms();
+  InvertedIndex index;
+  REQUIRE(index.add_directory(kTestFilesDir));
+  uint64_t build_time = get_ms() - start_time;
+
+  std::string fname = "./test_performance.seg";
+  REQUIRE(SegmentWriter::write(index, fname));
+
+  constexpr int kOpens = 1000;
+  uint64_t lookups = 0;
+  start_time = get_ms();
+  for (int i = 0; i < kOpens; i++) {
+    IndexSegment segment(fname);
+    lookups += segment.postings("prince").has_value();
+  }
+  uint64_t open_time = get_ms() - start_time;
+
+  IndexSegment segment(fname);
+  std::cout << "Time (ms) to build an InvertedIndex of test_files/: "
+            << build_time << ", to open its segment and look up a term "
+            << kOpens << " times: " << open_time << " ("
+            << segment.file_bytes() / 1024 << " KiB segment, "
+            << index.memory_bytes() / 1024 << " KiB index)" << std::endl;
+  std::remove(fname.c_str());
+
+  REQUIRE(lookups == kOpens);
+  REQUIRE(open_time < build_time * kOpens / 10);
+}
+
+TEST_CASE("ParallelIndexBuilder", "[Test_Performance]") {
+  // Build throughput on one thread and on every core. On a machine
+  // with one core this only measures the overhead of the threads.
+  std::string fname = "./test_performance.seg";
+  size_t cores = std::max(1U, std::thread::hardware_concurrency());
+  uint64_t times[2];
+  size_t threads[2] = {1, cores};
+  for (int i = 0; i < 2; i++) {
+    ParallelIndexBuilder builder(threads[i]);
+    REQUIRE(builder.add_directory(kTestFilesDir));
+    uint64_t start_time = get_ms();
+    REQUIRE(builder.build(fname));
+    times[i] = std::max<uint64_t>(1, get_ms() - start_time);
+  }
+  std::remove(fname.c_str());
+
+  std::cout << "Time (ms) to build a segment of test_files/ on 1 thread: "
+            << times[0] << ", on " << cores << " threads: " << times[1]
+            << " (" << static_cast<double>(times[0]) / times[1]
+            << "x)" << std::endl;
+}
+
+TEST_CASE("ExternalIndexBuilder", "[Test_Performance]") {
+  // A budget well under what an InvertedIndex of test_files/ takes
+  constexpr size_t kBudget = 256 * 1024;
+  std::string fname = "./test_performance.seg";
+  uint64_t start_time = get_ms();
+  ExternalIndexBuilder builder(".", kBudget);
+  REQUIRE(builder.add_directory(kTestFilesDir));
+  REQUIRE(builder.build(fname));
+  uint64_t build_time = get_ms() - start_time;
+  std::remove(fname.c_str());
+
+  std::cout << "Time (ms) to build a segment of test_files/ in "
+            << kBudget / 1024 << " KiB: " << build_time << " ("
+            << builder.num_runs() << " runs, peak "
+            << builder.peak_memory_bytes() / 1024 << " KiB)" << std::endl;
+  REQUIRE(builder.peak_memory_bytes() <= kBudget);
+}
+
+TEST_CASE("PhraseQuery", "[Test_Performance]") {
+  // The space positions take, and phrase queries against a segment
+  InvertedIndex index(kDefaultDelims, true, true);
+  REQUIRE(index.add_directory(kTestFilesDir));
+  std::string fname = "./test_performance.seg";
+  std::string plain_fname = "./test_performance_plain.seg";
+  REQUIRE(SegmentWriter::write(index, fname));
+  InvertedIndex plain;
+  REQUIRE(plain.add_directory(kTestFilesDir));
+  REQUIRE(SegmentWriter::write(plain, plain_fname));
+
+  IndexSegment segment(fname);
+  IndexSegment plain_segment(plain_fname);
+  constexpr int kRounds = 100;
+  uint64_t matches = 0;
+  uint64_t start_time = get_ms();
+  for (int i = 0; i < kRounds; i++) {
+    for (const Posting& posting : segment.find_phrase({"of", "the"})) {
+      matches += posting.freq;
+    }
+  }
+  uint64_t phrase_time = get_ms() - start_time;
+
+  std::cout << "Time (ms) to find \"of the\" in a segment of test_files/ "
+            << kRounds << " times: " << phrase_time << " ("
+            << matches / kRounds << " matches, "
+            << plain_segment.file_bytes() / 1024 << " KiB segment, "
+            << segment.file_bytes() / 1024 << " KiB with positions)"
+            << std::endl;
+  std::remove(fname.c_str());
+  std::remove(plain_fname.c_str());
+
+  REQUIRE(matches > 0);
+  REQUIRE(plain_segment.file_bytes() < segment.file_bytes());
+}
+
+TEST_CASE("DocumentStore", "[Test_Performance]") {
+  // Getting the text of a short document back, as a result snippet
+  // would, from a store against opening and reading its file
+  InvertedIndex index;
+  REQUIRE(index.add_directory(kTestFilesDir));
+  std::string fname = "./test_performance.store";
+  REQUIRE(DocumentStoreWriter::write(index, fname));
+  DocumentStore store(fname);
+  REQUIRE(store.good());
+
+  uint32_t doc = 0;
+  while (index.doc_name(doc) != "./test_files/Bye.txt") {
+    doc++;
+  }
+  constexpr int kFetches = 10000;
+  uint64_t bytes = 0;
+  uint64_t start_time = get_ms();
+  for (int i = 0; i < kFetches; i++) {
+    SimpleFileReader reader(index.doc_name(doc));
+    char c;
+    while ((c = reader.get_char()) != static_cast<char>(EOF)) {
+      bytes++;
+    }
+  }
+  uint64_t file_time = get_ms() - start_time;
+
+  start_time = get_ms();
+  for (int i = 0; i < kFetches; i++) {
+    bytes -= store.fetch(doc)->size();
+  }
+  uint64_t store_time = get_ms() - start_time;
+  std::remove(fname.c_str());
+
+  std::cout << "Time (ms) to read a short document " << kFetches
+            << " times with SimpleFileReader: " << file_time
+            << ", from a DocumentStore: " << store_time << " ("
+            << store.raw_bytes() / 1024 << " KiB of text in "
+            << store.file_bytes() / 1024 << " KiB, " << store.num_blocks()
+            << " blocks)" << std::endl;
+
+  REQUIRE(bytes == 0);
+  REQUIRE(store_time < file_time);
+}
+
+TEST_CASE("TermTrie", "[Test_Performance]") {
+  // The terms of test_files/ as a sorted array of strings against a trie
+  InvertedIndex index;
+  REQUIRE(index.add_directory(kTestFilesDir));
+  std::vector<std::string> terms;
+  size_t vector_bytes = 0;
+  for (uint32_t id = 0; id < index.num_terms(); id++) {
+    terms.emplace_back(index.dictionary().term(id));
+  }
+  std::sort(terms.begin(), terms.end());
+  for (const std::string& term : terms) {
+    vector_bytes += sizeof(std::string) + term.capacity();
+  }
+
+  std::string fname = "./test_performance.trie";
+  TermTrieBuilder builder(fname);
+  for (size_t i = 0; i < terms.size(); i++) {
+    REQUIRE(builder.add(terms[i], i));
+  }
+  REQUIRE(builder.finish());
+  TermTrie trie(fname);
+
+  uint64_t found = 0;
+  uint64_t start_time = get_ms();
+  for (int round = 0; round < 10; round++) {
+    for (const std::string& term : terms) {
+      found += trie.find(term).has_value();
+    }
+  }
+  uint64_t find_time = get_ms() - start_time;
+
+  size_t completions = 0;
+  start_time = get_ms();
+  for (char c = 'a'; c <= 'z'; c++) {
+    trie.for_each_prefix(std::string(1, c) + "e",
+                         [&completions](std::string_view, uint64_t) {
+                           completions++;
+                         });
+  }
+  uint64_t prefix_time = get_ms() - start_time;
+  std::remove(fname.c_str());
+
+  std::cout << "TermTrie of " << terms.size() << " terms: "
+            << trie.file_bytes() / 1024 << " KiB against "
+            << vector_bytes / 1024 << " KiB as strings, "
+            << 10 * terms.size() << " lookups in " << find_time << " ms, "
+            << completions << " completions of 26 prefixes in "
+            << prefix_time << " ms" << std::endl;
+
+  REQUIRE(found == 10 * terms.size());
+  REQUIRE(trie.file_bytes() < vector_bytes);
+}
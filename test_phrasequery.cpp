@@ -0,0 +1,231 @@
+#include "./BufferedFileReader.hpp"
+#include "./IndexSegment.hpp"
+#include "./InvertedIndex.hpp"
+#include "./PhraseQuery.hpp"
+#include "./SegmentMerger.hpp"
+#include "./SegmentWriter.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kTestFilesDir = "./test_files";
+static constexpr const char *kByeFileName = "./test_files/Bye.txt";
+static constexpr const char *kHelloFileName = "./test_files/Hello.txt";
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+// Counts a phrase in a file by reading its tokens in order
+static uint32_t count_phrase(const string &fname,
+                             const vector<string_view> &phrase) {
+  vector<string> tokens;
+  BufferedFileReader reader(fname);
+  reader.for_each_token(kDefaultDelims, [&tokens](string_view token) {
+    if (token.empty()) {
+      return;
+    }
+    string term(token);
+    for (char &c : term) {
+      if (c >= 'A' && c <= 'Z') {
+        c = c - 'A' + 'a';
+      }
+    }
+    tokens.push_back(term);
+  });
+  uint32_t count = 0;
+  for (size_t i = 0; i + phrase.size() <= tokens.size(); i++) {
+    bool match = true;
+    for (size_t j = 0; j < phrase.size() && match; j++) {
+      match = tokens[i + j] == phrase[j];
+    }
+    count += match;
+  }
+  return count;
+}
+
+TEST_CASE("Count", "[Test_PhraseQuery]") {
+  vector<uint32_t> a = {0, 4, 9, 12};
+  vector<uint32_t> b = {1, 5, 7, 13};
+  vector<uint32_t> c = {2, 8, 14};
+  REQUIRE(PhraseQuery::count({}) == 0);
+  REQUIRE(PhraseQuery::count({a}) == 4);
+  REQUIRE(PhraseQuery::count({a, b}) == 3);
+  REQUIRE(PhraseQuery::count({a, b, c}) == 2);
+  REQUIRE(PhraseQuery::count({b, a}) == 0);
+  REQUIRE(PhraseQuery::count({a, span<const uint32_t>()}) == 0);
+
+  // a term twice in the phrase
+  vector<uint32_t> same = {3, 4, 5, 9};
+  REQUIRE(PhraseQuery::count({same, same}) == 2);
+  REQUIRE(PhraseQuery::count({same, same, same}) == 1);
+}
+
+TEST_CASE("InvertedIndex", "[Test_PhraseQuery]") {
+  InvertedIndex index(kDefaultDelims, true, true);
+  REQUIRE(index.has_positions());
+  REQUIRE(index.add_file(kHelloFileName) == 0);
+  REQUIRE(index.add_file(kByeFileName) == 1);
+
+  // goodbye world i am leaving you today goodbye goodbye goodbye
+  uint32_t goodbye = index.dictionary().find("goodbye").value();
+  REQUIRE(index.positions(goodbye) == vector<uint32_t>{0, 7, 8, 9});
+  uint32_t world = index.dictionary().find("world").value();
+  REQUIRE(index.positions(world) == vector<uint32_t>{1, 1});
+
+  REQUIRE(index.find_phrase({"hello", "world"}) ==
+          vector<Posting>{Posting{0, 1}});
+  REQUIRE(index.find_phrase({"World"}) ==
+          vector<Posting>{Posting{0, 1}, Posting{1, 1}});
+  REQUIRE(index.find_phrase({"goodbye", "goodbye"}) ==
+          vector<Posting>{Posting{1, 2}});
+  REQUIRE(index.find_phrase({"Goodbye", "World", "I"}) ==
+          vector<Posting>{Posting{1, 1}});
+  REQUIRE(index.find_phrase({"world", "goodbye"}).empty());
+  REQUIRE(index.find_phrase({"hello", "greetings"}).empty());
+  REQUIRE(index.find_phrase({}).empty());
+
+  // without positions there is nothing to match against
+  InvertedIndex plain;
+  plain.add_file(kByeFileName);
+  REQUIRE_FALSE(plain.has_positions());
+  REQUIRE(plain.positions(0).empty());
+  REQUIRE(plain.positions(plain.num_terms() - 1).empty());
+  REQUIRE(plain.find_phrase({"goodbye"}).empty());
+  REQUIRE(plain.memory_bytes() < index.memory_bytes());
+}
+
+TEST_CASE("Long", "[Test_PhraseQuery]") {
+  InvertedIndex index(kDefaultDelims, true, true);
+  REQUIRE(index.add_file(kLongFileName) == 0);
+  for (vector<string_view> phrase : vector<vector<string_view>>{
+           {"war", "and", "peace"},
+           {"the", "old", "prince"},
+           {"said", "prince", "andrew"},
+           {"of", "the"},
+           {"natasha"}}) {
+    uint32_t expected = count_phrase(kLongFileName, phrase);
+    vector<Posting> found = index.find_phrase(phrase);
+    if (expected == 0) {
+      REQUIRE(found.empty());
+    } else {
+      REQUIRE(found == vector<Posting>{Posting{0, expected}});
+    }
+  }
+  REQUIRE(index.find_phrase({"of", "the"})[0].freq > 1000);
+}
+
+TEST_CASE("Segment", "[Test_PhraseQuery]") {
+  // Enough short documents for the postings to span several blocks
+  mt19937 gen(5950);
+  vector<string> words = {"a", "b", "c", "d", "e"};
+  vector<TempFile> files;
+  files.reserve(600);
+  InvertedIndex index(kDefaultDelims, true, true);
+  for (uint32_t doc = 0; doc < 600; doc++) {
+    files.emplace_back("test_phrasequery_" + to_string(doc) + ".txt");
+    ofstream out(files.back().path);
+    size_t length = gen() % 40;
+    for (size_t i = 0; i < length; i++) {
+      out << words[gen() % words.size()] << (i % 9 == 8 ? "\n" : " ");
+    }
+    out.close();
+    REQUIRE(index.add_file(files.back().path) == doc);
+  }
+
+  TempFile file("test_phrasequery_segment.seg");
+  REQUIRE(SegmentWriter::write(index, file.path));
+  IndexSegment segment(file.path);
+  REQUIRE(segment.good());
+  REQUIRE(segment.has_positions());
+  REQUIRE_FALSE(filesystem::exists(file.path + ".positions"));
+
+  for (uint32_t id = 0; id < index.num_terms(); id++) {
+    SegmentPostings postings =
+        segment.postings(index.dictionary().term(id)).value();
+    REQUIRE(postings.has_positions());
+    REQUIRE(postings.num_blocks() > 1);
+    REQUIRE(postings.decode_positions() == index.positions(id));
+  }
+
+  for (int i = 0; i < 50; i++) {
+    vector<string_view> phrase;
+    size_t length = 1 + gen() % 4;
+    for (size_t j = 0; j < length; j++) {
+      phrase.push_back(words[gen() % words.size()]);
+    }
+    REQUIRE(segment.find_phrase(phrase) == index.find_phrase(phrase));
+  }
+  REQUIRE(segment.find_phrase({"a", "f"}).empty());
+  REQUIRE(segment.find_phrase({}).empty());
+
+  // A segment written without positions has none, and is smaller
+  InvertedIndex plain;
+  for (const TempFile &f : files) {
+    plain.add_file(f.path);
+  }
+  TempFile plain_file("test_phrasequery_plain.seg");
+  REQUIRE(SegmentWriter::write(plain, plain_file.path));
+  IndexSegment plain_segment(plain_file.path);
+  REQUIRE(plain_segment.good());
+  REQUIRE_FALSE(plain_segment.has_positions());
+  REQUIRE_FALSE(plain_segment.postings("a")->has_positions());
+  REQUIRE(plain_segment.find_phrase({"a"}).empty());
+  REQUIRE(plain_segment.file_bytes() < segment.file_bytes());
+
+  // the writer checks that the positions match the postings
+  TempFile bad("test_phrasequery_bad.seg");
+  {
+    SegmentWriter writer(bad.path, nullptr, true);
+    vector<uint32_t> positions = {0, 3};
+    PostingList list{{0}, {3}};
+    REQUIRE_FALSE(writer.add_term("a", list));
+    REQUIRE_FALSE(writer.add_term("a", list, &positions));
+  }
+  REQUIRE_FALSE(filesystem::exists(bad.path + ".positions"));
+}
+
+TEST_CASE("Merge", "[Test_PhraseQuery]") {
+  InvertedIndex first(kDefaultDelims, true, true);
+  first.add_file(kHelloFileName);
+  first.add_file(kByeFileName);
+  InvertedIndex second(kDefaultDelims, true, true);
+  second.add_directory(kTestFilesDir);
+  InvertedIndex plain;
+  plain.add_file(kByeFileName);
+
+  TempFile a("test_phrasequery_a.seg");
+  TempFile b("test_phrasequery_b.seg");
+  TempFile c("test_phrasequery_c.seg");
+  REQUIRE(SegmentWriter::write(first, a.path));
+  REQUIRE(SegmentWriter::write(second, b.path));
+  REQUIRE(SegmentWriter::write(plain, c.path));
+  IndexSegment sa(a.path);
+  IndexSegment sb(b.path);
+  IndexSegment sc(c.path);
+
+  TempFile merged_file("test_phrasequery_merged.seg");
+  REQUIRE(SegmentMerger::merge({&sa, &sb}, merged_file.path));
+  IndexSegment merged(merged_file.path);
+  REQUIRE(merged.has_positions());
+  for (vector<string_view> phrase : vector<vector<string_view>>{
+           {"goodbye", "goodbye"}, {"hello", "world"}, {"the", "old"}}) {
+    vector<Posting> expected = first.find_phrase(phrase);
+    for (Posting posting : second.find_phrase(phrase)) {
+      expected.push_back(Posting{posting.doc + 2, posting.freq});
+    }
+    REQUIRE(merged.find_phrase(phrase) == expected);
+  }
+
+  // with an input without positions the merged segment has none
+  TempFile mixed_file("test_phrasequery_mixed.seg");
+  REQUIRE(SegmentMerger::merge({&sa, &sc}, mixed_file.path));
+  IndexSegment mixed(mixed_file.path);
+  REQUIRE(mixed.good());
+  REQUIRE_FALSE(mixed.has_positions());
+  REQUIRE(mixed.postings("goodbye")->size() == 2);
+}
@@ -0,0 +1,26 @@
+#include "./RateLimiter.hpp"
+#include "catch.hpp"
+#include <chrono>
+
+using namespace std;
+
+TEST_CASE("Rate", "[Test_RateLimiter]") {
+  RateLimiter unlimited(0);
+  auto start = chrono::steady_clock::now();
+  for (int i = 0; i < 100; i++) {
+    unlimited.acquire(1 << 30);
+  }
+  REQUIRE(unlimited.waited_ms() == 0);
+
+  // 5 MB at 10 MB/s: the first is free, the other four wait 100ms each
+  RateLimiter limiter(10 * 1000 * 1000);
+  start = chrono::steady_clock::now();
+  for (int i = 0; i < 5; i++) {
+    limiter.acquire(1000 * 1000);
+  }
+  auto elapsed = chrono::duration_cast<chrono::milliseconds>(
+      chrono::steady_clock::now() - start);
+  REQUIRE(elapsed.count() >= 390);
+  REQUIRE(limiter.waited_ms() >= 390);
+  REQUIRE(elapsed.count() < 2000);
+}
@@ -0,0 +1,204 @@
+#include "./BufferedFileReader.hpp"
+#include "./Regex.hpp"
+#include "./TrigramIndex.hpp"
+#include "catch.hpp"
+#include <fstream>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kTestFilesDir = "./test_files";
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+// The leftmost longest matches of pattern in text, the slow way
+static vector<RegexMatch> naive_find_all(const string &pattern,
+                                         const string &text) {
+  std::regex re(pattern, std::regex::extended);
+  vector<RegexMatch> res;
+  size_t pos = 0;
+  for (size_t s = 0; s < text.length(); s++) {
+    if (s < pos) {
+      continue;
+    }
+    for (size_t e = text.length(); e > s; e--) {
+      if (std::regex_match(text.begin() + s, text.begin() + e, re)) {
+        res.push_back(RegexMatch{static_cast<off_t>(s), static_cast<off_t>(e)});
+        pos = e;
+        break;
+      }
+    }
+  }
+  return res;
+}
+
+// The ends that Regex::scan reports, the slow way
+static vector<off_t> naive_find_ends(const string &pattern,
+                                     const string &text) {
+  std::regex re(pattern, std::regex::extended);
+  vector<off_t> res;
+  size_t pos = 0;
+  for (size_t e = 1; e <= text.length(); e++) {
+    for (size_t s = pos; s < e; s++) {
+      if (std::regex_match(text.begin() + s, text.begin() + e, re)) {
+        res.push_back(static_cast<off_t>(e));
+        pos = e;
+        break;
+      }
+    }
+  }
+  return res;
+}
+
+TEST_CASE("Parsing", "[Test_Regex]") {
+  REQUIRE(Regex("abc").good());
+  REQUIRE(Regex("a(b|cd)*e+f?").good());
+  REQUIRE(Regex("[a-z_][^0-9]\\d\\w\\s\\.\\x41").good());
+  REQUIRE(Regex("x{3}y{2,}z{1,4}").good());
+  REQUIRE(Regex("[]a]").good());
+  REQUIRE(Regex("[a-]").good());
+
+  REQUIRE_FALSE(Regex("").good());
+  REQUIRE_FALSE(Regex("a*").good());  // matches the empty string
+  REQUIRE_FALSE(Regex("(a|)").good());
+  REQUIRE_FALSE(Regex("(ab").good());
+  REQUIRE_FALSE(Regex("ab)").good());
+  REQUIRE_FALSE(Regex("*a").good());
+  REQUIRE_FALSE(Regex("[abc").good());
+  REQUIRE_FALSE(Regex("[z-a]").good());
+  REQUIRE_FALSE(Regex("a{3,2}").good());
+  REQUIRE_FALSE(Regex("a{2000}").good());
+  REQUIRE_FALSE(Regex("^abc").good());
+  REQUIRE_FALSE(Regex("\\q").good());
+  REQUIRE_FALSE(Regex("\\xZZ").good());
+
+  Regex bad("(");
+  REQUIRE_FALSE(bad.matches("("));
+  REQUIRE(bad.find_all("(((").empty());
+  REQUIRE(bad.find_ends("(((").empty());
+}
+
+TEST_CASE("Matches", "[Test_Regex]") {
+  Regex re("a(b|cd)*e+");
+  REQUIRE(re.matches("ae"));
+  REQUIRE(re.matches("abcdbeee"));
+  REQUIRE_FALSE(re.matches("abc"));
+  REQUIRE_FALSE(re.matches("xae"));
+  REQUIRE_FALSE(re.matches(""));
+
+  Regex count("x{2,3}");
+  REQUIRE_FALSE(count.matches("x"));
+  REQUIRE(count.matches("xx"));
+  REQUIRE(count.matches("xxx"));
+  REQUIRE_FALSE(count.matches("xxxx"));
+
+  Regex classes("[A-Z][a-z]+\\s\\d+\\.");
+  REQUIRE(classes.matches("Chapter 12."));
+  REQUIRE_FALSE(classes.matches("chapter 12."));
+  REQUIRE_FALSE(Regex("a.b").matches("a\nb"));
+}
+
+TEST_CASE("Find", "[Test_Regex]") {
+  Regex re("Prince (Andrew|Vasili)");
+  string text = "Prince Vasili and Prince Andrew, not Prince Hippolyte";
+  REQUIRE(re.find_all(text) == vector<RegexMatch>{{0, 13}, {18, 31}});
+  REQUIRE(re.find_ends(text) == vector<off_t>{13, 31});
+
+  // leftmost, then longest
+  Regex longest("a+|b+a");
+  REQUIRE(longest.find_all("bbaaab") == vector<RegexMatch>{{0, 3}, {3, 5}});
+
+  // Against std::regex on random texts over a small alphabet
+  vector<string> patterns = {"a", "ab", "a+b", "(a|ab)(c|bcd)", "[ab]{2,3}",
+                             "(ab|b)+", "a.c", "(a|b)*c", "b(a*b)?",
+                             "(aa|ab|ba)+c?"};
+  mt19937 gen(5950);
+  for (const string &pattern : patterns) {
+    Regex re(pattern);
+    REQUIRE(re.good());
+    for (int i = 0; i < 20; i++) {
+      string text;
+      for (int j = 0; j < 30; j++) {
+        text += "abcd"[gen() % 4];
+      }
+      REQUIRE(re.find_all(text) == naive_find_all(pattern, text));
+      REQUIRE(re.find_ends(text) == naive_find_ends(pattern, text));
+    }
+  }
+}
+
+TEST_CASE("Linear", "[Test_Regex]") {
+  // Every a is a match, but extending it reads on to the end of the
+  // text looking for a c. Without remembering where that failed,
+  // finding all n matches would read n^2 / 2 bytes.
+  Regex re("a|a.*c");
+  string text(100000, 'a');
+  vector<RegexMatch> matches = re.find_all(text);
+  REQUIRE(matches.size() == text.length());
+  REQUIRE(matches.back() == RegexMatch{99999, 100000});
+  REQUIRE(re.num_extend_steps() <= 3 * text.length());
+
+  // the longest match still runs on past later starts
+  REQUIRE(re.find_all("aaac") == vector<RegexMatch>{{0, 4}});
+  REQUIRE(re.find_all("aaacaa") ==
+          vector<RegexMatch>{{0, 4}, {4, 5}, {5, 6}});
+}
+
+TEST_CASE("Cache Flush", "[Test_Regex]") {
+  // The DFA for this needs 2^13 states, more than are cached
+  Regex re("a[ab]{12}");
+  mt19937 gen(5950);
+  string text;
+  for (int i = 0; i < 50000; i++) {
+    text += "ab"[gen() % 2];
+  }
+
+  vector<off_t> expected;
+  size_t pos = 0;
+  for (size_t e = 13; e <= text.length(); e++) {
+    if (e - 13 >= pos && text[e - 13] == 'a') {
+      expected.push_back(static_cast<off_t>(e));
+      pos = e;
+    }
+  }
+  REQUIRE(re.find_ends(text) == expected);
+  REQUIRE(re.num_dfa_states() <= Regex::kMaxDfaStates);
+}
+
+TEST_CASE("Files", "[Test_Regex]") {
+  string contents{};
+  ifstream ifs(kLongFileName);
+  contents.assign((std::istreambuf_iterator<char>(ifs)),
+                  (std::istreambuf_iterator<char>()));
+
+  Regex re("Prince (Andrew|Vasili)");
+  vector<off_t> expected;
+  for (const RegexMatch &m : re.find_all(contents)) {
+    REQUIRE(m.end - m.start == 13);
+    expected.push_back(m.end);
+  }
+  REQUIRE(expected.size() > 100);
+
+  // streaming finds the same, across buffer refills
+  BufferedFileReader bf(kLongFileName);
+  REQUIRE(re.find_ends(bf) == expected);
+  REQUIRE(re.find_ends(contents) == expected);
+
+  // the literal narrows down an indexed search
+  REQUIRE(re.required_literals() == vector<string>{"Prince "});
+  TrigramIndex index;
+  index.add_directory(kTestFilesDir);
+  vector<string_view> literals;
+  for (const string &literal : re.required_literals()) {
+    literals.push_back(literal);
+  }
+  vector<uint32_t> files = index.candidate_files(literals);
+  REQUIRE(files.size() < index.num_files());
+  bool found = false;
+  for (uint32_t file : files) {
+    found = found || index.file_name(file) == kLongFileName;
+  }
+  REQUIRE(found);
+}
@@ -0,0 +1,132 @@
+#include "./IndexSegment.hpp"
+#include "./InvertedIndex.hpp"
+#include "./SegmentedIndex.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+TEST_CASE("Incremental", "[Test_SegmentedIndex]") {
+  TempDir dir("test_segmentedindex");
+  vector<string> files = test_files();
+  InvertedIndex expected;
+  for (const string &file : files) {
+    expected.add_file(file);
+  }
+
+  {
+    SegmentedIndex index(dir.path, 2);
+    REQUIRE(index.good());
+    REQUIRE(index.num_docs() == 0);
+    REQUIRE(index.postings("hello").size() == 0);
+
+    // each flush adds one small segment, and the merger combines them
+    for (size_t i = 0; i < files.size(); i++) {
+      REQUIRE(index.add_file(files[i]) == i);
+      REQUIRE(index.flush());
+    }
+    REQUIRE_FALSE(index.add_file("./test_files/not_a_file.txt"));
+    REQUIRE(index.flush());
+    index.wait_for_merges();
+    REQUIRE(index.num_merges() > 0);
+    REQUIRE(index.num_segments() < files.size());
+
+    REQUIRE(index.num_docs() == files.size());
+    for (uint32_t doc = 0; doc < files.size(); doc++) {
+      REQUIRE(index.doc_name(doc) == files[doc]);
+    }
+    REQUIRE(index.doc_name(100) == "");
+    const TermDictionary &dict = expected.dictionary();
+    for (uint32_t id = 0; id < expected.num_terms(); id += 7) {
+      PostingList list = index.postings(dict.term(id));
+      REQUIRE(list.docs == expected.postings(id).docs);
+      REQUIRE(list.freqs == expected.postings(id).freqs);
+    }
+    REQUIRE(index.postings("HELLO").docs == expected.postings("hello")->docs);
+
+    // added but not flushed: left to the destructor
+    REQUIRE(index.add_file(files[0]) == files.size());
+    REQUIRE(index.num_docs() == files.size());
+  }
+
+  // a stray segment, as if a merge had been cut short
+  ofstream(dir.path + "/999.seg") << "partial";
+
+  SegmentedIndex reopened(dir.path, 2);
+  REQUIRE(reopened.good());
+  REQUIRE_FALSE(filesystem::exists(dir.path + "/999.seg"));
+  REQUIRE(reopened.num_docs() == files.size() + 1);
+  REQUIRE(reopened.doc_name(files.size()) == files[0]);
+  PostingList goodbye = reopened.postings("goodbye");
+  REQUIRE(goodbye.docs.back() == files.size());
+
+  // the old segment files are gone once merged away
+  reopened.wait_for_merges();
+  size_t seg_files = 0;
+  for (const auto &entry : filesystem::directory_iterator(dir.path)) {
+    seg_files += entry.path().extension() == ".seg";
+  }
+  REQUIRE(seg_files == reopened.num_segments());
+}
+
+TEST_CASE("Phrase", "[Test_SegmentedIndex]") {
+  TempDir dir("test_segmentedindex_phrase");
+  vector<string> files = test_files();
+  InvertedIndex expected(kDefaultDelims, true, true);
+  for (const string &file : files) {
+    expected.add_file(file);
+  }
+
+  // one segment per file, so every document but the first is found
+  // through the doc base of its segment, before and after merging
+  SegmentedIndex index(dir.path, 2, 0, kDefaultDelims, true, true);
+  REQUIRE(index.good());
+  for (const string &file : files) {
+    index.add_file(file);
+    REQUIRE(index.flush());
+  }
+  vector<vector<string_view>> phrases = {
+      {"hello", "world"}, {"Goodbye", "goodbye"}, {"of", "the"},
+      {"mutual", "aid"},  {"the", "war", "of"},   {"world", "hello"}};
+  REQUIRE(index.find_phrase({"of", "the"}).size() > 1);
+  for (const vector<string_view> &phrase : phrases) {
+    REQUIRE(index.find_phrase(phrase) == expected.find_phrase(phrase));
+  }
+  index.wait_for_merges();
+  REQUIRE(index.num_merges() > 0);
+  for (const vector<string_view> &phrase : phrases) {
+    REQUIRE(index.find_phrase(phrase) == expected.find_phrase(phrase));
+  }
+  REQUIRE(index.find_phrase({}).empty());
+
+  // without positions there are no phrases to find
+  TempDir plain_dir("test_segmentedindex_plain");
+  SegmentedIndex plain(plain_dir.path);
+  plain.add_file(files[0]);
+  REQUIRE(plain.flush());
+  REQUIRE(plain.postings("goodbye").size() == 1);
+  REQUIRE(plain.find_phrase({"goodbye"}).empty());
+}
+
+TEST_CASE("Rate Limited Merge", "[Test_SegmentedIndex]") {
+  TempDir dir("test_segmentedindex_limited");
+  vector<string> files = test_files();
+  SegmentedIndex index(dir.path, 2, 4 * 1000 * 1000);
+  REQUIRE(index.good());
+  for (const string &file : files) {
+    index.add_file(file);
+    index.flush();
+  }
+  index.wait_for_merges();
+  REQUIRE(index.num_merges() > 0);
+  REQUIRE(index.num_docs() == files.size());
+
+  SegmentedIndex bad("/dev/null/index");
+  REQUIRE_FALSE(bad.good());
+  REQUIRE_FALSE(bad.add_file(files[0]).has_value());
+}
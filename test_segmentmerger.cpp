@@ -0,0 +1,93 @@
+#include "./IndexSegment.hpp"
+#include "./InvertedIndex.hpp"
+#include "./SegmentMerger.hpp"
+#include "./SegmentWriter.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+TEST_CASE("Pick Merge", "[Test_SegmentMerger]") {
+  constexpr uint64_t kSmall = SegmentMerger::kFloorBytes / 2;
+  constexpr uint64_t kMedium = SegmentMerger::kFloorBytes * 3;
+  constexpr uint64_t kLarge = SegmentMerger::kFloorBytes * 40;
+  REQUIRE(SegmentMerger::tier(kSmall, 4) == 0);
+  REQUIRE(SegmentMerger::tier(kMedium, 4) == 1);
+  REQUIRE(SegmentMerger::tier(kLarge, 4) == 3);
+
+  REQUIRE_FALSE(SegmentMerger::pick_merge({}, 4).has_value());
+  REQUIRE_FALSE(
+      SegmentMerger::pick_merge({kSmall, kSmall, kSmall}, 4).has_value());
+  REQUIRE(SegmentMerger::pick_merge({kSmall, kSmall, kSmall, kSmall}, 4) ==
+          MergeSpec{0, 4});
+
+  // only adjacent segments in the same tier are merged
+  REQUIRE_FALSE(SegmentMerger::pick_merge(
+                    {kSmall, kSmall, kMedium, kSmall, kSmall}, 4)
+                    .has_value());
+
+  // the lowest tier goes first
+  vector<uint64_t> sizes = {kMedium, kMedium, kMedium, kMedium,
+                            kSmall,  kSmall,  kSmall,  kSmall};
+  REQUIRE(SegmentMerger::pick_merge(sizes, 4) == MergeSpec{4, 4});
+  REQUIRE(SegmentMerger::pick_merge({kLarge, kSmall, kSmall}, 2) ==
+          MergeSpec{1, 2});
+}
+
+TEST_CASE("Merge", "[Test_SegmentMerger]") {
+  TempDir dir("test_segmentmerger");
+  filesystem::create_directories(dir.path);
+
+  // One segment per file, merged, against one index of every file
+  vector<string> files = test_files();
+  InvertedIndex expected;
+  vector<string> names;
+  for (size_t i = 0; i < files.size(); i++) {
+    REQUIRE(expected.add_file(files[i]).has_value());
+    InvertedIndex single;
+    REQUIRE(single.add_file(files[i]).has_value());
+    names.push_back(dir.path + "/" + to_string(i) + ".seg");
+    REQUIRE(SegmentWriter::write(single, names.back()));
+  }
+
+  vector<IndexSegment> segments;
+  vector<const IndexSegment *> inputs;
+  for (const string &name : names) {
+    segments.emplace_back(name);
+  }
+  for (const IndexSegment &segment : segments) {
+    REQUIRE(segment.good());
+    inputs.push_back(&segment);
+  }
+  string merged_name = dir.path + "/merged.seg";
+  REQUIRE(SegmentMerger::merge(inputs, merged_name));
+
+  IndexSegment merged(merged_name);
+  REQUIRE(merged.good());
+  REQUIRE(merged.num_docs() == expected.num_docs());
+  REQUIRE(merged.num_terms() == expected.num_terms());
+  REQUIRE(merged.num_postings() == expected.num_postings());
+  REQUIRE(merged.total_tokens() == expected.total_tokens());
+  for (uint32_t doc = 0; doc < expected.num_docs(); doc++) {
+    REQUIRE(merged.doc_name(doc) == expected.doc_name(doc));
+  }
+  const TermDictionary &dict = expected.dictionary();
+  for (uint32_t id = 0; id < expected.num_terms(); id++) {
+    PostingList list = merged.postings(dict.term(id)).value().decode();
+    REQUIRE(list.docs == expected.postings(id).docs);
+    REQUIRE(list.freqs == expected.postings(id).freqs);
+  }
+
+  // merging one segment copies it, merging none gives an empty segment
+  REQUIRE(SegmentMerger::merge({&segments[0]}, dir.path + "/copy.seg"));
+  IndexSegment copy(dir.path + "/copy.seg");
+  REQUIRE(copy.num_terms() == segments[0].num_terms());
+  REQUIRE(SegmentMerger::merge({}, dir.path + "/empty.seg"));
+  IndexSegment empty(dir.path + "/empty.seg");
+  REQUIRE(empty.good());
+  REQUIRE(empty.num_terms() == 0);
+  REQUIRE_FALSE(empty.postings("a").has_value());
+}
@@ -0,0 +1,108 @@
+#include "./BufferedFileReader.hpp"
+#include "./StemCache.hpp"
+#include "./Stemmer.hpp"
+#include "catch.hpp"
+#include <string>
+
+using namespace std;
+
+static constexpr const char *kGreatFileName = "./test_files/mutual_aid.txt";
+
+TEST_CASE("Basic", "[Test_Stemmer]") {
+  Stemmer s;
+  REQUIRE(s.stem("caresses") == "caress");
+  REQUIRE(s.stem("ponies") == "poni");
+  REQUIRE(s.stem("ties") == "ti");
+  REQUIRE(s.stem("caress") == "caress");
+  REQUIRE(s.stem("cats") == "cat");
+  REQUIRE(s.stem("feed") == "feed");
+  REQUIRE(s.stem("agreed") == "agre");
+  REQUIRE(s.stem("plastered") == "plaster");
+  REQUIRE(s.stem("motoring") == "motor");
+  REQUIRE(s.stem("sing") == "sing");
+  REQUIRE(s.stem("conflated") == "conflat");
+  REQUIRE(s.stem("troubled") == "troubl");
+  REQUIRE(s.stem("sized") == "size");
+  REQUIRE(s.stem("hopping") == "hop");
+  REQUIRE(s.stem("tanned") == "tan");
+  REQUIRE(s.stem("falling") == "fall");
+  REQUIRE(s.stem("hissing") == "hiss");
+  REQUIRE(s.stem("fizzed") == "fizz");
+  REQUIRE(s.stem("failing") == "fail");
+  REQUIRE(s.stem("filing") == "file");
+  REQUIRE(s.stem("happy") == "happi");
+  REQUIRE(s.stem("relational") == "relat");
+  REQUIRE(s.stem("conditional") == "condit");
+  REQUIRE(s.stem("generalization") == "gener");
+  REQUIRE(s.stem("connections") == "connect");
+  REQUIRE(s.stem("connected") == "connect");
+  REQUIRE(s.stem("electricity") == "electr");
+  REQUIRE(s.stem("hopefulness") == "hope");
+}
+
+TEST_CASE("Edge Cases", "[Test_Stemmer]") {
+  Stemmer s;
+  REQUIRE(s.stem("") == "");
+  REQUIRE(s.stem("is") == "is");
+  REQUIRE(s.stem("Running") == "run");
+  REQUIRE(s.stem("WAR") == "war");
+
+  // not plain words, only case folded
+  REQUIRE(s.stem("Project,") == "project,");
+  REQUIRE(s.stem("1812") == "1812");
+
+  // too long to stem in place
+  string long_word(Stemmer::kMaxWordLen + 1, 'a');
+  REQUIRE(s.stem(long_word) == long_word);
+}
+
+TEST_CASE("Cache", "[Test_StemCache]") {
+  StemCache cache(4);
+  REQUIRE(cache.capacity() == 4);
+
+  REQUIRE(cache.stem("connections") == "connect");
+  REQUIRE(cache.misses() == 1);
+  REQUIRE(cache.stem("connections") == "connect");
+  REQUIRE(cache.hits() == 1);
+
+  // longer than anything the cache can hold, always misses
+  string long_word = "antidisestablishmentarianism";
+  REQUIRE(long_word.length() > StemCache::kMaxCachedLen);
+  REQUIRE(cache.stem(long_word) == "antidisestablishmentarian");
+  REQUIRE(cache.stem(long_word) == "antidisestablishmentarian");
+  REQUIRE(cache.hits() == 1);
+  REQUIRE(cache.misses() == 3);
+
+  // overflow the cache, answers should not change
+  const char *words[] = {"cats", "ponies", "hopping", "relational",
+                         "motoring", "troubled", "connections"};
+  for (int i = 0; i < 3; i++) {
+    REQUIRE(cache.stem(words[0]) == "cat");
+    REQUIRE(cache.stem(words[1]) == "poni");
+    REQUIRE(cache.stem(words[2]) == "hop");
+    REQUIRE(cache.stem(words[3]) == "relat");
+    REQUIRE(cache.stem(words[4]) == "motor");
+    REQUIRE(cache.stem(words[5]) == "troubl");
+    REQUIRE(cache.stem(words[6]) == "connect");
+  }
+}
+
+TEST_CASE("Tokens", "[Test_StemCache]") {
+  // The cache must agree with the stemmer on every token of a real file
+  BufferedFileReader bf(kGreatFileName);
+  StemCache cache;
+  Stemmer s;
+  uint64_t count = 0;
+
+  while (bf.good()) {
+    optional<string> opt = bf.get_token();
+    REQUIRE(opt.has_value());
+    string cached(cache.stem(opt.value()));
+    REQUIRE(cached == s.stem(opt.value()));
+    count++;
+  }
+
+  REQUIRE(cache.hits() + cache.misses() == count);
+  // Zipf's law: a modest cache answers most lookups
+  REQUIRE(cache.hits() > cache.misses());
+}
@@ -0,0 +1,106 @@
+#include "./BufferedFileReader.hpp"
+#include "./StopwordFilter.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+static constexpr const char *kGreatFileName = "./test_files/mutual_aid.txt";
+static constexpr const char *kMissingFileName = "./test_files/not_a_file.txt";
+
+TEST_CASE("Basic", "[Test_StopwordFilter]") {
+  StopwordFilter filter;
+  REQUIRE(filter.size() == 179);
+
+  REQUIRE(filter.is_stopword("the"));
+  REQUIRE(filter.is_stopword("The"));
+  REQUIRE(filter.is_stopword("THE"));
+  REQUIRE(filter.is_stopword("a"));
+  REQUIRE(filter.is_stopword("i"));
+  REQUIRE(filter.is_stopword("themselves"));
+  REQUIRE(filter.is_stopword("shouldn't"));
+
+  REQUIRE_FALSE(filter.is_stopword(""));
+  REQUIRE_FALSE(filter.is_stopword("war"));
+  REQUIRE_FALSE(filter.is_stopword("peace"));
+  REQUIRE_FALSE(filter.is_stopword("the,"));
+  REQUIRE_FALSE(filter.is_stopword("them "));
+  REQUIRE_FALSE(filter.is_stopword("theme"));
+  REQUIRE_FALSE(filter.is_stopword("themselvesx"));
+  REQUIRE_FALSE(filter.is_stopword(string(1000, 'a')));
+}
+
+TEST_CASE("load_file", "[Test_StopwordFilter]") {
+  StopwordFilter filter;
+
+  // a missing file keeps the current list
+  REQUIRE_FALSE(filter.load_file(kMissingFileName));
+  REQUIRE(filter.size() == 179);
+  REQUIRE(filter.is_stopword("which"));
+
+  TempFile stopwords("test_stopwordfilter_stopwords.txt");
+  ofstream out(stopwords.path);
+  out << "the of and\nTo  IN\na\nmutual aid\nthe\n";
+  out.close();
+
+  REQUIRE(filter.load_file(stopwords.path));
+  REQUIRE(filter.size() == 8);
+  REQUIRE(filter.is_stopword("the"));
+  REQUIRE(filter.is_stopword("Of"));
+  REQUIRE(filter.is_stopword("and"));
+  REQUIRE(filter.is_stopword("to"));
+  REQUIRE(filter.is_stopword("in"));
+  REQUIRE(filter.is_stopword("a"));
+  REQUIRE(filter.is_stopword("mutual"));
+  REQUIRE(filter.is_stopword("AID"));
+  REQUIRE_FALSE(filter.is_stopword("which"));
+  REQUIRE_FALSE(filter.is_stopword("mutual aid"));
+
+  // loading again replaces the list
+  REQUIRE(filter.load_file(stopwords.path));
+  REQUIRE(filter.size() == 8);
+  REQUIRE(filter.is_stopword("aid"));
+
+  // a word longer than kMaxWordLength keeps the current list
+  string longest(StopwordFilter::kMaxWordLength, 'x');
+  TempFile too_long("test_stopwordfilter_too_long.txt");
+  out.open(too_long.path);
+  out << "war " << longest << "x peace\n";
+  out.close();
+  REQUIRE_FALSE(filter.load_file(too_long.path));
+  REQUIRE(filter.size() == 8);
+  REQUIRE(filter.is_stopword("aid"));
+  REQUIRE_FALSE(filter.is_stopword("war"));
+
+  // one of exactly kMaxWordLength is fine
+  out.open(too_long.path);
+  out << "war " << longest << " peace\n";
+  out.close();
+  REQUIRE(filter.load_file(too_long.path));
+  REQUIRE(filter.size() == 3);
+  REQUIRE(filter.is_stopword(longest));
+  REQUIRE_FALSE(filter.is_stopword(longest + "x"));
+}
+
+TEST_CASE("Tokens", "[Test_StopwordFilter]") {
+  BufferedFileReader bf(kGreatFileName);
+  StopwordFilter filter;
+  uint64_t words = 0;
+  uint64_t stopwords = 0;
+
+  while (bf.good()) {
+    optional<string> opt = bf.get_token();
+    REQUIRE(opt.has_value());
+    if (opt.value().empty()) {
+      continue;
+    }
+    words++;
+    if (filter.is_stopword(opt.value())) {
+      stopwords++;
+    }
+  }
+
+  REQUIRE(stopwords * 10 > words * 4);
+}
@@ -0,0 +1,120 @@
+#include "./BufferedFileReader.hpp"
+#include "./SimpleFileReader.hpp"
+#include "./SubstringSearcher.hpp"
+#include "catch.hpp"
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kHelloFileName = "./test_files/Hello.txt";
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+// Finds every occurrence of needle in text the slow way
+static vector<off_t> naive_find_all(const string &text, const string &needle) {
+  vector<off_t> res;
+  if (needle.empty()) {
+    return res;
+  }
+  size_t pos = text.find(needle);
+  while (pos != string::npos) {
+    res.push_back(static_cast<off_t>(pos));
+    pos = text.find(needle, pos + 1);
+  }
+  return res;
+}
+
+TEST_CASE("Basic", "[Test_SubstringSearcher]") {
+  REQUIRE(find_all("abracadabra", "abra") == vector<off_t>{0, 7});
+  REQUIRE(find_all("abracadabra", "a") == vector<off_t>{0, 3, 5, 7, 10});
+  REQUIRE(find_all("abracadabra", "cad") == vector<off_t>{4});
+  REQUIRE(find_all("abracadabra", "abracadabra") == vector<off_t>{0});
+  REQUIRE(find_all("abracadabra", "zebra").empty());
+  REQUIRE(find_all("abra", "abracadabra").empty());
+  REQUIRE(find_all("abracadabra", "").empty());
+
+  // overlapping occurrences are all reported
+  REQUIRE(find_all("aaaaa", "aa") == vector<off_t>{0, 1, 2, 3});
+
+  SubstringSearcher s("World");
+  REQUIRE(s.needle() == "World");
+  BufferedFileReader bf(kHelloFileName);
+  REQUIRE(s.find_all(bf) == vector<off_t>{6});
+  SimpleFileReader sf(kHelloFileName);
+  REQUIRE(s.find_all(sf) == vector<off_t>{6});
+}
+
+TEST_CASE("Long Needles", "[Test_SubstringSearcher]") {
+  // Two-Way, both for periodic and non periodic needles
+  string periodic(100, 'a');
+  string text(1000, 'a');
+  vector<off_t> res = find_all(text, periodic);
+  REQUIRE(res.size() == 901);
+  REQUIRE(res == naive_find_all(text, periodic));
+
+  string abab;
+  for (int i = 0; i < 40; i++) {
+    abab += "ab";
+  }
+  string abab_text = abab + "ab" + abab + "ba" + abab + abab;
+  REQUIRE(find_all(abab_text, abab) == naive_find_all(abab_text, abab));
+
+  string words;
+  for (int i = 0; i < 100; i++) {
+    words += "the quick brown fox jumps over the lazy dog " + to_string(i);
+  }
+  string needle = words.substr(1234, 150);
+  REQUIRE(needle.length() > SubstringSearcher::kTwoWayThreshold);
+  REQUIRE(find_all(words, needle) == vector<off_t>{1234});
+}
+
+TEST_CASE("Files", "[Test_SubstringSearcher]") {
+  string contents{};
+  ifstream ifs(kLongFileName);
+  contents.assign((std::istreambuf_iterator<char>(ifs)),
+                  (std::istreambuf_iterator<char>()));
+
+  // Needles of every length class, including long ones that are
+  // sure to span a buffer refill of the BufferedFileReader
+  vector<string> needles = {"e", "Natasha", "Prince Andrew", "the",
+                            "\n\n", contents.substr(1000, 64),
+                            contents.substr(5000, 3000)};
+  for (const string &needle : needles) {
+    vector<off_t> expected = naive_find_all(contents, needle);
+    REQUIRE_FALSE(expected.empty());
+
+    REQUIRE(find_all(contents, needle) == expected);
+    BufferedFileReader bf(kLongFileName);
+    REQUIRE(find_all(bf, needle) == expected);
+    SimpleFileReader sf(kLongFileName);
+    REQUIRE(find_all(sf, needle) == expected);
+  }
+
+  // Occurrences that cross every possible buffer boundary
+  SubstringSearcher s(contents.substr(1020, 10));
+  BufferedFileReader bf(kLongFileName);
+  vector<off_t> res = s.find_all(bf);
+  REQUIRE(res == naive_find_all(contents, s.needle()));
+  REQUIRE(res.front() == 1020);
+}
+
+TEST_CASE("Partial Reads", "[Test_SubstringSearcher]") {
+  // Searching starts where the reader is, offsets stay file offsets
+  BufferedFileReader bf(kLongFileName);
+  REQUIRE(bf.get_token().has_value());
+  off_t start = bf.tell();
+
+  string contents{};
+  ifstream ifs(kLongFileName);
+  contents.assign((std::istreambuf_iterator<char>(ifs)),
+                  (std::istreambuf_iterator<char>()));
+  vector<off_t> expected;
+  for (off_t off : naive_find_all(contents, "Project")) {
+    if (off >= start) {
+      expected.push_back(off);
+    }
+  }
+  REQUIRE(find_all(bf, "Project") == expected);
+  REQUIRE_FALSE(bf.good());
+}
@@ -0,0 +1,140 @@
+#include "./SuffixArray.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kHelloFileName = "./test_files/Hello.txt";
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+static void write_file(const string &fname, const string &contents) {
+  ofstream ofs(fname, ios::binary);
+  ofs << contents;
+}
+
+// Finds every occurrence of pattern in text the slow way
+static vector<off_t> naive_locate(const string &text, const string &pattern) {
+  vector<off_t> res;
+  size_t pos = text.find(pattern);
+  while (pos != string::npos) {
+    res.push_back(static_cast<off_t>(pos));
+    pos = text.find(pattern, pos + 1);
+  }
+  return res;
+}
+
+TEST_CASE("Basic", "[Test_SuffixArray]") {
+  TempFile text("test_suffixarray_banana.txt");
+  TempFile index("test_suffixarray_banana.sa");
+  write_file(text.path, "banana");
+  REQUIRE(SuffixArray::build(text.path, index.path));
+
+  SuffixArray sa(text.path, index.path);
+  REQUIRE(sa.good());
+  REQUIRE(sa.size() == 6);
+
+  // a, ana, anana, banana, na, nana
+  off_t expected_sa[] = {5, 3, 1, 0, 4, 2};
+  size_t expected_lcp[] = {0, 1, 3, 0, 0, 2};
+  for (size_t rank = 0; rank < 6; rank++) {
+    REQUIRE(sa.suffix(rank) == expected_sa[rank]);
+    REQUIRE(sa.lcp(rank) == expected_lcp[rank]);
+  }
+
+  REQUIRE(sa.count("ana") == 2);
+  REQUIRE(sa.locate("ana") == vector<off_t>{1, 3});
+  REQUIRE(sa.locate("a") == vector<off_t>{1, 3, 5});
+  REQUIRE(sa.count("banana") == 1);
+  REQUIRE(sa.count("bananas") == 0);
+  REQUIRE(sa.count("x") == 0);
+  REQUIRE(sa.count("") == 0);
+  REQUIRE(sa.longest_repeat() == "ana");
+
+  // an index for another document is rejected
+  SuffixArray wrong(kHelloFileName, index.path);
+  REQUIRE_FALSE(wrong.good());
+  REQUIRE(wrong.count("a") == 0);
+  SuffixArray missing(text.path, "./test_files/not_a_file.sa");
+  REQUIRE_FALSE(missing.good());
+  REQUIRE_FALSE(SuffixArray::build("./test_files/not_a_file.txt", index.path));
+}
+
+TEST_CASE("Random", "[Test_SuffixArray]") {
+  TempFile text("test_suffixarray_random.txt");
+  TempFile index("test_suffixarray_random.sa");
+  mt19937 gen(5950);
+
+  // Small alphabets give many long repeats, the hard case for SA-IS
+  for (int alphabet : {1, 2, 3, 26, 256}) {
+    for (int len : {0, 1, 2, 3, 17, 500}) {
+      string s;
+      for (int i = 0; i < len; i++) {
+        s += static_cast<char>('a' + gen() % alphabet);
+      }
+      write_file(text.path, s);
+      REQUIRE(SuffixArray::build(text.path, index.path));
+      SuffixArray sa(text.path, index.path);
+      REQUIRE(sa.good());
+      REQUIRE(sa.size() == s.length());
+
+      vector<off_t> expected(s.length());
+      for (size_t i = 0; i < s.length(); i++) {
+        expected[i] = i;
+      }
+      sort(expected.begin(), expected.end(), [&](off_t a, off_t b) {
+        return s.compare(a, string::npos, s, b, string::npos) < 0;
+      });
+      for (size_t rank = 0; rank < s.length(); rank++) {
+        REQUIRE(sa.suffix(rank) == expected[rank]);
+        if (rank > 0) {
+          size_t h = 0;
+          while (expected[rank] + h < s.length() &&
+                 expected[rank - 1] + h < s.length() &&
+                 s[expected[rank] + h] == s[expected[rank - 1] + h]) {
+            h++;
+          }
+          REQUIRE(sa.lcp(rank) == h);
+        }
+      }
+
+      for (int i = 0; i < 20 && len > 0; i++) {
+        size_t start = gen() % s.length();
+        string pattern = s.substr(start, 1 + gen() % 5);
+        REQUIRE(sa.locate(pattern) == naive_locate(s, pattern));
+      }
+    }
+  }
+}
+
+TEST_CASE("Long File", "[Test_SuffixArray]") {
+  TempFile index("test_suffixarray_war_and_peace.sa");
+  REQUIRE(SuffixArray::build(kLongFileName, index.path));
+  SuffixArray sa(kLongFileName, index.path);
+  REQUIRE(sa.good());
+
+  string contents{};
+  ifstream ifs(kLongFileName);
+  contents.assign((std::istreambuf_iterator<char>(ifs)),
+                  (std::istreambuf_iterator<char>()));
+  REQUIRE(sa.size() == contents.length());
+
+  vector<string> patterns = {"Natasha", "Prince Andrew", "the", "e",
+                             "Well, Prince, so Genoa and Lucca",
+                             "not in the book", contents.substr(123456, 200)};
+  for (const string &pattern : patterns) {
+    vector<off_t> expected = naive_locate(contents, pattern);
+    REQUIRE(sa.count(pattern) == expected.size());
+    REQUIRE(sa.locate(pattern) == expected);
+  }
+
+  // the longest repeat occurs at least twice, and nothing longer does
+  string_view repeat = sa.longest_repeat();
+  REQUIRE(repeat.length() > 0);
+  REQUIRE(sa.count(repeat) >= 2);
+}
@@ -0,0 +1,89 @@
+#include "./BufferedFileReader.hpp"
+#include "./TermDictionary.hpp"
+#include "catch.hpp"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kHelloFileName = "./test_files/Hello.txt";
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+TEST_CASE("Basic", "[Test_TermDictionary]") {
+  TermDictionary dict;
+  REQUIRE(dict.size() == 0);
+  REQUIRE_FALSE(dict.find("hello").has_value());
+
+  REQUIRE(dict.intern("hello") == 0);
+  REQUIRE(dict.intern("world") == 1);
+  REQUIRE(dict.intern("hello") == 0);
+  REQUIRE(dict.intern("") == 2);
+  REQUIRE(dict.intern("") == 2);
+  REQUIRE(dict.size() == 3);
+  REQUIRE(dict.arena_bytes() == 10);
+
+  REQUIRE(dict.term(0) == "hello");
+  REQUIRE(dict.term(1) == "world");
+  REQUIRE(dict.term(2) == "");
+  REQUIRE(dict.find("world").value() == 1);
+  REQUIRE_FALSE(dict.find("worl").has_value());
+  REQUIRE_FALSE(dict.find("worlds").has_value());
+
+  dict.clear();
+  REQUIRE(dict.size() == 0);
+  REQUIRE_FALSE(dict.find("hello").has_value());
+  REQUIRE(dict.intern("world") == 0);
+}
+
+TEST_CASE("Growth", "[Test_TermDictionary]") {
+  TermDictionary dict;
+  for (uint32_t i = 0; i < 100000; i++) {
+    // growth_bytes bounds what interning a new term adds
+    string term = to_string(i);
+    size_t before = dict.memory_bytes();
+    size_t growth = dict.growth_bytes(term.length());
+    REQUIRE(dict.intern(term) == i);
+    REQUIRE(dict.memory_bytes() <= before + growth);
+    REQUIRE((growth == 0) == (dict.memory_bytes() == before));
+  }
+  REQUIRE(dict.size() == 100000);
+  REQUIRE(dict.memory_bytes() >= dict.arena_bytes() + 100000 * 12);
+  for (uint32_t i = 0; i < 100000; i++) {
+    string term = to_string(i);
+    REQUIRE(dict.find(term).value() == i);
+    REQUIRE(dict.term(i) == term);
+  }
+}
+
+TEST_CASE("get_token_id", "[Test_TermDictionary]") {
+  TermDictionary dict;
+  BufferedFileReader bf(kHelloFileName);
+  REQUIRE(bf.get_token_id(dict).value() == 0);
+  REQUIRE(dict.term(0) == "Hello");
+  bf.close_file();
+  REQUIRE_FALSE(bf.get_token_id(dict).has_value());
+
+  // ids must match the tokens from get_token, including
+  // tokens that span a refill of the buffer
+  string delims = ",\n ";
+  BufferedFileReader ids(kLongFileName);
+  BufferedFileReader tokens(kLongFileName);
+  vector<uint32_t> seen;
+  while (tokens.good()) {
+    optional<string> token = tokens.get_token(delims);
+    optional<uint32_t> id = ids.get_token_id(dict, delims);
+    REQUIRE(token.has_value());
+    REQUIRE(id.has_value());
+    REQUIRE(dict.term(id.value()) == token.value());
+    REQUIRE(ids.tell() == tokens.tell());
+    seen.push_back(id.value());
+  }
+  REQUIRE_FALSE(ids.good());
+  REQUIRE_FALSE(ids.get_token_id(dict, delims).has_value());
+
+  // a second pass hands out the same ids
+  ids.rewind();
+  for (uint32_t id : seen) {
+    REQUIRE(ids.get_token_id(dict, delims).value() == id);
+  }
+}
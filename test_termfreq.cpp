@@ -0,0 +1,68 @@
+#include "./BufferedFileReader.hpp"
+#include "./TermFreq.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kHelloFileName = "./test_files/Hello.txt";
+static constexpr const char *kByeFileName = "./test_files/Bye.txt";
+static constexpr const char *kTestDirName = "./test_files";
+
+TEST_CASE("Basic", "[Test_TermFreq]") {
+  TermFreqCounter counter(2);
+  REQUIRE(counter.num_threads() == 2);
+
+  TermFreqResult result = counter.count_files({kHelloFileName, kByeFileName});
+  REQUIRE(result.files == 2);
+  REQUIRE(result.counts["hello"] == 1);
+  REQUIRE(result.counts["world"] == 2);
+  REQUIRE(result.counts["goodbye"] == 4);
+  REQUIRE(result.counts.count("Goodbye") == 0);
+  REQUIRE(result.counts.count("") == 0);
+
+  vector<pair<string, uint64_t>> top = result.top(2);
+  REQUIRE(top.size() == 2);
+  REQUIRE(top[0].first == "goodbye");
+
+  // missing files are skipped
+  result = counter.count_files({"./test_files/not_a_file.txt"});
+  REQUIRE(result.files == 0);
+  REQUIRE(result.total_tokens == 0);
+
+  REQUIRE_FALSE(counter.count_directory("./not_a_dir").has_value());
+}
+
+TEST_CASE("Directory", "[Test_TermFreq]") {
+  // count one file at a time with get_token to compare against
+  string delims = kDefaultDelims;
+  TermCounts expected;
+  uint64_t expected_tokens = 0;
+  vector<string> files = test_files();
+  for (const string &fname : files) {
+    BufferedFileReader bf(fname);
+    while (bf.good()) {
+      string token = bf.get_token(delims).value();
+      if (token.empty()) {
+        continue;
+      }
+      for (char &c : token) {
+        c = tolower(c);
+      }
+      expected[token]++;
+      expected_tokens++;
+    }
+  }
+
+  for (size_t threads : {1, 3, 8}) {
+    TermFreqCounter counter(threads, delims);
+    optional<TermFreqResult> result = counter.count_directory(kTestDirName);
+    REQUIRE(result.has_value());
+    REQUIRE(result->files == files.size());
+    REQUIRE(result->total_tokens == expected_tokens);
+    REQUIRE(result->distinct_terms() == expected.size());
+    REQUIRE(result->counts == expected);
+  }
+}
@@ -0,0 +1,233 @@
+#include "./BufferedFileReader.hpp"
+#include "./CountMinSketch.hpp"
+#include "./HyperLogLog.hpp"
+#include "./SpaceSaving.hpp"
+#include "./TermSketch.hpp"
+#include "catch.hpp"
+#include <cmath>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kGreatFileName = "./test_files/mutual_aid.txt";
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+// Every non empty token of a file
+static vector<string> read_tokens(const char *fname) {
+  BufferedFileReader bf(fname);
+  vector<string> tokens;
+  bf.for_each_token(" \t\n\r\v\f", [&tokens](string_view token) {
+    if (!token.empty()) {
+      tokens.emplace_back(token);
+    }
+  });
+  return tokens;
+}
+
+TEST_CASE("Basic", "[Test_SpaceSaving]") {
+  SpaceSaving ss(3);
+  REQUIRE(ss.capacity() == 3);
+  ss.add("a", 5);
+  ss.add("b", 3);
+  ss.add("c");
+  REQUIRE(ss.size() == 3);
+  REQUIRE(ss.estimate("d") == 1);
+
+  // "d" takes over the counter of "c"
+  ss.add("d");
+  REQUIRE(ss.size() == 3);
+  vector<HeavyHitter> top = ss.top(3);
+  REQUIRE(top[0].term == "a");
+  REQUIRE(top[0].count == 5);
+  REQUIRE(top[0].error == 0);
+  REQUIRE(top[1].term == "b");
+  REQUIRE(top[2].term == "d");
+  REQUIRE(top[2].count == 2);
+  REQUIRE(top[2].error == 1);
+  REQUIRE(ss.total() == 10);
+  REQUIRE(ss.top(1).size() == 1);
+}
+
+TEST_CASE("Tokens", "[Test_SpaceSaving]") {
+  vector<string> tokens = read_tokens(kLongFileName);
+  unordered_map<string, uint64_t> exact;
+  SpaceSaving ss(500);
+  for (const string &token : tokens) {
+    exact[token]++;
+    ss.add(token);
+  }
+
+  // Every count is within its error bound
+  for (const HeavyHitter &h : ss.top(ss.size())) {
+    REQUIRE(h.count >= exact[h.term]);
+    REQUIRE(h.count - h.error <= exact[h.term]);
+  }
+
+  // Anything more frequent than total / capacity is in there,
+  // which is the case for the 20 most common words
+  vector<pair<uint64_t, string>> sorted;
+  for (auto &[term, count] : exact) {
+    sorted.emplace_back(count, term);
+  }
+  sort(sorted.rbegin(), sorted.rend());
+  vector<HeavyHitter> top = ss.top(20);
+  for (size_t i = 0; i < 20; i++) {
+    REQUIRE(sorted[i].first > tokens.size() / ss.capacity());
+    REQUIRE(top[i].term == sorted[i].second);
+  }
+}
+
+TEST_CASE("Merge", "[Test_SpaceSaving]") {
+  vector<string> war = read_tokens(kLongFileName);
+  vector<string> aid = read_tokens(kGreatFileName);
+  unordered_map<string, uint64_t> exact;
+  SpaceSaving a(500);
+  SpaceSaving b(500);
+  for (const string &token : war) {
+    exact[token]++;
+    a.add(token);
+  }
+  for (const string &token : aid) {
+    exact[token]++;
+    b.add(token);
+  }
+  a.merge(b);
+  REQUIRE(a.total() == war.size() + aid.size());
+  REQUIRE(a.size() == 500);
+
+  for (const HeavyHitter &h : a.top(a.size())) {
+    REQUIRE(h.count >= exact[h.term]);
+    REQUIRE(h.count - h.error <= exact[h.term]);
+  }
+  REQUIRE(a.top(1)[0].term == "the");
+}
+
+TEST_CASE("Estimates", "[Test_CountMinSketch]") {
+  vector<string> tokens = read_tokens(kLongFileName);
+  unordered_map<string, uint64_t> exact;
+  CountMinSketch cms(4096, 4);
+  REQUIRE(cms.memory_bytes() == 4096 * 4 * sizeof(uint64_t));
+  for (const string &token : tokens) {
+    exact[token]++;
+    cms.add(token);
+  }
+  REQUIRE(cms.total() == tokens.size());
+
+  // Never low, and almost always within e * total / width
+  double bound = exp(1.0) * tokens.size() / cms.width();
+  size_t outside = 0;
+  for (auto &[term, count] : exact) {
+    uint64_t estimate = cms.estimate(term);
+    REQUIRE(estimate >= count);
+    outside += (estimate - count > bound);
+  }
+  REQUIRE(outside < exact.size() / 20);
+  REQUIRE(cms.estimate("the") >= exact["the"]);
+}
+
+TEST_CASE("Merge", "[Test_CountMinSketch]") {
+  CountMinSketch a(1024, 3);
+  CountMinSketch b(1024, 3);
+  CountMinSketch both(1024, 3);
+  for (const string &token : read_tokens(kGreatFileName)) {
+    a.add(token);
+    both.add(token);
+  }
+  for (const string &token : read_tokens(kLongFileName)) {
+    b.add(token);
+    both.add(token);
+  }
+  REQUIRE(a.merge(b));
+  REQUIRE(a.total() == both.total());
+  for (const char *term : {"the", "Natasha", "mutual", "aid", "zebra"}) {
+    REQUIRE(a.estimate(term) == both.estimate(term));
+  }
+
+  CountMinSketch other(512, 3);
+  REQUIRE_FALSE(a.merge(other));
+  REQUIRE(a.total() == both.total());
+}
+
+TEST_CASE("Distinct", "[Test_HyperLogLog]") {
+  HyperLogLog empty;
+  REQUIRE(empty.estimate() == 0);
+  REQUIRE(empty.memory_bytes() == (1 << 14));
+
+  // small counts are nearly exact
+  HyperLogLog small;
+  for (int i = 0; i < 100; i++) {
+    small.add("term" + to_string(i));
+    small.add("term" + to_string(i));
+  }
+  REQUIRE(small.estimate() >= 98);
+  REQUIRE(small.estimate() <= 102);
+
+  // large counts within a few standard errors
+  HyperLogLog large;
+  for (int i = 0; i < 1000000; i++) {
+    large.add(to_string(i));
+  }
+  REQUIRE(fabs(large.estimate() - 1000000.0) < 1000000.0 * 0.03);
+
+  // clamped precision
+  REQUIRE(HyperLogLog(1).precision() == HyperLogLog::kMinPrecision);
+  REQUIRE(HyperLogLog(99).precision() == HyperLogLog::kMaxPrecision);
+}
+
+TEST_CASE("Merge", "[Test_HyperLogLog]") {
+  HyperLogLog a;
+  HyperLogLog b;
+  HyperLogLog both;
+  for (int i = 0; i < 200000; i++) {
+    string term = to_string(i);
+    (i % 2 == 0 ? a : b).add(term);
+    both.add(term);
+  }
+  REQUIRE(a.merge(b));
+  REQUIRE(a.estimate() == both.estimate());
+  REQUIRE_FALSE(a.merge(HyperLogLog(10)));
+}
+
+TEST_CASE("Files", "[Test_TermSketch]") {
+  vector<string> war = read_tokens(kLongFileName);
+  vector<string> aid = read_tokens(kGreatFileName);
+  unordered_map<string, uint64_t> exact;
+  for (const string &token : war) {
+    exact[token]++;
+  }
+  for (const string &token : aid) {
+    exact[token]++;
+  }
+
+  // One sketch per file, each built on its own thread, then merged
+  vector<TermSketch> sketches(2);
+  const char *files[] = {kLongFileName, kGreatFileName};
+  vector<uint64_t> added(2);
+  vector<thread> threads;
+  for (int i = 0; i < 2; i++) {
+    threads.emplace_back([&, i]() {
+      BufferedFileReader bf(files[i]);
+      added[i] = sketches[i].add_tokens(bf);
+    });
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+  REQUIRE(added[0] == war.size());
+  REQUIRE(added[1] == aid.size());
+
+  TermSketch &sketch = sketches[0];
+  REQUIRE(sketch.merge(sketches[1]));
+  REQUIRE(sketch.total() == war.size() + aid.size());
+
+  double distinct = static_cast<double>(exact.size());
+  REQUIRE(fabs(sketch.distinct().estimate() - distinct) < distinct * 0.03);
+  REQUIRE(sketch.counts().estimate("the") >= exact["the"]);
+  REQUIRE(sketch.top_terms().top(1)[0].term == "the");
+
+  TermSketch small(16, 64, 2, 10);
+  REQUIRE_FALSE(sketch.merge(small));
+}
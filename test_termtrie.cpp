@@ -0,0 +1,169 @@
+#include "./InvertedIndex.hpp"
+#include "./TermTrie.hpp"
+#include "./TermTrieBuilder.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kTestFilesDir = "./test_files";
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+// Collects the terms from an iterator until it runs out
+static vector<string> collect(TermTrie::Iterator it) {
+  vector<string> terms;
+  for (; it.valid(); it.next()) {
+    terms.emplace_back(it.term());
+  }
+  return terms;
+}
+
+TEST_CASE("Basic", "[Test_TermTrie]") {
+  vector<string> terms = {"",     "a", "ab",  "abc", "abd",
+                          "abdx", "b", "bcd", "bce", "zzzz"};
+  TempFile file("test_termtrie_basic.trie");
+  {
+    TermTrieBuilder builder(file.path);
+    for (size_t i = 0; i < terms.size(); i++) {
+      REQUIRE(builder.add(terms[i], i * 1000));
+    }
+    REQUIRE_FALSE(builder.add("bcd", 1));
+    REQUIRE_FALSE(builder.add("a", 1));
+    REQUIRE(builder.finish());
+    REQUIRE_FALSE(builder.finish());
+  }
+
+  TermTrie trie(file.path);
+  REQUIRE(trie.good());
+  REQUIRE(trie.num_terms() == terms.size());
+  for (size_t i = 0; i < terms.size(); i++) {
+    REQUIRE(trie.find(terms[i]) == i * 1000);
+  }
+  for (string missing : {"abe", "ac", "abdxy", "bc", "c", "zz", "zzzzz"}) {
+    REQUIRE_FALSE(trie.find(missing).has_value());
+  }
+
+  // every term in order, from anywhere
+  REQUIRE(collect(trie.seek("")) == terms);
+  REQUIRE(collect(trie.seek("abbz")) ==
+          vector<string>(terms.begin() + 3, terms.end()));
+  REQUIRE(collect(trie.seek("abd")) ==
+          vector<string>(terms.begin() + 4, terms.end()));
+  REQUIRE(collect(trie.seek("abda")) ==
+          vector<string>(terms.begin() + 5, terms.end()));
+  REQUIRE(collect(trie.seek("bb")) ==
+          vector<string>(terms.begin() + 7, terms.end()));
+  REQUIRE(collect(trie.seek("bd")) == vector<string>{"zzzz"});
+  REQUIRE_FALSE(trie.seek("zzzzz").valid());
+  TermTrie::Iterator it = trie.seek("abc");
+  REQUIRE(it.value() == 3000);
+
+  // prefixes and ranges
+  vector<pair<string, uint64_t>> found;
+  trie.for_each_prefix("ab", [&found](string_view term, uint64_t value) {
+    found.emplace_back(term, value);
+  });
+  REQUIRE(found == vector<pair<string, uint64_t>>{
+                       {"ab", 2000}, {"abc", 3000}, {"abd", 4000},
+                       {"abdx", 5000}});
+  vector<string> range;
+  trie.for_each_range("abd", "bce", [&range](string_view term, uint64_t) {
+    range.emplace_back(term);
+  });
+  REQUIRE(range == vector<string>{"abd", "abdx", "b", "bcd"});
+  size_t count = 0;
+  trie.for_each_prefix("bc", [&count](string_view, uint64_t) { count++; });
+  REQUIRE(count == 2);
+  trie.for_each_prefix("q", [&count](string_view, uint64_t) { count++; });
+  REQUIRE(count == 2);
+}
+
+TEST_CASE("Empty", "[Test_TermTrie]") {
+  TempFile file("test_termtrie_empty.trie");
+  {
+    TermTrieBuilder builder(file.path);
+    REQUIRE(builder.finish());
+  }
+  TermTrie trie(file.path);
+  REQUIRE(trie.good());
+  REQUIRE(trie.num_terms() == 0);
+  REQUIRE_FALSE(trie.find("").has_value());
+  REQUIRE_FALSE(trie.seek("").valid());
+
+  // not a trie
+  TermTrie not_trie(kLongFileName);
+  REQUIRE_FALSE(not_trie.good());
+  REQUIRE_FALSE(not_trie.find("the").has_value());
+  REQUIRE_FALSE(not_trie.seek("").valid());
+  TermTrie missing("./test_files/not_a_file.trie");
+  REQUIRE_FALSE(missing.good());
+}
+
+TEST_CASE("Index", "[Test_TermTrie]") {
+  // The terms of test_files/, valued by term id
+  InvertedIndex index;
+  REQUIRE(index.add_directory(kTestFilesDir));
+  const TermDictionary &dict = index.dictionary();
+  vector<pair<string, uint64_t>> terms;
+  for (uint32_t id = 0; id < index.num_terms(); id++) {
+    terms.emplace_back(dict.term(id), id);
+  }
+  sort(terms.begin(), terms.end());
+
+  TempFile file("test_termtrie_index.trie");
+  {
+    TermTrieBuilder builder(file.path);
+    for (const auto &[term, value] : terms) {
+      REQUIRE(builder.add(term, value));
+    }
+    REQUIRE(builder.finish());
+  }
+  TermTrie trie(file.path);
+  REQUIRE(trie.good());
+  REQUIRE(trie.num_terms() == terms.size());
+  for (const auto &[term, value] : terms) {
+    REQUIRE(trie.find(term) == value);
+  }
+
+  size_t i = 0;
+  for (TermTrie::Iterator it = trie.seek(""); it.valid(); it.next(), i++) {
+    REQUIRE(it.term() == terms[i].first);
+    REQUIRE(it.value() == terms[i].second);
+  }
+  REQUIRE(i == terms.size());
+
+  // Seeks and prefixes agree with a sorted array
+  mt19937 gen(5950);
+  for (int round = 0; round < 500; round++) {
+    string key = terms[gen() % terms.size()].first;
+    key.resize(gen() % (key.size() + 1));
+    if (!key.empty() && gen() % 2 == 0) {
+      key.back()++;
+    }
+    auto lower = lower_bound(
+        terms.begin(), terms.end(), key,
+        [](const pair<string, uint64_t> &a, const string &b) {
+          return a.first < b;
+        });
+    TermTrie::Iterator it = trie.seek(key);
+    if (lower == terms.end()) {
+      REQUIRE_FALSE(it.valid());
+    } else {
+      REQUIRE(it.term() == lower->first);
+    }
+
+    size_t expected = 0;
+    for (auto p = lower; p != terms.end() && p->first.starts_with(key); p++) {
+      expected++;
+    }
+    size_t count = 0;
+    trie.for_each_prefix(key, [&count](string_view, uint64_t) { count++; });
+    REQUIRE(count == expected);
+  }
+}
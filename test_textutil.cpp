@@ -0,0 +1,24 @@
+#include "./TextUtil.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kTestDirName = "./test_files";
+
+TEST_CASE("List Directory", "[Test_TextUtil]") {
+  optional<vector<string>> files = list_directory(kTestDirName);
+  REQUIRE(files.has_value());
+  REQUIRE_FALSE(files->empty());
+  REQUIRE(files.value() == test_files());
+  REQUIRE_FALSE(list_directory("./no_such_dir").has_value());
+}
+
+TEST_CASE("Fold Token", "[Test_TextUtil]") {
+  string scratch;
+  REQUIRE(fold_token("Hello, WORLD 42!", &scratch) == "hello, world 42!");
+  REQUIRE(fold_token("", &scratch).empty());
+}
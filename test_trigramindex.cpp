@@ -0,0 +1,91 @@
+#include "./TrigramIndex.hpp"
+#include "./test_helpers.hpp"
+#include "catch.hpp"
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr const char *kTestFilesDir = "./test_files";
+static constexpr const char *kByeFileName = "./test_files/Bye.txt";
+static constexpr const char *kHelloFileName = "./test_files/Hello.txt";
+static constexpr const char *kLongFileName = "./test_files/war_and_peace.txt";
+
+// Reads a whole file into a string
+static string read_file(const string &fname) {
+  string contents{};
+  ifstream ifs(fname);
+  contents.assign((std::istreambuf_iterator<char>(ifs)),
+                  (std::istreambuf_iterator<char>()));
+  return contents;
+}
+
+// Finds every occurrence of needle in the index's files the slow way
+static vector<TrigramMatch> naive_find_all(const TrigramIndex &index,
+                                           const string &needle) {
+  vector<TrigramMatch> res;
+  for (uint32_t file = 0; file < index.num_files(); file++) {
+    string contents = read_file(index.file_name(file));
+    size_t pos = contents.find(needle);
+    while (pos != string::npos) {
+      res.push_back(TrigramMatch{file, static_cast<off_t>(pos)});
+      pos = contents.find(needle, pos + 1);
+    }
+  }
+  return res;
+}
+
+TEST_CASE("Basic", "[Test_TrigramIndex]") {
+  TrigramIndex index;
+  REQUIRE(index.add_file(kHelloFileName) == 0);
+  REQUIRE(index.add_file(kByeFileName) == 1);
+  REQUIRE_FALSE(index.add_file("./test_files/not_a_file.txt").has_value());
+  REQUIRE(index.num_files() == 2);
+  REQUIRE(index.file_name(1) == kByeFileName);
+
+  // "Hello World!" has 10 distinct trigrams
+  TrigramIndex hello;
+  hello.add_file(kHelloFileName);
+  REQUIRE(hello.num_trigrams() == 10);
+  REQUIRE(hello.num_postings() == 10);
+
+  REQUIRE(index.candidate_files("World") == vector<uint32_t>{0});
+  REQUIRE(index.candidate_files("Goodbye") == vector<uint32_t>{1});
+  REQUIRE(index.candidate_files("Greetings").empty());
+  // too short to narrow anything down
+  REQUIRE(index.candidate_files("o") == vector<uint32_t>{0, 1});
+  REQUIRE(index.candidate_files(vector<string_view>{"Hello", "Goodbye"}).empty());
+
+  REQUIRE(index.find_all("World") == vector<TrigramMatch>{{0, 6}});
+  REQUIRE(index.find_all("Goodbye") ==
+          vector<TrigramMatch>{{1, 0}, {1, 37}, {1, 46}, {1, 55}});
+  REQUIRE(index.find_all("o") == naive_find_all(index, "o"));
+  REQUIRE(index.find_all("Greetings").empty());
+  REQUIRE(index.find_all("").empty());
+}
+
+TEST_CASE("Directory", "[Test_TrigramIndex]") {
+  // small blocks, so there are many of them and matches span them
+  TrigramIndex index(512);
+  REQUIRE(index.add_directory(kTestFilesDir));
+  REQUIRE(index.num_files() == test_files().size());
+  REQUIRE_FALSE(index.add_directory("./test_files/not_a_dir"));
+
+  uint32_t war = index.num_files();
+  for (uint32_t file = 0; file < index.num_files(); file++) {
+    if (index.file_name(file) == kLongFileName) {
+      war = file;
+    }
+  }
+  REQUIRE(war < index.num_files());
+  REQUIRE(index.candidate_files("Natasha") == vector<uint32_t>{war});
+
+  string contents = read_file(kLongFileName);
+  vector<string> needles = {"Natasha", "Prince Andrew", "the", "Hello",
+                            "mutual", "ab", contents.substr(700, 600),
+                            contents.substr(100000, 2000)};
+  for (const string &needle : needles) {
+    REQUIRE(index.find_all(needle) == naive_find_all(index, needle));
+  }
+}
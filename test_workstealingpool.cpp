@@ -0,0 +1,60 @@
+#include "./WorkStealingPool.hpp"
+#include "catch.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+TEST_CASE("Every Task Once", "[Test_WorkStealingPool]") {
+  for (size_t threads : {1, 3, 8}) {
+    WorkStealingPool pool(threads);
+    REQUIRE(pool.num_threads() == threads);
+
+    constexpr size_t kTasks = 1000;
+    vector<atomic<int>> runs(kTasks);
+    vector<atomic<int>> busy(threads);
+    // Catch's assertions are not thread safe, so only flag problems here
+    atomic<bool> bad_worker(false);
+    atomic<bool> overlap(false);
+    pool.run(kTasks, [&](size_t task, size_t worker) {
+      if (worker >= threads) {
+        bad_worker = true;
+        return;
+      }
+      if (busy[worker]++ != 0) {
+        overlap = true;
+      }
+      runs[task]++;
+      busy[worker]--;
+    });
+    REQUIRE_FALSE(bad_worker);
+    REQUIRE_FALSE(overlap);
+    for (const atomic<int> &count : runs) {
+      REQUIRE(count == 1);
+    }
+  }
+
+  WorkStealingPool pool(4);
+  pool.run(0, [](size_t, size_t) { FAIL("no tasks to run"); });
+}
+
+TEST_CASE("Uneven Tasks", "[Test_WorkStealingPool]") {
+  // The first thread is dealt every slow task, so
+  // the others have to steal them to help out
+  WorkStealingPool pool(4);
+  vector<size_t> ran_on(40);
+  pool.run(ran_on.size(), [&ran_on](size_t task, size_t worker) {
+    if (task < 10) {
+      this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    ran_on[task] = worker;
+  });
+  REQUIRE(pool.num_steals() > 0);
+  size_t slow_elsewhere = 0;
+  for (size_t task = 0; task < 10; task++) {
+    slow_elsewhere += ran_on[task] != 0;
+  }
+  REQUIRE(slow_elsewhere > 0);
+}